@@ -0,0 +1,331 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include "ssd1331.h"
+#include "accel.h"
+#include "perf.h"
+
+// 各コマンドのSPI上のバイト数
+#define LINE_BYTES      8   // 0x21, c1, r1, c2, r2, C, B, A
+#define RECT_BYTES      11  // 0x22, c1, r1, c2, r2, 線のC, B, A, 塗りのC, B, A
+#define COPY_BYTES      7   // 0x23, c1, r1, c2, r2, c3, r3
+#define WIN_BYTES       5   // 0x24/0x25, c1, r1, c2, r2
+#define FILL_BYTES      2   // 0x26, A
+
+// アクセラレータの描画が終わるまでの待ち時間 (us): 全画面の塗りつぶしで約400us
+#define ACCEL_WAIT_US(pixels)   (10 + (pixels) * 400 / SSD1331_BUF_LEN)
+
+void accel_set_mode(struct ssd1331 *dev, accel_mode_t mode) {
+    dev->accel_mode = mode;
+}
+
+static inline bool on_screen(struct ssd1331 *dev, int x0, int y0, int x1, int y1) {
+    int w = ssd1331_width(dev), h = ssd1331_height(dev);
+
+    return x0 >= 0 && x0 < w && x1 >= 0 && x1 < w && y0 >= 0 && y0 < h && y1 >= 0 && y1 < h;
+}
+
+// fbがないときにパネルの範囲へ切り取る (座標は整列済み)。何も残らなければfalseを返す
+static bool clip_panel(struct ssd1331 *dev, int *x0, int *y0, int *x1, int *y1) {
+    *x0 = MAX(*x0, 0);
+    *y0 = MAX(*y0, 0);
+    *x1 = MIN(*x1, ssd1331_width(dev) - 1);
+    *y1 = MIN(*y1, ssd1331_height(dev) - 1);
+    return *x0 <= *x1 && *y0 <= *y1;
+}
+
+// コマンドの座標: 90/270度では論理座標のxとyがRAMの行と桁になる
+static inline void queue_point(struct ssd1331 *dev, int x, int y) {
+    if (ssd1331_transposed(dev)) {
+        queue_cmd(dev, y);
+        queue_cmd(dev, x);
+    } else {
+        queue_cmd(dev, x);
+        queue_cmd(dev, y);
+    }
+}
+
+// アクセラレータのコマンドに使う各色6bitの値: R, Bは5bitなので1bit左シフトする
+static inline void queue_color(struct ssd1331 *dev, uint16_t color) {
+    queue_cmd(dev, (color >> 11) << 1);
+    queue_cmd(dev, (color >> 5) & 0x3F);
+    queue_cmd(dev, (color & 0x1F) << 1);
+}
+
+static void set_fill(struct ssd1331 *dev, bool on) {
+    if (dev->fill_state == on)
+        return;
+
+    queue_cmd(dev, SSD1331_FILL);
+    queue_cmd(dev, on ? 0x01 : 0x00);
+    dev->fill_state = on;
+}
+
+static size_t fill_cost(struct ssd1331 *dev, bool on) {
+    return dev->fill_state == on ? 0 : FILL_BYTES;
+}
+
+static void run(struct ssd1331 *dev, int pixels) {
+    flush_cmds(dev);
+    // 描画コマンドがRAMの書き込み位置を変えないとは限らないのでウィンドウを設定し直させる
+    dev->win.valid = false;
+    // 描画中に次のコマンドやデータを送らないよう完了まで待つ
+    hal_sleep_us(ACCEL_WAIT_US(pixels));
+}
+
+static bool use_accel(struct ssd1331 *dev, struct framebuffer *fb, size_t accel_bytes, size_t soft_bytes) {
+    // アクセラレータの色はRGB565なのでRGB565以外のフレームバッファには写せない。
+    // 90/270度の画面は横長のフレームバッファと座標が合わない
+    assert(!fb || fb->format == FB_RGB565);
+    assert(!fb || !ssd1331_transposed(dev));
+    if (!fb || dev->accel_mode == ACCEL_ALWAYS)
+        return true;
+    if (dev->accel_mode == ACCEL_NEVER)
+        return false;
+    return accel_bytes < soft_bytes;
+}
+
+// ソフトウェア描画した場合に増える転送バイト数
+static size_t soft_cost(struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    if (!fb->damage)
+        return 6 + 2 * SSD1331_BUF_LEN;
+    return damage_add_cost(fb->damage, x0, y0, x1, y1);
+}
+
+// パネルと同じ描画をRAMにも行う。damageには登録しない
+#define MIRROR(fb, call)                        \
+    do {                                        \
+        struct damage *_d = (fb)->damage;       \
+        (fb)->damage = NULL;                    \
+        call;                                   \
+        (fb)->damage = _d;                      \
+    } while (0)
+
+// パネル上の領域を読むコマンドの前に、その領域の未転送の変更を送っておく
+static void sync_panel(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    if (fb && fb->damage && damage_intersects(fb->damage, x0, y0, x1, y1))
+        render_dirty(dev, fb);
+}
+
+void accel_line(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_ACCEL);
+    size_t soft;
+
+    // はみ出すラインはfbがあればソフトウェアで描く。なければ見える区間だけを送る
+    if (!on_screen(dev, x0, y0, x1, y1)) {
+        if (fb) {
+            draw_line(fb, x0, y0, x1, y1, color);
+            return;
+        }
+        if (!clip_line(&x0, &y0, &x1, &y1, ssd1331_width(dev), ssd1331_height(dev)))
+            return;
+    }
+
+    if (fb && fb->damage) {
+        // 区間ごとの外接矩形で登録されるので、ピクセル数と区間数から見積もる
+        int n = MAX(abs(x1 - x0), abs(y1 - y0)) + 1;
+        soft = damage_add_cost(fb->damage, x0, y0, x1, y1) == 0 ? 0 : 2 * n + 6 * ((n + 7) / 8);
+    } else {
+        soft = fb ? 6 + 2 * SSD1331_BUF_LEN : 0;
+    }
+
+    if (!use_accel(dev, fb, LINE_BYTES, soft)) {
+        draw_line(fb, x0, y0, x1, y1, color);
+        return;
+    }
+
+    queue_cmd(dev, SSD1331_DRAW_LINE);
+    queue_point(dev, x0, y0);
+    queue_point(dev, x1, y1);
+    queue_color(dev, color);
+    run(dev, MAX(abs(x1 - x0), abs(y1 - y0)) + 1);
+
+    if (fb)
+        MIRROR(fb, draw_line(fb, x0, y0, x1, y1, color));
+}
+
+static void rect_cmd(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1,
+                     uint16_t color, bool filled) {
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+
+    if (!on_screen(dev, x0, y0, x1, y1)) {
+        if (fb) {
+            if (filled)
+                fill_rect(fb, x0, y0, x1, y1, color);
+            else
+                draw_rect(fb, x0, y0, x1, y1, color);
+        } else if (filled) {
+            if (clip_panel(dev, &x0, &y0, &x1, &y1))
+                rect_cmd(dev, NULL, x0, y0, x1, y1, color, true);
+        } else {
+            // 枠線は切り取ると形が変わるので、4辺を幅1の塗りつぶしとして見える部分だけ描く
+            rect_cmd(dev, NULL, x0, y0, x1, y0, color, true);
+            rect_cmd(dev, NULL, x0, y1, x1, y1, color, true);
+            rect_cmd(dev, NULL, x0, y0, x0, y1, color, true);
+            rect_cmd(dev, NULL, x1, y0, x1, y1, color, true);
+        }
+        return;
+    }
+
+    size_t soft = 0;
+    if (fb) {
+        if (filled)
+            soft = soft_cost(fb, x0, y0, x1, y1);
+        else if (fb->damage)
+            // 4辺を別々の矩形として登録する
+            soft = 4 * 6 + 4 * ((x1 - x0 + 1) + (y1 - y0 + 1));
+    }
+
+    if (!use_accel(dev, fb, RECT_BYTES + fill_cost(dev, filled), soft)) {
+        if (filled)
+            fill_rect(fb, x0, y0, x1, y1, color);
+        else
+            draw_rect(fb, x0, y0, x1, y1, color);
+        return;
+    }
+
+    set_fill(dev, filled);
+    queue_cmd(dev, SSD1331_DRAW_RECT);
+    queue_point(dev, x0, y0);
+    queue_point(dev, x1, y1);
+    queue_color(dev, color);     // 枠線
+    queue_color(dev, color);     // 塗りつぶし
+    run(dev, (x1 - x0 + 1) * (y1 - y0 + 1));
+
+    if (fb) {
+        if (filled)
+            MIRROR(fb, fill_rect(fb, x0, y0, x1, y1, color));
+        else
+            MIRROR(fb, draw_rect(fb, x0, y0, x1, y1, color));
+    }
+}
+
+void accel_rect(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_ACCEL);
+    rect_cmd(dev, fb, x0, y0, x1, y1, color, false);
+}
+
+void accel_fill(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_ACCEL);
+    rect_cmd(dev, fb, x0, y0, x1, y1, color, true);
+}
+
+static void win_cmd(struct ssd1331 *dev, uint8_t cmd, int x0, int y0, int x1, int y1) {
+    queue_cmd(dev, cmd);
+    queue_point(dev, x0, y0);
+    queue_point(dev, x1, y1);
+    run(dev, (x1 - x0 + 1) * (y1 - y0 + 1));
+}
+
+void accel_clear(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    PERF_SCOPE(PERF_ACCEL);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+
+    if (!fb) {
+        if (!clip_panel(dev, &x0, &y0, &x1, &y1))
+            return;
+    } else if (!on_screen(dev, x0, y0, x1, y1) || !use_accel(dev, fb, WIN_BYTES, soft_cost(fb, x0, y0, x1, y1))) {
+        fill_rect(fb, x0, y0, x1, y1, COL_BLACK);
+        return;
+    }
+
+    win_cmd(dev, SSD1331_CLEAR_WIN, x0, y0, x1, y1);
+    if (fb)
+        MIRROR(fb, fill_rect(fb, x0, y0, x1, y1, COL_BLACK));
+}
+
+// 転送元と転送先がどちらもパネルに入るように一緒に切り取る。何も残らなければfalseを返す
+static bool clip_copy(struct ssd1331 *dev, int *x0, int *y0, int *w, int *h, int *dx, int *dy) {
+    int max_x = ssd1331_width(dev) - 1, max_y = ssd1331_height(dev) - 1;
+    // 転送元と転送先の左上のうち、はみ出している量の大きい方だけずらす
+    int l = MAX(0, MAX(-*x0, -*dx)), t = MAX(0, MAX(-*y0, -*dy));
+
+    *x0 += l;
+    *dx += l;
+    *w -= l;
+    *y0 += t;
+    *dy += t;
+    *h -= t;
+    *w = MIN(*w, MIN(max_x - *x0 + 1, max_x - *dx + 1));
+    *h = MIN(*h, MIN(max_y - *y0 + 1, max_y - *dy + 1));
+    return *w > 0 && *h > 0;
+}
+
+// 重なりのあるコピーを、それぞれ転送先と重ならない帯に分けて送る。
+// 移す向きの先頭の帯から送るので、後の帯の転送元はまだ書き換えられていない
+static void copy_strips(struct ssd1331 *dev, int x0, int y0, int w, int h, int dx, int dy) {
+    int sy = dy - y0, sx = dx - x0;
+
+    if (sy != 0) {
+        int n = abs(sy);
+        for (int i = 0; i < h; i += n) {
+            int k = MIN(n, h - i);
+            int r = sy < 0 ? i : h - i - k;
+            accel_copy(dev, NULL, x0, y0 + r, x0 + w - 1, y0 + r + k - 1, dx, dy + r);
+        }
+    } else {
+        int n = abs(sx);
+        for (int i = 0; i < w; i += n) {
+            int k = MIN(n, w - i);
+            int c = sx < 0 ? i : w - i - k;
+            accel_copy(dev, NULL, x0 + c, y0, x0 + c + k - 1, y0 + h - 1, dx + c, dy);
+        }
+    }
+}
+
+void accel_copy(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, int dx, int dy) {
+    PERF_SCOPE(PERF_ACCEL);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+
+    int w = x1 - x0 + 1;
+    int h = y1 - y0 + 1;
+    if (!fb && !clip_copy(dev, &x0, &y0, &w, &h, &dx, &dy))
+        return;
+    x1 = x0 + w - 1;
+    y1 = y0 + h - 1;
+
+    // 重なりのあるコピーはパネル上での処理順が保証されない。
+    // フレームバッファがあればソフトウェアで行い、なければ重ならない帯に分ける
+    bool overlap = dx <= x1 && x0 <= dx + w - 1 && dy <= y1 && y0 <= dy + h - 1;
+    if (!fb && overlap) {
+        if (dx != x0 || dy != y0)
+            copy_strips(dev, x0, y0, w, h, dx, dy);
+        return;
+    }
+
+    if (fb && (!on_screen(dev, x0, y0, x1, y1) || !on_screen(dev, dx, dy, dx + w - 1, dy + h - 1) || overlap
+        || !use_accel(dev, fb, COPY_BYTES, soft_cost(fb, dx, dy, dx + w - 1, dy + h - 1)))) {
+        copy_rect(fb, x0, y0, x1, y1, dx, dy);
+        return;
+    }
+
+    sync_panel(dev, fb, x0, y0, x1, y1);
+
+    queue_cmd(dev, SSD1331_COPY);
+    queue_point(dev, x0, y0);
+    queue_point(dev, x1, y1);
+    queue_point(dev, dx, dy);
+    run(dev, w * h);
+
+    if (fb)
+        MIRROR(fb, copy_rect(fb, x0, y0, x1, y1, dx, dy));
+}
+
+void accel_dim(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    PERF_SCOPE(PERF_ACCEL);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+
+    if (!clip_panel(dev, &x0, &y0, &x1, &y1))
+        return;
+
+    sync_panel(dev, fb, x0, y0, x1, y1);
+    win_cmd(dev, SSD1331_DIM_WIN, x0, y0, x1, y1);
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ACCEL_H
+#define ACCEL_H
+
+#include <stdint.h>
+#include "gfx.h"
+
+/* SSD1331の描画アクセラレータ (DRAW_LINE, DRAW_RECT, COPY, DIM_WIN, CLEAR_WIN)
+
+   各関数はSPI上のバイト数でアクセラレータとソフトウェア描画を比較し、
+   安い方を選ぶ。ソフトウェア描画の費用はフレームバッファのdamageに
+   その領域を追加したときに増える転送バイト数とする。
+
+   アクセラレータを使う場合もfbがNULLでなければRAMのフレームバッファに同じ描画を
+   行い (damageには登録しない)、パネルとRAMの内容を一致させておく。
+   fbがNULLの場合は常にアクセラレータを使う。画面からはみ出した部分は切り取り、
+   重なりのあるコピーは重ならない帯に分けて送る。
+*/
+
+typedef enum accel_mode {
+    ACCEL_AUTO,     // 費用モデルで選択する
+    ACCEL_ALWAYS,   // 常にアクセラレータを使う
+    ACCEL_NEVER     // 常にソフトウェア描画 (render_dirty()で転送)
+} accel_mode_t;
+
+// モードとFILLの設定はパネルごとに持つ
+void accel_set_mode(struct ssd1331 *dev, accel_mode_t mode);
+
+void accel_line(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color);
+void accel_rect(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color);
+void accel_fill(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color);
+// 黒で塗りつぶす
+void accel_clear(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1);
+// (x0,y0)-(x1,y1) を (dx,dy) へコピーする
+void accel_copy(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1, int dx, int dy);
+// パネル上の表示を暗くする。RAMのフレームバッファには反映されないので
+// その領域をソフトウェアで再転送すると元に戻る
+void accel_dim(struct ssd1331 *dev, struct framebuffer *fb, int x0, int y0, int x1, int y1);
+
+#endif // ACCEL_H
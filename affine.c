@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "affine.h"
+#include "perf.h"
+
+#define QUARTER     (AFFINE_TURN / 4)
+#define MASK2       0x07E0F81Fu     // blend.cと同じ: 下位のピクセルのRとB、上位のピクセルのG
+
+// sin(2π * i / AFFINE_TURN) * 65536 (i = 0..QUARTER-1)。QUARTERの値65536は入らないので別に扱う
+static const uint16_t sin_table[QUARTER] = {
+        0,   402,   804,  1206,  1608,  2010,  2412,  2814,
+     3216,  3617,  4019,  4420,  4821,  5222,  5623,  6023,
+     6424,  6824,  7224,  7623,  8022,  8421,  8820,  9218,
+     9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391,
+    12785, 13180, 13573, 13966, 14359, 14751, 15143, 15534,
+    15924, 16314, 16703, 17091, 17479, 17867, 18253, 18639,
+    19024, 19409, 19792, 20175, 20557, 20939, 21320, 21699,
+    22078, 22457, 22834, 23210, 23586, 23961, 24335, 24708,
+    25080, 25451, 25821, 26190, 26558, 26925, 27291, 27656,
+    28020, 28383, 28745, 29106, 29466, 29824, 30182, 30538,
+    30893, 31248, 31600, 31952, 32303, 32652, 33000, 33347,
+    33692, 34037, 34380, 34721, 35062, 35401, 35738, 36075,
+    36410, 36744, 37076, 37407, 37736, 38064, 38391, 38716,
+    39040, 39362, 39683, 40002, 40320, 40636, 40951, 41264,
+    41576, 41886, 42194, 42501, 42806, 43110, 43412, 43713,
+    44011, 44308, 44604, 44898, 45190, 45480, 45769, 46056,
+    46341, 46624, 46906, 47186, 47464, 47741, 48015, 48288,
+    48559, 48828, 49095, 49361, 49624, 49886, 50146, 50404,
+    50660, 50914, 51166, 51417, 51665, 51911, 52156, 52398,
+    52639, 52878, 53114, 53349, 53581, 53812, 54040, 54267,
+    54491, 54714, 54934, 55152, 55368, 55582, 55794, 56004,
+    56212, 56418, 56621, 56823, 57022, 57219, 57414, 57607,
+    57798, 57986, 58172, 58356, 58538, 58718, 58896, 59071,
+    59244, 59415, 59583, 59750, 59914, 60075, 60235, 60392,
+    60547, 60700, 60851, 60999, 61145, 61288, 61429, 61568,
+    61705, 61839, 61971, 62101, 62228, 62353, 62476, 62596,
+    62714, 62830, 62943, 63054, 63162, 63268, 63372, 63473,
+    63572, 63668, 63763, 63854, 63944, 64031, 64115, 64197,
+    64277, 64354, 64429, 64501, 64571, 64639, 64704, 64766,
+    64827, 64884, 64940, 64993, 65043, 65091, 65137, 65180,
+    65220, 65259, 65294, 65328, 65358, 65387, 65413, 65436,
+    65457, 65476, 65492, 65505, 65516, 65525, 65531, 65535,
+};
+
+fix16_t affine_sin(int angle) {
+    int i = angle & (AFFINE_TURN - 1);
+    int q = i & (QUARTER - 1);
+    fix16_t s;
+
+    // 1/4周ごとに表を逆向きに引くか、符号を反転する
+    if (i & QUARTER)
+        s = q ? sin_table[QUARTER - q] : FIX16_ONE;
+    else
+        s = sin_table[q];
+    return i & (2 * QUARTER) ? -s : s;
+}
+
+fix16_t affine_cos(int angle) {
+    return affine_sin(angle + QUARTER);
+}
+
+void affine_rotate(struct affine *m, fix16_t su, fix16_t sv, fix16_t dx, fix16_t dy, int angle, fix16_t scale) {
+    fix16_t s = affine_sin(angle);
+    fix16_t c = affine_cos(angle);
+
+    assert(scale >= FIX16_ONE / 8);
+
+    // 転送先から転送元への逆変換: 回転を戻してから1/scale倍する
+    m->a = ((int64_t)c << 16) / scale;
+    m->b = ((int64_t)s << 16) / scale;
+    m->c = -m->b;
+    m->d = m->a;
+    m->tx = su - (fix16_t)(((int64_t)m->a * dx + (int64_t)m->b * dy) >> 16);
+    m->ty = sv - (fix16_t)(((int64_t)m->c * dx + (int64_t)m->d * dy) >> 16);
+}
+
+// 0 <= p + d * i <= lim となるiの範囲で [*i0, *i1] を狭める
+static void narrow(fix16_t p, fix16_t d, fix16_t lim, int *i0, int *i1) {
+    int lo, hi;
+
+    if (d == 0) {
+        if (p < 0 || p > lim)
+            *i1 = -1;
+        return;
+    }
+    if (d > 0) {
+        lo = p >= 0 ? 0 : (-p + d - 1) / d;
+        hi = p > lim ? -1 : (lim - p) / d;
+    } else {
+        lo = p <= lim ? 0 : (p - lim - d - 1) / -d;
+        hi = p < 0 ? -1 : p / -d;
+    }
+    *i0 = MAX(*i0, lo);
+    *i1 = MIN(*i1, hi);
+}
+
+static inline uint32_t spread(uint16_t c) {
+    return (c | (uint32_t)c << 16) & MASK2;
+}
+
+// 3成分をまとめてpからqへf/32だけ進める。成分の積は隣の成分まで届かない
+static inline uint32_t lerp2(uint32_t p, uint32_t q, uint32_t f) {
+    return (p * (32 - f) + q * f) >> 5 & MASK2;
+}
+
+static void nearest_span(uint16_t *dst, int n, const uint16_t *src, int stride, fix16_t u, fix16_t v, fix16_t du, fix16_t dv) {
+    for (int i = 0; i < n; i++, u += du, v += dv)
+        dst[i] = src[(v >> 16) * stride + (u >> 16)];
+}
+
+static void nearest_key_span(uint16_t *dst, int n, const uint16_t *src, int stride, fix16_t u, fix16_t v, fix16_t du, fix16_t dv, uint16_t key) {
+    for (int i = 0; i < n; i++, u += du, v += dv) {
+        uint16_t p = src[(v >> 16) * stride + (u >> 16)];
+        if (p != key)
+            dst[i] = p;
+    }
+}
+
+// 周りの4ピクセルの中心からの位置で補間する。画像の端では外側のピクセルの代わりに端のピクセルを使う。
+// keyedなら、最も近いピクセルがkeyのときは描かず、keyの色を補間に混ぜない
+static void bilinear_span(uint16_t *dst, int n, const uint16_t *src, int stride, int w, int h,
+                          fix16_t u, fix16_t v, fix16_t du, fix16_t dv, bool keyed, uint16_t key) {
+    for (int i = 0; i < n; i++, u += du, v += dv) {
+        uint16_t nearest = src[(v >> 16) * stride + (u >> 16)];
+        if (keyed && nearest == key)
+            continue;
+
+        fix16_t su = u - FIX16_ONE / 2, sv = v - FIX16_ONE / 2;
+        int x = su >> 16, y = sv >> 16;
+        uint32_t fx = (su >> 11) & 31, fy = (sv >> 11) & 31;
+        int ox = 1, oy = stride;
+
+        if (x < 0) {
+            x = 0;
+            fx = 0;
+        } else if (x >= w - 1) {
+            ox = 0;
+        }
+        if (y < 0) {
+            y = 0;
+            fy = 0;
+        } else if (y >= h - 1) {
+            oy = 0;
+        }
+
+        const uint16_t *p = src + y * stride + x;
+        uint16_t p00 = p[0], p01 = p[ox], p10 = p[oy], p11 = p[oy + ox];
+        if (keyed) {
+            if (p00 == key) p00 = nearest;
+            if (p01 == key) p01 = nearest;
+            if (p10 == key) p10 = nearest;
+            if (p11 == key) p11 = nearest;
+        }
+        uint32_t top = lerp2(spread(p00), spread(p01), fx);
+        uint32_t bottom = lerp2(spread(p10), spread(p11), fx);
+        uint32_t c = lerp2(top, bottom, fy);
+        dst[i] = c | c >> 16;
+    }
+}
+
+void affine_blit(struct framebuffer *fb, int x0, int y0, int x1, int y1, const uint16_t *src, int stride, int w, int h,
+                 const struct affine *m, int flags, uint16_t key) {
+    PERF_SCOPE(PERF_AFFINE);
+    int cw, ch, sx = 0, sy = 0;
+
+    assert(fb->format == FB_RGB565);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    cw = x1 - x0 + 1;
+    ch = y1 - y0 + 1;
+    if (!fb_clip_blit(fb, &x0, &y0, &sx, &sy, &cw, &ch))
+        return;
+
+    fix16_t ulim = FIX16_INT(w) - 1, vlim = FIX16_INT(h) - 1;
+    // (x0, y0) のピクセルの中心に対応する位置。行ごとに (b, d) を足す
+    fix16_t urow = m->a * x0 + m->b * y0 + (m->a + m->b) / 2 + m->tx;
+    fix16_t vrow = m->c * x0 + m->d * y0 + (m->c + m->d) / 2 + m->ty;
+    int left = SSD1331_WIDTH, right = -1, top = -1, bottom = -1;
+
+    for (int y = y0; y < y0 + ch; y++, urow += m->b, vrow += m->d) {
+        // 行のうち画像に入る部分だけを描く
+        int i0 = 0, i1 = cw - 1;
+        narrow(urow, m->a, ulim, &i0, &i1);
+        narrow(vrow, m->c, vlim, &i0, &i1);
+        if (i0 > i1)
+            continue;
+
+        uint16_t *d = fb_row(fb, y) + x0 + i0;
+        fix16_t u = urow + m->a * i0, v = vrow + m->c * i0;
+        int n = i1 - i0 + 1;
+
+        if (flags & AFFINE_BILINEAR)
+            bilinear_span(d, n, src, stride, w, h, u, v, m->a, m->c, flags & AFFINE_KEY, key);
+        else if (flags & AFFINE_KEY)
+            nearest_key_span(d, n, src, stride, u, v, m->a, m->c, key);
+        else
+            nearest_span(d, n, src, stride, u, v, m->a, m->c);
+
+        left = MIN(left, x0 + i0);
+        right = MAX(right, x0 + i1);
+        if (top < 0)
+            top = y;
+        bottom = y;
+    }
+    if (fb->damage && top >= 0)
+        damage_add(fb->damage, left, top, right, bottom);
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef AFFINE_H
+#define AFFINE_H
+
+#include <stdint.h>
+#include "gfx.h"
+
+/* RGB565の画像の回転、拡大縮小、平行移動 (アフィン変換) の描画
+
+   メーターの針や回転するインジケーターを、回転済みのコマをフラッシュに並べたり
+   浮動小数点で1ピクセルずつ計算したりせずに描く (Cortex-M0+にはFPUがない)。
+
+   変換は転送先のピクセルの中心 (x + 0.5, y + 0.5) から転送元の位置 (u, v) への
+   16.16固定小数点の行列で持つ。1行の中では隣のピクセルへ (a, c) を足すだけで、
+   行の初めでは転送元の画像に入る範囲をまず割り算で求めるので、内側のループに
+   範囲の判定はない。
+
+     u = a * x + b * y + tx
+     v = c * x + d * y + ty
+
+   サンプリングは最も近いピクセルと、双線形補間 (AFFINE_BILINEAR)。補間はblend.hと
+   同じく3成分を1ワードに離して置き、2ピクセルの重みを1回の乗算で混ぜる。
+   keyの色のピクセル (AFFINE_KEY) は描かず、下を透かす。
+   フレームバッファはRGB565だけを扱い、描いた範囲をdamageに登録する。
+*/
+
+typedef int32_t fix16_t;
+
+#define FIX16_ONE       (1 << 16)
+#define FIX16(n)        ((fix16_t)((n) * FIX16_ONE))    // 定数用 (実行時に浮動小数点を使わない)
+#define FIX16_INT(n)    ((fix16_t)(n) << 16)
+
+// 角度の単位: 1周を1024とする。画面上で時計回りが正
+#define AFFINE_TURN         1024
+#define AFFINE_DEG(deg)     ((deg) * AFFINE_TURN / 360)
+
+#define AFFINE_BILINEAR     0x01    // 周りの4ピクセルを補間する (拡大したときに角が目立たない)
+#define AFFINE_KEY          0x02    // keyの色のピクセルを描かない
+
+struct affine {
+    fix16_t a, b, tx;
+    fix16_t c, d, ty;
+};
+
+// 1周をAFFINE_TURNとした角度のsinとcos (16.16)
+fix16_t affine_sin(int angle);
+fix16_t affine_cos(int angle);
+
+// 転送元の (su, sv) を転送先の (dx, dy) に置き、そこを中心にangleだけ回してscale倍する変換。
+// 座標はピクセルの境界の位置 (ピクセル (i, j) の中心は (i + 0.5, j + 0.5))。scaleは1/8以上
+void affine_rotate(struct affine *m, fix16_t su, fix16_t sv, fix16_t dx, fix16_t dy, int angle, fix16_t scale);
+
+// 転送先の矩形 (x0,y0)-(x1,y1) (画面とバンドに切り取る) の各ピクセルに、mで対応する
+// 転送元の画像 (w x h、1行strideピクセル) のピクセルを描く。画像の外に対応するピクセルは描かない
+void affine_blit(struct framebuffer *fb, int x0, int y0, int x1, int y1, const uint16_t *src, int stride, int w, int h,
+                 const struct affine *m, int flags, uint16_t key);
+
+#endif // AFFINE_H
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "anim.h"
+#include "qimage.h"
+#include "perf.h"
+
+#define RECT_HEADER 6
+
+// 次のフレームのレコード
+static const uint8_t *next_record(const uint8_t *p) {
+    int n = p[1];
+
+    p += 2;
+    for (int i = 0; i < n; i++)
+        p += RECT_HEADER + (p[4] << 8 | p[5]);
+    return p;
+}
+
+// pのフレームの矩形を送る
+static void send_frame(struct anim_player *pl, const uint8_t *p) {
+    PERF_SCOPE(PERF_QIMAGE);
+    int n = p[1];
+
+    p += 2;
+    for (int i = 0; i < n; i++) {
+        struct qimage img = {
+            width : p[2],
+            height : p[3],
+            size : p[4] << 8 | p[5],
+            data : p + RECT_HEADER
+        };
+
+        render_qimage(pl->dev, pl->x + p[0], pl->y + p[1], &img);
+        p += RECT_HEADER + img.size;
+    }
+}
+
+static void advance(struct anim_player *pl) {
+    pl->p = next_record(pl->p);
+    pl->frame++;
+    pl->tick++;
+}
+
+// 送らなくても後のフレームで画面が正しくなるフレームを、最大limit個飛ばす
+static void skip_frames(struct anim_player *pl, uint32_t limit) {
+    const uint8_t *q = pl->p;
+    uint32_t key = 0;
+
+    // 範囲内の最後のキーフレームまでは、何があっても飛ばせる
+    for (uint32_t i = 1; i <= limit; i++) {
+        q = next_record(q);
+        if (*q & ANIM_KEY)
+            key = i;
+    }
+    for (uint32_t i = 0; i < key; i++)
+        advance(pl);
+    pl->skipped += key;
+    limit -= key;
+
+    // ANIM_DROPのフレームの矩形は次のフレームの矩形に含まれるので、続けて飛ばしてもよい
+    for (; limit > 0 && (*pl->p & ANIM_DROP); limit--) {
+        advance(pl);
+        pl->skipped++;
+    }
+}
+
+void anim_start(struct anim_player *pl, struct ssd1331 *dev, const struct anim *anim, int x, int y, int fps, int flags) {
+    assert(x >= 0 && x + anim->width <= ssd1331_width(dev) && y >= 0 && y + anim->height <= ssd1331_height(dev));
+    assert(anim->frames > 0 && (anim->data[0] & ANIM_KEY));
+
+    memset(pl, 0, sizeof(*pl));
+    pl->dev = dev;
+    pl->anim = anim;
+    pl->x = x;
+    pl->y = y;
+    pl->flags = flags;
+    pl->p = anim->data;
+    pl->frame_us = 1000000 / (fps ? fps : anim->fps);
+    pl->start_us = hal_time_us();
+}
+
+bool anim_update(struct anim_player *pl) {
+    const struct anim *anim = pl->anim;
+
+    if (pl->frame == anim->frames)
+        return false;
+
+    uint64_t now = hal_time_us();
+    if (now < pl->start_us + (uint64_t)pl->tick * pl->frame_us)
+        return true;
+
+    // 時刻を過ぎているフレームのうち最後のものを送りたい。最後のフレームは飛ばさない
+    uint32_t due = (now - pl->start_us) / pl->frame_us;
+    if (due > pl->tick)
+        skip_frames(pl, MIN(due - pl->tick, (uint32_t)(anim->frames - 1 - pl->frame)));
+
+    send_frame(pl, pl->p);
+    advance(pl);
+    pl->shown++;
+
+    if (pl->frame == anim->frames && (pl->flags & ANIM_LOOP)) {
+        pl->frame = 0;
+        pl->p = anim->data;
+    }
+    return pl->frame < anim->frames;
+}
+
+uint32_t anim_next_us(const struct anim_player *pl) {
+    uint64_t due = pl->start_us + (uint64_t)pl->tick * pl->frame_us;
+    uint64_t now = hal_time_us();
+
+    return due > now ? due - now : 0;
+}
+
+void anim_play(struct anim_player *pl) {
+    while (anim_update(pl))
+        hal_sleep_us(anim_next_us(pl));
+}
+
+float anim_fps(const struct anim_player *pl) {
+    uint64_t us = hal_time_us() - pl->start_us;
+
+    return us ? pl->shown * 1e6f / us : 0;
+}
+
+float anim_target_fps(const struct anim_player *pl) {
+    return 1e6f / pl->frame_us;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1331.h"
+
+/* 差分で符号化したアニメーション
+
+   tools/bmp_to_hex.c の -a オプションでBMPの連番から生成する。
+   最初のフレーム (キーフレーム) は画像全体、以降のフレームは前のフレームから
+   変わった矩形だけを持ち、矩形はそれぞれqimage.hの形式で圧縮する。
+   dataはフレームごとに次のレコードを並べたもの:
+
+     flags (1バイト)  ANIM_KEY, ANIM_DROP
+     n     (1バイト)  矩形の数
+     n個の矩形:
+       x y w h        (各1バイト、アニメーションの左上からの位置)
+       size           (2バイト、上位バイトが先) 続くqimageのデータのバイト数
+       data[size]
+
+   再生はフレームバッファを使わず、矩形ごとに1行ずつ復号しながらウィンドウに送る
+   (render_qimage())。
+*/
+
+#define ANIM_KEY    0x01    // 画像全体を持つ: 前のフレームを送っていなくても正しく描ける
+#define ANIM_DROP   0x02    // 変わった矩形が次のフレームの矩形に含まれる: 送らずに飛ばせる
+
+struct anim {
+    uint8_t width;
+    uint8_t height;
+    uint16_t frames;
+    uint8_t fps;            // 作ったときのフレームレート
+    uint32_t size;          // dataのバイト数
+    const uint8_t *data;
+};
+
+#define ANIM_LOOP   0x01    // anim_start()のflags: 最後まで送ったら最初のフレームに戻る
+
+struct anim_player {
+    struct ssd1331 *dev;
+    const struct anim *anim;
+    uint8_t x;
+    uint8_t y;
+    uint8_t flags;
+    uint16_t frame;         // 次に送るフレーム
+    const uint8_t *p;       // frameのレコード
+    uint32_t frame_us;      // 目標の1フレームの時間
+    uint64_t start_us;      // 最初のフレームの時刻
+    uint32_t tick;          // 次に送るフレームの通し番号 (繰り返しても増え続ける)
+    uint32_t shown;         // 送ったフレーム数
+    uint32_t skipped;       // 遅れたので飛ばしたフレーム数
+};
+
+// animを (x,y) に、fps (0ならanim->fps) で再生する準備をする。最初のフレームはすぐに送る時刻になる
+void anim_start(struct anim_player *pl, struct ssd1331 *dev, const struct anim *anim, int x, int y, int fps, int flags);
+// 次のフレームの時刻になっていれば送る。バスが遅れて次の時刻も過ぎていれば、
+// 画面が崩れない範囲でフレームを飛ばす (ANIM_DROPのフレーム、キーフレームの前のフレーム)。
+// 再生が終わったらfalseを返す
+bool anim_update(struct anim_player *pl);
+// 次のフレームの時刻までの時間 (us)
+uint32_t anim_next_us(const struct anim_player *pl);
+// 最後まで (ANIM_LOOPなら止まらずに) 再生する
+void anim_play(struct anim_player *pl);
+// 開始してから実際に送ったフレームのfpsと目標のfps
+float anim_fps(const struct anim_player *pl);
+float anim_target_fps(const struct anim_player *pl);
+
+#endif // ANIM_H
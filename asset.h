@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ASSET_H
+#define ASSET_H
+
+#include <stdint.h>
+#include "qimage.h"
+#include "glyph.h"
+
+/* フラッシュに置くアセット (画像、アイコンのシート、フォント) のパック
+
+   tools/asset_pack.c がマニフェスト (assets/assets.txt) からビルド時に生成する
+   (CMakeのssd1331_add_assets())。パックは4バイト境界に置いた1つのconstの配列で、
+   先頭に見出しと索引、続けて各アセットのデータを4バイト境界に揃えて並べる。
+
+     magic   (4バイト)  ASSET_MAGIC
+     count   (4バイト)  アセットの数
+     struct asset_entry × count
+     データ
+
+   数値はリトルエンディアン (RP2040とホストのバイト順) なので、索引もデータも
+   フラッシュ上のものをそのまま参照する。RAMへのコピーも起動時の初期化も要らない。
+   アセットの番号 (ASSET_<名前>) は生成したヘッダーにマニフェストの順で定義される。
+*/
+
+#define ASSET_MAGIC     0x31504153u     // "SAP1"
+#define ASSET_ALIGN     4
+
+typedef enum asset_format {
+    ASSET_FMT_RAW,          // ファイルの内容そのまま
+    ASSET_FMT_RGB565,       // width x heightのRGB565。アイコンのシートはtile_w x tile_hのタイルを並べたもの
+    ASSET_FMT_RGB332,       // width x heightのRGB332 (1ピクセル1バイト)
+    ASSET_FMT_QIMAGE,       // qimage.hの圧縮形式
+    ASSET_FMT_FONT          // first-lastの文字のビットマップ (1文字height行、1行1バイト、MSBが左端) と
+                            // プロポーショナル表示用の表 (1文字1バイト、font.hのfont_prop[]と同じ)
+} asset_format_t;
+
+struct asset_entry {
+    uint32_t offset;        // パックの先頭からのバイト数 (ASSET_ALIGNの倍数)
+    uint32_t size;          // データのバイト数
+    uint16_t width;
+    uint16_t height;
+    uint8_t format;         // asset_format_t
+    union {
+        struct {
+            uint8_t tile_w; // ASSET_FMT_RGB565: タイルの大きさ (シートでなければ画像全体)
+            uint8_t tile_h;
+        };
+        struct {
+            uint8_t first;  // ASSET_FMT_FONT: 最初と最後の文字コード
+            uint8_t last;
+        };
+    };
+    uint8_t reserved;
+};
+
+static inline uint32_t asset_count(const uint8_t *pack) {
+    const uint32_t *hdr = (const uint32_t *)pack;
+
+    assert(hdr[0] == ASSET_MAGIC);
+    return hdr[1];
+}
+
+// アセットidの索引 (パックの中を指す)
+static inline const struct asset_entry *asset_entry(const uint8_t *pack, int id) {
+    assert((unsigned)id < asset_count(pack));
+    return (const struct asset_entry *)(pack + 8) + id;
+}
+
+// アセットidのデータ、バイト数と形式。dataはパックの中を指す
+static inline const void *asset_data(const uint8_t *pack, int id) {
+    return pack + asset_entry(pack, id)->offset;
+}
+
+static inline uint32_t asset_size(const uint8_t *pack, int id) {
+    return asset_entry(pack, id)->size;
+}
+
+static inline asset_format_t asset_format(const uint8_t *pack, int id) {
+    return (asset_format_t)asset_entry(pack, id)->format;
+}
+
+// ASSET_FMT_RGB565の画像 (render_blit()やblit()のsrc)
+static inline const uint16_t *asset_rgb565(const uint8_t *pack, int id) {
+    assert(asset_format(pack, id) == ASSET_FMT_RGB565);
+    return (const uint16_t *)asset_data(pack, id);
+}
+
+// シートのn番目 (左上から行の順) のタイルの左上の位置
+static inline void asset_tile(const uint8_t *pack, int id, int n, int *sx, int *sy) {
+    const struct asset_entry *e = asset_entry(pack, id);
+    int cols = e->width / e->tile_w;
+
+    *sx = n % cols * e->tile_w;
+    *sy = n / cols * e->tile_h;
+}
+
+// ASSET_FMT_QIMAGEのアセットを指すstruct qimage (圧縮データはコピーしない)
+static inline struct qimage asset_qimage(const uint8_t *pack, int id) {
+    const struct asset_entry *e = asset_entry(pack, id);
+    struct qimage img = {
+        width : (uint8_t)e->width,
+        height : (uint8_t)e->height,
+        size : e->size,
+        data : pack + e->offset
+    };
+
+    assert(e->format == ASSET_FMT_QIMAGE);
+    return img;
+}
+
+// ASSET_FMT_FONTのアセットを指すstruct glyph_font (glyph_set_font()に渡す)
+static inline struct glyph_font asset_font(const uint8_t *pack, int id) {
+    const struct asset_entry *e = asset_entry(pack, id);
+    const uint8_t *bits = pack + e->offset;
+    struct glyph_font font = {
+        bits : bits,
+        prop : bits + (e->last - e->first + 1) * e->height,
+        first : e->first,
+        last : e->last
+    };
+
+    // glyph.cは8x8の文字だけを描く
+    assert(e->format == ASSET_FMT_FONT && e->width == 8 && e->height == 8);
+    return font;
+}
+
+#endif // ASSET_H
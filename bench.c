@@ -0,0 +1,669 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1331.h"
+#include "gfx.h"
+#include "accel.h"
+#include "glyph.h"
+#include "console.h"
+#include "sprite.h"
+#include "blend.h"
+#include "textgrid.h"
+#include "affine.h"
+#include "rgb888.h"
+#include "perf.h"
+
+/* 描画と転送のベンチマーク (ssd1331_bench)
+
+   決まった作業を順に実行し、作業ごとのフレーム数、時間、転送量と
+   描画関数ごとの時間を表示する。RP2040ではstdio (UART) に、ホストでは
+   標準出力に同じ形式で出力するので、結果を比べられる。
+   ホストではSPIの待ち時間がないので、転送時間はwire列 (SPIクロックから計算) を見る。
+*/
+
+#ifndef SSD1331_PERF
+#error ssd1331_bench requires SSD1331_PERF
+#endif
+
+#define SPI_FREQ    (10 * 1000 * 1000)
+
+static struct ssd1331_bus bus;
+static struct ssd1331 oled;
+static uint16_t buf[SSD1331_BUF_LEN];
+static struct damage damage;
+static struct framebuffer fb;
+
+// 番号の形式のフレームバッファとパレット (16色を繰り返したものと、その色を反転したもの)
+static uint8_t buf8[FB_BYTES(FB_INDEX8)];
+static uint8_t buf4[FB_BYTES(FB_INDEX4)];
+static struct damage damage8, damage4;
+static struct framebuffer fb8, fb4;
+static uint16_t palette[256], palette_inv[256];
+static uint8_t buf332[FB_BYTES(FB_RGB332)];
+static struct damage damage332;
+static struct framebuffer fb332;
+
+// アイコンシート: 16x16のアイコンを4x2個並べた64x32の画像
+#define SHEET_W     64
+#define SHEET_H     32
+static uint16_t sheet[SHEET_W * SHEET_H];
+
+// メーターの文字盤: 64x64で、円の外はCOL_BLACK (透かす色)
+#define DIAL_W      64
+#define DIAL_H      64
+static uint16_t dial[DIAL_W * DIAL_H];
+
+static uint64_t prim_ticks[PERF_PRIM_COUNT];
+static uint32_t prim_calls[PERF_PRIM_COUNT];
+
+static void fill_soft(int i) {
+    fb_clear(&fb, i & 1 ? COL_BLUE : COL_RED);
+    render_dirty(&oled, &fb);
+}
+
+static void fill_accel(int i) {
+    accel_fill(&oled, &fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, i & 1 ? COL_BLUE : COL_RED);
+}
+
+// main()のラインの描画: 1本ごとに1フレームとする
+static void line_sweep(int i) {
+    int n = SSD1331_WIDTH + SSD1331_HEIGHT;
+    uint16_t color = (i / n) & 1 ? COL_BLACK : COL_WHITE;
+
+    i %= n;
+    if (i < SSD1331_WIDTH)
+        accel_line(&oled, &fb, i, 0, SSD1331_WIDTH - 1 - i, SSD1331_HEIGHT - 1, color);
+    else {
+        int y = SSD1331_HEIGHT - 1 - (i - SSD1331_WIDTH);
+        accel_line(&oled, &fb, 0, y, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1 - y, color);
+    }
+    render_dirty(&oled, &fb);
+}
+
+// 8行12桁の文字をすべて書き換える
+static void text_page(int i) {
+    char line[13];
+
+    for (int row = 0; row < 8; row++) {
+        for (int k = 0; k < 12; k++)
+            line[k] = ' ' + 1 + (i + row * 12 + k) % 94;
+        line[12] = '\0';
+        write_string(&fb, 0, row * 8, line, COL_WHITE);
+    }
+    render_dirty(&oled, &fb);
+}
+
+static void text_direct(int i) {
+    char line[13];
+
+    for (int row = 0; row < 8; row++) {
+        snprintf(line, sizeof(line), "%02d: %7.2f", row, i * 1.25 + row);
+        render_text(&oled, 0, row * 8, line, COL_WHITE, COL_BLACK, TEXT_OPAQUE);
+    }
+}
+
+// ログを1行追加する: フレームバッファで全体をずらして描き直す場合とコンソール
+static void log_redraw(int i) {
+    char line[13];
+
+    copy_rect(&fb, 0, 8, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, 0, 0);
+    fill_rect(&fb, 0, SSD1331_HEIGHT - 8, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, COL_BLACK);
+    snprintf(line, sizeof(line), "log %03d abcd", i);
+    write_string(&fb, 0, SSD1331_HEIGHT - 8, line, COL_WHITE);
+    render_dirty(&oled, &fb);
+}
+
+static struct console con;
+
+static void log_console(int i) {
+    if (i == 0)
+        console_init(&con, &oled, COL_WHITE, COL_BLACK);
+    console_printf(&con, "log %03d abcd\n", i);
+}
+
+// アイコンを画面に敷き詰める (6x4個)
+static void blit_icons(int i) {
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 6; x++) {
+            int n = (i + x + y) & 7;
+            blit(&fb, x * 16, y * 16, sheet, SHEET_W, (n & 3) * 16, (n >> 2) * 16, 16, 16);
+        }
+    render_dirty(&oled, &fb);
+}
+
+static void blit_direct(int i) {
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 6; x++) {
+            int n = (i + x + y) & 7;
+            render_blit(&oled, x * 16, y * 16, sheet, SHEET_W, (n & 3) * 16, (n >> 2) * 16, 16, 16);
+        }
+}
+
+// 背景の上で16x16のアイコンを2個動かす。背景を送るまでは準備として数えない
+static struct compositor comp;
+static struct sprite sprites[2];
+
+static void sprite_move_icons(int i) {
+    if (i == 0) {
+        for (int y = 0; y < SSD1331_HEIGHT; y++)
+            for (int x = 0; x < SSD1331_WIDTH; x++)
+                buf[y * SSD1331_WIDTH + x] = RGB(x * 2, 64, y * 4);
+        comp_init(&comp, &oled);
+        comp_set_background(&comp, buf, SSD1331_WIDTH, 0);
+        for (int k = 0; k < 2; k++) {
+            sprite_init(&sprites[k], sheet + k * 16, SHEET_W, 16, 16);
+            sprite_set_key(&sprites[k], COL_BLACK);
+            sprites[k].z = k;
+            comp_add(&comp, &sprites[k]);
+        }
+        comp_flush(&comp);
+        perf_reset();
+    }
+    sprite_move(&sprites[0], 10 + i * 3, 10 + i);
+    sprite_move(&sprites[1], 70 - i * 2, 40 - i);
+    comp_flush(&comp);
+}
+
+// センサーの値の欄を毎フレーム書き換える。ラベルを書くまでは準備として数えない
+static struct textgrid grid;
+
+static void dashboard(int i) {
+    static const struct grid_field pres = { 3, 1, 9, GRID_ALIGN_RIGHT, COL_WHITE };
+    static const struct grid_field temp = { 3, 2, 9, GRID_ALIGN_RIGHT, COL_WHITE };
+    static const struct grid_field humi = { 3, 3, 9, GRID_ALIGN_RIGHT, COL_WHITE };
+
+    if (i == 0) {
+        grid_init(&grid, &oled, COL_BLUE);
+        grid_puts(&grid, 0, 0, "BME280", COL_AQUA);
+        grid_puts(&grid, 0, 1, "P:", COL_YELLOW);
+        grid_puts(&grid, 0, 2, "T:", COL_YELLOW);
+        grid_puts(&grid, 0, 3, "H:", COL_YELLOW);
+        perf_reset();
+    }
+    grid_printf(&grid, &pres, "%d.%02d", 1007 + i / 25, (41 + i * 4) % 100);
+    grid_printf(&grid, &temp, "%d.%dC", 25, (i * 3) % 10);
+    grid_printf(&grid, &humi, "%d%%", 48 + (i & 1));
+}
+
+// 文字盤を2倍以上に拡大して回し、画面全体を毎フレーム描き直す
+static void rotate_dial(int i, int flags) {
+    struct affine m;
+
+    affine_rotate(&m, FIX16_INT(DIAL_W / 2), FIX16_INT(DIAL_H / 2), FIX16_INT(SSD1331_WIDTH / 2), FIX16_INT(SSD1331_HEIGHT / 2),
+                  i * AFFINE_DEG(7), FIX16_INT(2) + i * (FIX16_ONE / 64));
+    affine_blit(&fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, dial, DIAL_W, DIAL_W, DIAL_H, &m, flags, 0);
+    render_dirty(&oled, &fb);
+}
+
+static void rotate_nearest(int i) {
+    rotate_dial(i, 0);
+}
+
+static void rotate_bilinear(int i) {
+    rotate_dial(i, AFFINE_BILINEAR);
+}
+
+// 受信したRGB888のグラデーションを61バイトずつ (ピクセルの途中で切れる) ディザをかけてパネルへ直接送る。
+// 24bitの画像全体は持たず、受信バッファの大きさだけを使う
+static uint8_t rx_byte(int i, int k) {
+    int p = k / 3, x = p % SSD1331_WIDTH, y = p / SSD1331_WIDTH;
+
+    switch (k % 3) {
+    case 0: return x * 255 / (SSD1331_WIDTH - 1);
+    case 1: return (y * 4 + i) & 0xff;
+    default: return 255 - x * 2;
+    }
+}
+
+static void rgb888_stream(int i) {
+    static uint8_t rx[61];
+    struct rgb888_stream s;
+    int total = SSD1331_BUF_LEN * 3;
+
+    rgb888_begin(&s, &oled, 0, 0, SSD1331_WIDTH, SSD1331_HEIGHT, RGB888_DITHER);
+    for (int k = 0; k < total; k += sizeof(rx)) {
+        int n = MIN((int)sizeof(rx), total - k);
+        for (int j = 0; j < n; j++)
+            rx[j] = rx_byte(i, k + j);
+        rgb888_write(&s, rx, n);
+    }
+    rgb888_end(&s);
+}
+
+static void shapes(int i) {
+    fb_clear(&fb, COL_BLACK);
+    fill_circle(&fb, 20, 32, 10 + i % 8, COL_RED);
+    fill_triangle(&fb, 40, 10, 70, 50, 35, 55, COL_GREEN);
+    draw_rect(&fb, 60, 5, 90, 30, COL_YELLOW);
+    draw_circle(&fb, 75, 45, 12, COL_AQUA);
+    render_dirty(&oled, &fb);
+}
+
+// shapes()と同じ図形を8/4bppに描く (色はパレットの番号)
+static void shapes_indexed(struct framebuffer *f, int i) {
+    fb_clear(f, 0);
+    fill_circle(f, 20, 32, 10 + i % 8, 1);
+    fill_triangle(f, 40, 10, 70, 50, 35, 55, 2);
+    draw_rect(f, 60, 5, 90, 30, 3);
+    draw_circle(f, 75, 45, 12, 4);
+    render_dirty(&oled, f);
+}
+
+static void shapes_332(int i) {
+    fb_clear(&fb332, COL332_BLACK);
+    fill_circle(&fb332, 20, 32, 10 + i % 8, COL332_RED);
+    fill_triangle(&fb332, 40, 10, 70, 50, 35, 55, COL332_GREEN);
+    draw_rect(&fb332, 60, 5, 90, 30, COL332_YELLOW);
+    draw_circle(&fb332, 75, 45, 12, COL332_AQUA);
+    render_dirty(&oled, &fb332);
+}
+
+// 画面の下半分のメーター (バーと数値) を毎フレーム描き直す
+static void gauge(struct framebuffer *f, int i, uint16_t bar, uint16_t back, uint16_t text) {
+    char s[8];
+    int v = (i * 7) % 96;
+
+    fill_rect(f, 0, 32, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, back);
+    fill_rect(f, 0, 44, v, 63, bar);
+    snprintf(s, sizeof(s), "%3d%%", v * 100 / 95);
+    draw_text(f, 0, 32, s, text, back, TEXT_OPAQUE);
+    render_dirty(&oled, f);
+}
+
+static void gauge_565(int i) {
+    gauge(&fb, i, COL_GREEN, COL_BLACK, COL_WHITE);
+}
+
+static void gauge_332(int i) {
+    gauge(&fb332, i, COL332_GREEN, COL332_BLACK, COL332_WHITE);
+}
+
+static void shapes_idx8(int i) {
+    shapes_indexed(&fb8, i);
+}
+
+static void shapes_idx4(int i) {
+    shapes_indexed(&fb4, i);
+}
+
+// 描き直さずにパレットだけを差し替えて画面全体の色を変える
+static void palette_swap(int i) {
+    if (i == 0)
+        shapes_indexed(&fb4, 0);
+    fb_set_palette(&fb4, i & 1 ? palette_inv : palette);
+    render_dirty(&oled, &fb4);
+}
+
+static const struct workload {
+    const char *name;
+    void (*run)(int i);
+    int frames;
+} workloads[] = {
+    { "fill soft",   fill_soft,   20 },
+    { "fill accel",  fill_accel,  20 },
+    { "line sweep",  line_sweep,  2 * (SSD1331_WIDTH + SSD1331_HEIGHT) },
+    { "text page",   text_page,   20 },
+    { "text direct", text_direct, 20 },
+    { "log redraw",  log_redraw,  20 },
+    { "log console", log_console, 20 },
+    { "blit fb",     blit_icons,  20 },
+    { "blit direct", blit_direct, 20 },
+    { "shapes",      shapes,      20 },
+    { "shapes 332",  shapes_332,  20 },
+    { "shapes idx8", shapes_idx8, 20 },
+    { "shapes idx4", shapes_idx4, 20 },
+    { "palette",     palette_swap, 20 },
+    { "gauge 565",   gauge_565,   20 },
+    { "gauge 332",   gauge_332,   20 },
+    { "sprite move", sprite_move_icons, 20 },
+    { "dashboard",   dashboard,   20 },
+    { "rotate",      rotate_nearest,  20 },
+    { "rotate bilin", rotate_bilinear, 20 },
+    { "rgb888 strm", rgb888_stream, 20 },
+};
+
+// アルファブレンドのカーネルを1ピクセルずつ成分ごとに計算する版と比べる
+#ifdef SSD1331_HOST
+#define KERNEL_PASSES   2000
+#else
+#define KERNEL_PASSES   20
+#endif
+
+static uint16_t ref_mix(uint16_t f, uint16_t b, int a) {
+    int r = ((f >> 11) * a + (b >> 11) * (32 - a)) >> 5;
+    int g = (((f >> 5) & 0x3f) * a + ((b >> 5) & 0x3f) * (32 - a)) >> 5;
+    int bl = ((f & 0x1f) * a + (b & 0x1f) * (32 - a)) >> 5;
+    return r << 11 | g << 5 | bl;
+}
+
+static void ref_span(uint16_t *dst, const uint16_t *src, int n, int alpha) {
+    for (int i = 0; i < n; i++)
+        dst[i] = ref_mix(src[i], dst[i], alpha_level(alpha));
+}
+
+static void ref_fill_span(uint16_t *dst, uint16_t color, int n, int alpha) {
+    for (int i = 0; i < n; i++)
+        dst[i] = ref_mix(color, dst[i], alpha_level(alpha));
+}
+
+static void ref_mask_span(uint16_t *dst, uint16_t color, const uint8_t *mask, int m0, int n) {
+    for (int i = 0; i < n; i++) {
+        int k = m0 + i;
+        int v = k & 1 ? mask[k >> 1] & 0x0f : mask[k >> 1] >> 4;
+        dst[i] = ref_mix(color, dst[i], (v * 32 + 7) / 15);
+    }
+}
+
+static void ref_aa_text(struct framebuffer *f, int x, int y, const char *str, uint16_t color) {
+    const struct aa_font *font = &font_aa8x8;
+
+    for (; *str; str++, x += font->width) {
+        const uint8_t *g = font->bits + (*str - font->first) * font->height * font->width / 2;
+        for (int j = 0; j < font->height; j++)
+            ref_mask_span(fb_row(f, y + j) + x, color, g + j * font->width / 2, 0, font->width);
+    }
+}
+
+// affine_blit()を1ピクセルずつ転送先の位置から直接計算する版
+static uint16_t ref_lerp(uint16_t p, uint16_t q, int f) {
+    int r = ((p >> 11) * (32 - f) + (q >> 11) * f) >> 5;
+    int g = (((p >> 5) & 0x3f) * (32 - f) + ((q >> 5) & 0x3f) * f) >> 5;
+    int b = ((p & 0x1f) * (32 - f) + (q & 0x1f) * f) >> 5;
+    return r << 11 | g << 5 | b;
+}
+
+static void ref_affine(uint16_t *dst, const struct affine *m, const uint16_t *src, int w, int h, bool bilinear, uint16_t key) {
+    for (int y = 0; y < SSD1331_HEIGHT; y++)
+        for (int x = 0; x < SSD1331_WIDTH; x++) {
+            int64_t u = (int64_t)m->a * (2 * x + 1) / 2 + (int64_t)m->b * (2 * y + 1) / 2 + m->tx;
+            int64_t v = (int64_t)m->c * (2 * x + 1) / 2 + (int64_t)m->d * (2 * y + 1) / 2 + m->ty;
+            if (u < 0 || v < 0 || u >= (int64_t)w << 16 || v >= (int64_t)h << 16)
+                continue;
+
+            uint16_t nearest = src[(v >> 16) * w + (u >> 16)];
+            if (!bilinear) {
+                dst[y * SSD1331_WIDTH + x] = nearest;
+                continue;
+            }
+            if (nearest == key)
+                continue;
+            int64_t su = u - 0x8000, sv = v - 0x8000;
+            int x0 = su < 0 ? 0 : su >> 16, y0 = sv < 0 ? 0 : sv >> 16;
+            int x1 = MIN(x0 + 1, w - 1), y1 = MIN(y0 + 1, h - 1);
+            int fx = su < 0 ? 0 : (su >> 11) & 31, fy = sv < 0 ? 0 : (sv >> 11) & 31;
+            uint16_t p[4] = { src[y0 * w + x0], src[y0 * w + x1], src[y1 * w + x0], src[y1 * w + x1] };
+            for (int k = 0; k < 4; k++)
+                if (p[k] == key)
+                    p[k] = nearest;
+            dst[y * SSD1331_WIDTH + x] = ref_lerp(ref_lerp(p[0], p[1], fx), ref_lerp(p[2], p[3], fx), fy);
+        }
+}
+
+// rgb888_span()を1ピクセルずつ1バイトずつ計算する版
+static void ref_rgb888(uint16_t *dst, const uint8_t *src, int n, int x, int y, int flags) {
+    static const uint8_t bayer[4][4] = { { 0, 8, 2, 10 }, { 12, 4, 14, 6 }, { 3, 11, 1, 9 }, { 15, 7, 13, 5 } };
+
+    for (int i = 0; i < n; i++, src += 3) {
+        int r = flags & RGB888_BGR ? src[2] : src[0], g = src[1], b = flags & RGB888_BGR ? src[0] : src[2];
+        if (flags & RGB888_DITHER) {
+            int t = bayer[y & 3][(x + i) & 3] * 16 + 8;
+            r += r >> 7;
+            g += g >> 7;
+            b += b >> 7;
+            dst[i] = (r * 31 + t) / 256 << 11 | (g * 63 + t) / 256 << 5 | (b * 31 + t) / 256;
+        } else {
+            dst[i] = RGB(r, g, b);
+        }
+    }
+}
+
+// 1ピクセルずつ範囲を確かめて書く (set_pixel()と同じで、性能カウンタを通らない)
+static inline void ref_pixel(struct framebuffer *f, int x, int y, uint16_t color) {
+    if ((unsigned)x < SSD1331_WIDTH && (unsigned)y < SSD1331_HEIGHT && fb_has_row(f, y))
+        fb_row(f, y)[x] = color;
+}
+
+// draw_line()を切り取りと水平/垂直の判定なしに1ピクセルずつ描く版
+static void ref_line(struct framebuffer *f, int x0, int y0, int x1, int y1, uint16_t color) {
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (true) {
+        ref_pixel(f, x0, y0, color);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+// 不透明な市松模様と段階的なアルファの帯が交互に並ぶマスク
+static uint8_t mask4[SSD1331_WIDTH / 2 * SSD1331_HEIGHT];
+static uint16_t kernel_ref[SSD1331_BUF_LEN];
+// 受信したRGB888の行 (8行を繰り返して使う)
+static uint8_t rgb_rows[8][SSD1331_WIDTH * 3 + 4];
+static struct framebuffer kernel_fb;
+
+static void kernel_pass(int k, bool ref, int pass) {
+    int alpha = 64 + (pass & 127);
+    uint16_t color = pass * 0x9e37;
+    static const char text[] = "0123456789AB";
+
+    for (int y = 0; y < SSD1331_HEIGHT; y++) {
+        uint16_t *dst = (ref ? kernel_ref : buf) + y * SSD1331_WIDTH;
+        const uint16_t *src = sheet + (y & (SHEET_H - 1)) * SHEET_W;
+
+        switch (k) {
+        case 0:
+            if (ref) {
+                ref_span(dst, src, SHEET_W, alpha);
+                ref_span(dst + SHEET_W, src, SSD1331_WIDTH - SHEET_W, alpha);
+            } else {
+                blend_span(dst, src, SHEET_W, alpha);
+                blend_span(dst + SHEET_W, src, SSD1331_WIDTH - SHEET_W, alpha);
+            }
+            break;
+        case 1:
+            if (ref)
+                ref_fill_span(dst, COL_ORANGE, SSD1331_WIDTH, alpha);
+            else
+                blend_fill_span(dst, COL_ORANGE, SSD1331_WIDTH, alpha);
+            break;
+        case 2:
+            if (ref)
+                ref_mask_span(dst, COL_WHITE, mask4 + y * SSD1331_WIDTH / 2, 0, SSD1331_WIDTH);
+            else
+                blend_mask_span(dst, COL_WHITE, mask4 + y * SSD1331_WIDTH / 2, 0, SSD1331_WIDTH);
+            break;
+        case 3:
+            // 12文字 x 8行で画面全体
+            if (y % 8 == 0) {
+                if (ref)
+                    ref_aa_text(&kernel_fb, 0, y, text, COL_WHITE);
+                else
+                    draw_aa_text(&fb, &font_aa8x8, 0, y, text, COL_WHITE);
+            }
+            break;
+        case 6:
+        case 7: {
+            // 行とパスごとに転送元の4バイト境界からのずれを変える
+            const uint8_t *rgb = rgb_rows[y & 7] + ((y + pass) & 3);
+            int flags = k == 7 ? RGB888_DITHER | RGB888_BGR : 0;
+
+            if (ref)
+                ref_rgb888(dst, rgb, SSD1331_WIDTH, 0, y, flags);
+            else
+                rgb888_span(dst, rgb, SSD1331_WIDTH, 0, y, flags);
+            break;
+        }
+        case 8:
+            // 1行96ピクセルの水平線
+            if (ref) {
+                for (int x = 0; x < SSD1331_WIDTH; x++)
+                    ref_pixel(&kernel_fb, x, y, color);
+            } else {
+                draw_hline(&fb, 0, SSD1331_WIDTH - 1, y, color);
+            }
+            break;
+        case 9:
+            // 画面全体を1回で
+            if (y == 0) {
+                if (ref) {
+                    for (int j = 0; j < SSD1331_HEIGHT; j++)
+                        for (int x = 0; x < SSD1331_WIDTH; x++)
+                            ref_pixel(&kernel_fb, x, j, color);
+                } else {
+                    fill_rect(&fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, color);
+                }
+            }
+            break;
+        case 10:
+            // 行ごとに96ピクセルの斜めの線 (画面全体で64本)
+            if (ref)
+                ref_line(&kernel_fb, 0, y, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1 - y, color);
+            else
+                draw_line(&fb, 0, y, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1 - y, color);
+            break;
+        case 4:
+        case 5:
+            // 画面全体を1回で
+            if (y == 0) {
+                struct affine m;
+                int flags = k == 5 ? AFFINE_BILINEAR | AFFINE_KEY : 0;
+
+                affine_rotate(&m, FIX16(31.75), FIX16(32.25), FIX16_INT(SSD1331_WIDTH / 2), FIX16_INT(SSD1331_HEIGHT / 2),
+                              pass * 7, FIX16_INT(2) + (pass & 63) * 1024);
+                if (ref)
+                    ref_affine(kernel_ref, &m, dial, DIAL_W, DIAL_H, flags, COL_BLACK);
+                else
+                    affine_blit(&fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, dial, DIAL_W, DIAL_W, DIAL_H, &m, flags, COL_BLACK);
+            }
+            break;
+        }
+    }
+}
+
+static void run_kernels(void) {
+    static const char *names[] = { "alpha span", "alpha fill", "mask 4bpp", "aa text", "rotate", "rotate bil", "rgb888", "rgb dither",
+                                   "hline", "fill rect", "line" };
+    uint32_t px = SSD1331_BUF_LEN * KERNEL_PASSES;
+
+    fb_init(&kernel_fb, kernel_ref, NULL);
+    for (int y = 0; y < SSD1331_HEIGHT; y++)
+        for (int x = 0; x < SSD1331_WIDTH / 2; x++)
+            mask4[y * SSD1331_WIDTH / 2 + x] = (x / 4 + y / 4) & 1 ? 0xff : (x & 15) * 0x11;
+    for (int y = 0; y < 8; y++)
+        for (int j = 0; j < (int)sizeof(rgb_rows[0]); j++)
+            rgb_rows[y][j] = j * 3 + y * 37;
+
+    printf("\n%-10s %10s %10s %8s %6s\n", "kernel", "Mpix/s", "ref Mpix/s", "speedup", "match");
+    for (int k = 0; k < count_of(names); k++) {
+        uint64_t t[2];
+
+        // 同じ背景から始めて結果を比べる
+        for (int i = 0; i < SSD1331_BUF_LEN; i++)
+            buf[i] = kernel_ref[i] = i * 37;
+        for (int r = 0; r < 2; r++) {
+            uint64_t t0 = hal_time_us();
+            for (int pass = 0; pass < KERNEL_PASSES; pass++)
+                kernel_pass(k, r, pass);
+            t[r] = hal_time_us() - t0;
+        }
+        bool match = memcmp(buf, kernel_ref, sizeof(buf)) == 0;
+        printf("%-10s %10.1f %10.1f %8.2f %6s\n", names[k], t[0] ? (double)px / t[0] : 0,
+               t[1] ? (double)px / t[1] : 0, t[0] ? (double)t[1] / t[0] : 0, match ? "yes" : "NO");
+    }
+}
+
+static void run(const struct workload *w) {
+    // コンソールが動かした開始行を戻す
+    queue_cmd(&oled, SSD1331_SET_DISP_START_LINE);
+    queue_cmd(&oled, 0);
+    fb_clear(&fb, COL_BLACK);
+    render_dirty(&oled, &fb);
+
+    perf_reset();
+    for (int i = 0; i < w->frames; i++) {
+        w->run(i);
+        perf_frame();
+    }
+
+    const struct perf_stats *p = perf_get();
+    uint64_t us = p->frame_us - p->start_us;
+    printf("%-12s %6u %9.2f %8.1f %9u %6u %6u %8u %9.2f\n", w->name, p->frames, us / 1000.0, perf_fps(),
+           p->bytes / p->frames, p->transactions / p->frames, p->format_switches,
+           p->flushes ? (uint32_t)(p->flush_us / p->flushes) : 0,
+           p->bytes * 8.0 * 1000 / SPI_FREQ / p->frames);
+
+    for (int k = 0; k < PERF_PRIM_COUNT; k++) {
+        prim_calls[k] += p->prim[k].calls;
+        prim_ticks[k] += p->prim[k].ticks;
+    }
+}
+
+int main() {
+#ifndef SSD1331_HOST
+    stdio_init_all();
+#endif
+    ssd1331_bus_init(&bus, SPI_INSTANCE, SPI_SCK_PIN, SPI_MOSI_PIN, SPI_FREQ);
+    ssd1331_init(&oled, &bus, SPI_CSN_PIN, SPI_DCN_PIN, SPI_RESN_PIN);
+    fb_init(&fb, buf, &damage);
+
+    static const uint16_t colors[16] = {
+        COL_BLACK, COL_RED, COL_GREEN, COL_YELLOW, COL_AQUA, COL_BLUE, COL_MAGENTA, COL_WHITE,
+        COL_ORANGE, COL_GRAY, COL_LGRAY, COL_PURPLE, COL_REDPINK, RGB(0, 0, 128), RGB(0, 128, 0), RGB(128, 0, 0)
+    };
+    for (int k = 0; k < 256; k++) {
+        palette[k] = colors[k & 15];
+        palette_inv[k] = ~palette[k];
+    }
+    fb_init_indexed(&fb8, buf8, FB_INDEX8, palette, &damage8);
+    fb_init_indexed(&fb4, buf4, FB_INDEX4, palette, &damage4);
+    fb_init_rgb332(&fb332, buf332, &damage332);
+
+    for (int y = 0; y < SHEET_H; y++)
+        for (int x = 0; x < SHEET_W; x++)
+            sheet[y * SHEET_W + x] = RGB(x * 4, y * 8, (x ^ y) * 8);
+    for (int y = 0; y < DIAL_H; y++)
+        for (int x = 0; x < DIAL_W; x++) {
+            // 中心からの距離 (半ピクセル単位) で縁と目盛りを付ける
+            int dx = 2 * x + 1 - DIAL_W, dy = 2 * y + 1 - DIAL_H;
+            int r2 = dx * dx + dy * dy;
+            uint16_t c = RGB(x * 4, y * 4, 128);
+
+            if (r2 >= DIAL_W * DIAL_W)
+                c = COL_BLACK;
+            else if (r2 >= 56 * 56 || ((dx == 1 || dx == -1) && dy < 0))
+                c = COL_WHITE;
+            dial[y * DIAL_W + x] = c;
+        }
+
+    printf("%-12s %6s %9s %8s %9s %6s %6s %8s %9s\n", "workload", "frames", "ms", "fps",
+           "B/frame", "cs/f", "fmt", "flush us", "wire ms/f");
+    for (int i = 0; i < count_of(workloads); i++)
+        run(&workloads[i]);
+
+    uint32_t tpu = hal_ticks_per_us();
+    printf("\n%-9s %8s %12s %10s\n", "primitive", "calls", "us", "us/call");
+    for (int k = 0; k < PERF_PRIM_COUNT; k++)
+        if (prim_calls[k])
+            printf("%-9s %8u %12.1f %10.2f\n", perf_prim_name(k), prim_calls[k],
+                   (double)prim_ticks[k] / tpu, (double)prim_ticks[k] / tpu / prim_calls[k]);
+
+    run_kernels();
+    return 0;
+}
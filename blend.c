@@ -0,0 +1,279 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "blend.h"
+#include "font_aa.h"
+#include "perf.h"
+
+#define LEVELS  32              // アルファの最大値 (不透明)
+#define SHIFT   5
+#define MASK2   0x07E0F81Fu     // 下位のピクセルのRとB、上位のピクセルのG
+
+const struct aa_font font_aa8x8 = {
+    width : FONT_AA_WIDTH,
+    height : FONT_AA_HEIGHT,
+    bpp : FONT_AA_BPP,
+    first : FONT_AA_FIRST,
+    last : FONT_AA_LAST,
+    bits : font_aa
+};
+
+static inline uint32_t swap16(uint32_t w) {
+    return w << 16 | w >> 16;
+}
+
+// 1ピクセルの3成分を離して1ワードに置く
+static inline uint32_t spread(uint16_t c) {
+    return (c | (uint32_t)c << 16) & MASK2;
+}
+
+// 2ピクセル (ワード) を混ぜる: 成分の積は隣の成分まで届かない (最大でGの11bit)
+static inline uint32_t mix2(uint32_t fg, uint32_t bg, uint32_t a) {
+    uint32_t ia = LEVELS - a;
+    uint32_t x = ((fg & MASK2) * a + (bg & MASK2) * ia) >> SHIFT & MASK2;
+    uint32_t y = ((swap16(fg) & MASK2) * a + (swap16(bg) & MASK2) * ia) >> SHIFT & MASK2;
+
+    return x | swap16(y);
+}
+
+static inline uint16_t mix1(uint16_t fg, uint16_t bg, uint32_t a) {
+    uint32_t x = (spread(fg) * a + spread(bg) * (LEVELS - a)) >> SHIFT & MASK2;
+
+    return x | x >> 16;
+}
+
+// 前景が1色の場合: faは spread(color) * a。2ピクセルとも同じ色なので上下を入れ替えなくてよい
+static inline uint32_t fill2(uint32_t fa, uint32_t bg, uint32_t a) {
+    uint32_t ia = LEVELS - a;
+    uint32_t x = (fa + (bg & MASK2) * ia) >> SHIFT & MASK2;
+    uint32_t y = (fa + (swap16(bg) & MASK2) * ia) >> SHIFT & MASK2;
+
+    return x | swap16(y);
+}
+
+static inline uint16_t fill1(uint32_t fa, uint16_t bg, uint32_t a) {
+    uint32_t x = (fa + spread(bg) * (LEVELS - a)) >> SHIFT & MASK2;
+
+    return x | x >> 16;
+}
+
+void blend_span(uint16_t *dst, const uint16_t *src, int n, int alpha) {
+    uint32_t a = alpha_level(alpha);
+    int k = 0;
+
+    if (a == 0 || n <= 0)
+        return;
+    if (a == LEVELS) {
+        memcpy(dst, src, 2 * n);
+        return;
+    }
+
+    // dstを4バイト境界に揃える。srcが揃わなければ16bitずつ読んでワードにする (リトルエンディアン)
+    if ((uintptr_t)dst & 2) {
+        dst[0] = mix1(src[0], dst[0], a);
+        k = 1;
+    }
+    if (((uintptr_t)(src + k) & 2) == 0) {
+        for (; k + 1 < n; k += 2) {
+            pix2_t *d = (pix2_t *)(dst + k);
+            *d = mix2(*(const pix2_t *)(src + k), *d, a);
+        }
+    } else {
+        for (; k + 1 < n; k += 2) {
+            pix2_t *d = (pix2_t *)(dst + k);
+            *d = mix2(src[k] | (uint32_t)src[k + 1] << 16, *d, a);
+        }
+    }
+    if (k < n)
+        dst[k] = mix1(src[k], dst[k], a);
+}
+
+void blend_fill_span(uint16_t *dst, uint16_t color, int n, int alpha) {
+    uint32_t a = alpha_level(alpha);
+    uint32_t fa = spread(color) * a;
+    int k = 0;
+
+    if (a == 0 || n <= 0)
+        return;
+
+    if ((uintptr_t)dst & 2) {
+        dst[0] = fill1(fa, dst[0], a);
+        k = 1;
+    }
+    for (; k + 1 < n; k += 2) {
+        pix2_t *d = (pix2_t *)(dst + k);
+        *d = fill2(fa, *d, a);
+    }
+    if (k < n)
+        dst[k] = fill1(fa, dst[k], a);
+}
+
+// 覆われ具合 (2bppまたは4bpp) ごとのアルファと前景色の項。色が変わったときだけ作り直す
+static struct {
+    bool valid;
+    uint8_t bpp;
+    uint16_t color;
+    uint32_t c2;            // 2ピクセル分の前景色
+    uint8_t a[16];
+    uint32_t fa[16];
+} clut;
+
+static void build_clut(uint16_t color, int bpp) {
+    if (clut.valid && clut.color == color && clut.bpp == bpp)
+        return;
+
+    int max = (1 << bpp) - 1;
+    for (int v = 0; v <= max; v++) {
+        clut.a[v] = (v * LEVELS + max / 2) / max;
+        clut.fa[v] = spread(color) * clut.a[v];
+    }
+    clut.c2 = color | (uint32_t)color << 16;
+    clut.color = color;
+    clut.bpp = bpp;
+    clut.valid = true;
+}
+
+// bitsのi番目のピクセルの覆われ具合
+static inline int coverage(const uint8_t *bits, int i, int bpp) {
+    if (bpp == 4)
+        return bits[i >> 1] >> (i & 1 ? 0 : 4) & 0x0f;
+    return bits[i >> 2] >> (6 - 2 * (i & 3)) & 0x03;
+}
+
+// dstのnピクセルにbitsのi番目からの覆われ具合でclutの色を重ねる。
+// 隣り合う2ピクセルが同じ覆われ具合 (文字の内側や外側) ならワードで混ぜる
+static inline void coverage_span(uint16_t *dst, const uint8_t *bits, int i, int n, int bpp) {
+    int k = 0;
+
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        int v = coverage(bits, i, bpp);
+        if (v)
+            dst[0] = fill1(clut.fa[v], dst[0], clut.a[v]);
+        k = 1;
+    }
+    for (; k + 1 < n; k += 2) {
+        int v0 = coverage(bits, i + k, bpp);
+        int v1 = coverage(bits, i + k + 1, bpp);
+        if ((v0 | v1) == 0)
+            continue;
+
+        pix2_t *d = (pix2_t *)(dst + k);
+        if (v0 != v1) {
+            dst[k] = fill1(clut.fa[v0], dst[k], clut.a[v0]);
+            dst[k + 1] = fill1(clut.fa[v1], dst[k + 1], clut.a[v1]);
+        } else if (clut.a[v0] == LEVELS) {
+            *d = clut.c2;
+        } else {
+            *d = fill2(clut.fa[v0], *d, clut.a[v0]);
+        }
+    }
+    if (k < n) {
+        int v = coverage(bits, i + k, bpp);
+        if (v)
+            dst[k] = fill1(clut.fa[v], dst[k], clut.a[v]);
+    }
+}
+
+void blend_mask_span(uint16_t *dst, uint16_t color, const uint8_t *mask, int m0, int n) {
+    build_clut(color, 4);
+    coverage_span(dst, mask, m0, n, 4);
+}
+
+void blend_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color, int alpha) {
+    PERF_SCOPE(PERF_BLEND);
+    int w, h, sx = 0, sy = 0;
+
+    assert(fb->format == FB_RGB565);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    w = x1 - x0 + 1;
+    h = y1 - y0 + 1;
+    if (alpha_level(alpha) == 0 || !fb_clip_blit(fb, &x0, &y0, &sx, &sy, &w, &h))
+        return;
+
+    for (int y = y0; y < y0 + h; y++)
+        blend_fill_span(fb_row(fb, y) + x0, color, w, alpha);
+    if (fb->damage)
+        damage_add(fb->damage, x0, y0, x0 + w - 1, y0 + h - 1);
+}
+
+void blend_blit(struct framebuffer *fb, int x, int y, const uint16_t *src, int stride, int sx, int sy, int w, int h, int alpha) {
+    PERF_SCOPE(PERF_BLEND);
+    assert(fb->format == FB_RGB565);
+    if (alpha_level(alpha) == 0 || !fb_clip_blit(fb, &x, &y, &sx, &sy, &w, &h))
+        return;
+
+    const uint16_t *s = src + sy * stride + sx;
+    for (int i = 0; i < h; i++, s += stride)
+        blend_span(fb_row(fb, y + i) + x, s, w, alpha);
+    if (fb->damage)
+        damage_add(fb->damage, x, y, x + w - 1, y + h - 1);
+}
+
+void blend_mask(struct framebuffer *fb, int x, int y, const uint8_t *mask, int stride, int w, int h, uint16_t color) {
+    PERF_SCOPE(PERF_BLEND);
+    int sx = 0, sy = 0;
+
+    assert(fb->format == FB_RGB565);
+    if (!fb_clip_blit(fb, &x, &y, &sx, &sy, &w, &h))
+        return;
+
+    build_clut(color, 4);
+    for (int i = 0; i < h; i++)
+        coverage_span(fb_row(fb, y + i) + x, mask + (sy + i) * stride, sx, w, 4);
+    if (fb->damage)
+        damage_add(fb->damage, x, y, x + w - 1, y + h - 1);
+}
+
+static inline const uint8_t *aa_glyph(const struct aa_font *font, uint8_t ch) {
+    if (ch < font->first || ch > font->last)
+        ch = ' ';
+    return font->bits + (ch - font->first) * font->height * ((font->width * font->bpp + 7) / 8);
+}
+
+// 変更領域を登録せずに1文字描く
+static void put_aa_char(struct framebuffer *fb, const struct aa_font *font, int x, int y, uint8_t ch) {
+    int row_bytes = (font->width * font->bpp + 7) / 8;
+    int sx = 0, sy = 0, w = font->width, h = font->height;
+
+    if (!fb_clip_blit(fb, &x, &y, &sx, &sy, &w, &h))
+        return;
+
+    const uint8_t *g = aa_glyph(font, ch) + sy * row_bytes;
+    for (int i = 0; i < h; i++, g += row_bytes) {
+        // 同じ処理をbppを定数にして展開させる
+        if (font->bpp == 4)
+            coverage_span(fb_row(fb, y + i) + x, g, sx, w, 4);
+        else
+            coverage_span(fb_row(fb, y + i) + x, g, sx, w, 2);
+    }
+}
+
+int draw_aa_char(struct framebuffer *fb, const struct aa_font *font, int x, int y, uint8_t ch, uint16_t color) {
+    PERF_SCOPE(PERF_TEXT);
+    assert(fb->format == FB_RGB565);
+    build_clut(color, font->bpp);
+    put_aa_char(fb, font, x, y, ch);
+    if (fb->damage)
+        damage_add(fb->damage, x, y, x + font->width - 1, y + font->height - 1);
+    return font->width;
+}
+
+int draw_aa_text(struct framebuffer *fb, const struct aa_font *font, int x, int y, const char *str, uint16_t color) {
+    PERF_SCOPE(PERF_TEXT);
+    int x_start = x;
+
+    assert(fb->format == FB_RGB565);
+    build_clut(color, font->bpp);
+    for (; *str && x < SSD1331_WIDTH; x += font->width)
+        put_aa_char(fb, font, x, y, *str++);
+
+    // 文字列全体を1つの矩形として登録する
+    if (fb->damage && x > x_start)
+        damage_add(fb->damage, x_start, y, x - 1, y + font->height - 1);
+    return x + strlen(str) * font->width;
+}
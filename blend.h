@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef BLEND_H
+#define BLEND_H
+
+#include <stdint.h>
+#include "gfx.h"
+
+/* RGB565のアルファブレンド
+
+   2ピクセル (32bitワード) ずつ混ぜる。ワードをマスク0x07E0F81Fで取り出すと
+   下位のピクセルのRとB、上位のピクセルのGが互いに離れた位置に入るので、
+   1回の乗算で3成分をまとめて混ぜられる。ワードの上下を入れ替えて
+   もう1回行えば2ピクセル分になる (成分ごとに取り出すと1ピクセルに3回の乗算)。
+
+   アルファは0 (透明) から255 (不透明) で指定し、内部では33段階 (0-32) に丸める。
+   各成分は (前景 * a + 背景 * (32 - a)) / 32 で、ピクセルごとに計算した場合と同じ値になる。
+
+   フレームバッファの関数はRGB565だけを扱い、変更した矩形をdamageに登録する。
+*/
+
+#define ALPHA_OPAQUE    255
+
+// 0-255のアルファを内部の0-32にする
+static inline int alpha_level(int alpha) {
+    return (alpha + 4) >> 3;
+}
+
+// アンチエイリアスをかけたフォント: 各ピクセルは文字に覆われている割合 (2bppまたは4bpp)
+struct aa_font {
+    uint8_t width;
+    uint8_t height;
+    uint8_t bpp;            // 2または4
+    uint8_t first;          // 最初と最後の文字コード
+    uint8_t last;
+    const uint8_t *bits;    // 1文字height行、1行 (width * bpp + 7) / 8 バイト (上位ビットが左端)
+};
+
+// font.hと同じ字形から tools/font_compiler -a 4 で生成した8x8の4bppフォント
+extern const struct aa_font font_aa8x8;
+
+// dstのnピクセルにsrcをアルファで重ねる
+void blend_span(uint16_t *dst, const uint16_t *src, int n, int alpha);
+// dstのnピクセルにcolorをアルファで重ねる
+void blend_fill_span(uint16_t *dst, uint16_t color, int n, int alpha);
+// dstのnピクセルにcolorを4bppのマスクで重ねる。マスクはmaskの先頭からm0番目のピクセル (上位ニブルが左) から使う
+void blend_mask_span(uint16_t *dst, uint16_t color, const uint8_t *mask, int m0, int n);
+
+// 矩形を半透明の色で塗る
+void blend_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color, int alpha);
+// blit()と同じ矩形をアルファで重ねる
+void blend_blit(struct framebuffer *fb, int x, int y, const uint16_t *src, int stride, int sx, int sy, int w, int h, int alpha);
+// 4bppのマスク (1行strideバイト、0が透明、15が不透明) の w x h の形をcolorで (x,y) に描く
+void blend_mask(struct framebuffer *fb, int x, int y, const uint8_t *mask, int stride, int w, int h, uint16_t color);
+// アンチエイリアスをかけた文字を背景に重ねて描き、次の文字までの幅を返す
+int draw_aa_char(struct framebuffer *fb, const struct aa_font *font, int x, int y, uint8_t ch, uint16_t color);
+// 文字列を描いて最後の文字の次のx座標を返す
+int draw_aa_text(struct framebuffer *fb, const struct aa_font *font, int x, int y, const char *str, uint16_t color);
+
+#endif // BLEND_H
@@ -0,0 +1,329 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "console.h"
+#include "accel.h"
+#include "glyph.h"
+#include "perf.h"
+
+#define CELL            8
+#define TAB_WIDTH       4
+
+// 画面の行rowが置かれているGDDRAMの先頭の行。開始行は8の倍数なので
+// 1行の8ピクセルはGDDRAM上でも連続している
+static inline int ram_row(struct console *con, int row) {
+    int y = row * CELL + con->start;
+    return y < ssd1331_height(con->dev) ? y : y - SSD1331_HEIGHT;
+}
+
+// 表示開始行はRAMの行の方向にしか動かないので、90/270度の画面ではCOPYでスクロールする
+static inline bool use_start_line(struct console *con) {
+    return con->mode == CONSOLE_SCROLL_AUTO && con->top == 0 && con->rows == con->lines
+        && !ssd1331_transposed(con->dev);
+}
+
+static inline int bottom(struct console *con) {
+    return con->top + con->rows - 1;
+}
+
+// 論理座標の画面の幅と高さ (ピクセル)
+static inline int screen_w(struct console *con) {
+    return con->cols * CELL;
+}
+
+static inline int screen_h(struct console *con) {
+    return con->lines * CELL;
+}
+
+static void clear_rows(struct console *con, int r0, int r1) {
+    for (int r = r0; r <= r1; r++) {
+        memset(con->text[r], ' ', CONSOLE_MAX);
+        for (int c = 0; c < CONSOLE_MAX; c++)
+            con->color[r][c] = con->fg;
+    }
+}
+
+// row行のc0からc1桁を送る
+static void draw_cells(struct console *con, int row, int c0, int c1) {
+    render_cells(con->dev, c0 * CELL, ram_row(con, row), con->text[row] + c0, con->color[row] + c0, c1 - c0 + 1, con->bg);
+}
+
+static inline void mark_dirty(struct console *con, int col) {
+    con->dirty0 = MIN(con->dirty0, col);
+    con->dirty1 = MAX(con->dirty1, col);
+}
+
+static inline void clear_dirty(struct console *con) {
+    con->dirty0 = CONSOLE_MAX;
+    con->dirty1 = -1;
+}
+
+// カーソルの行の未転送の桁を送る
+static void flush_row(struct console *con) {
+    if (con->dirty0 > con->dirty1)
+        return;
+
+    draw_cells(con, con->row, con->dirty0, con->dirty1);
+    // 送った桁にカーソルがあれば文字で上書きされている
+    if (con->cursor_row == con->row && con->cursor_col >= con->dirty0 && con->cursor_col <= con->dirty1)
+        con->cursor_col = -1;
+    clear_dirty(con);
+}
+
+// カーソルの下線を消す。空白ならその1行だけを背景色で塗る
+static void hide_cursor(struct console *con) {
+    int c = con->cursor_col;
+    int r = con->cursor_row;
+
+    if (c < 0)
+        return;
+    con->cursor_col = -1;
+    // 未転送の桁に含まれていればflush_row()で描き直される
+    if (r == con->row && c >= con->dirty0 && c <= con->dirty1)
+        return;
+
+    if (con->text[r][c] == ' ') {
+        int y = ram_row(con, r) + CELL - 1;
+        accel_fill(con->dev, NULL, c * CELL, y, c * CELL + CELL - 1, y, con->bg);
+    } else {
+        draw_cells(con, r, c, c);
+    }
+}
+
+static void show_cursor(struct console *con) {
+    int c = MIN(con->col, con->cols - 1);
+    int y = ram_row(con, con->row) + CELL - 1;
+
+    accel_fill(con->dev, NULL, c * CELL, y, c * CELL + CELL - 1, y, con->fg);
+    con->cursor_col = c;
+    con->cursor_row = con->row;
+}
+
+// 未転送の文字とカーソルを送る
+static void flush(struct console *con) {
+    int c = MIN(con->col, con->cols - 1);
+
+    if (con->cursor_col >= 0 && (!con->cursor || con->cursor_col != c || con->cursor_row != con->row))
+        hide_cursor(con);
+    flush_row(con);
+    if (con->cursor && con->cursor_col < 0)
+        show_cursor(con);
+    // 開始行のコマンドがキューに残っていることがある
+    flush_cmds(con->dev);
+}
+
+// スクロール範囲を1行上げて、現れた最下行をクリアする
+static void scroll_up(struct console *con) {
+    int top = con->top;
+    int bot = bottom(con);
+
+    memmove(con->text[top], con->text[top + 1], (bot - top) * CONSOLE_MAX);
+    memmove(con->color[top], con->color[top + 1], (bot - top) * sizeof(con->color[0]));
+    clear_rows(con, bot, bot);
+
+    if (use_start_line(con)) {
+        // 先頭の行のGDDRAMが新しい最下行になる。表示をずらす前にクリアしておき、
+        // 開始行のコマンドは次のトランザクションと一緒に送る
+        int y = ram_row(con, 0);
+        accel_fill(con->dev, NULL, 0, y, screen_w(con) - 1, y + CELL - 1, con->bg);
+        con->start = (con->start + CELL) & (SSD1331_HEIGHT - 1);
+        queue_cmd(con->dev, SSD1331_SET_DISP_START_LINE);
+        queue_cmd(con->dev, con->start);
+    } else {
+        // 重なりのあるCOPYは避けて1行ずつ上に移す
+        assert(con->start == 0);
+        for (int r = top; r < bot; r++)
+            accel_copy(con->dev, NULL, 0, (r + 1) * CELL, screen_w(con) - 1, (r + 2) * CELL - 1, 0, r * CELL);
+        accel_fill(con->dev, NULL, 0, bot * CELL, screen_w(con) - 1, bot * CELL + CELL - 1, con->bg);
+    }
+}
+
+static void newline(struct console *con) {
+    flush_row(con);
+    con->col = 0;
+    if (con->row == bottom(con)) {
+        // カーソルの行がずれるので先に消しておく
+        hide_cursor(con);
+        scroll_up(con);
+    } else if (con->row < con->lines - 1) {
+        con->row++;
+    }
+}
+
+static void put(struct console *con, char ch) {
+    switch (ch) {
+    case '\n':
+        newline(con);
+        break;
+    case '\r':
+        flush_row(con);
+        con->col = 0;
+        break;
+    case '\b':
+        if (con->col > 0)
+            con->col--;
+        break;
+    case '\t':
+        con->col = MIN((con->col / TAB_WIDTH + 1) * TAB_WIDTH, con->cols);
+        break;
+    case '\f':
+        console_clear(con);
+        break;
+    default:
+        if ((uint8_t)ch < ' ')
+            break;
+        // 行末の次の文字で折り返す
+        if (con->col >= con->cols)
+            newline(con);
+        con->text[con->row][con->col] = ch;
+        con->color[con->row][con->col] = con->fg;
+        mark_dirty(con, con->col);
+        con->col++;
+        break;
+    }
+}
+
+// 桁数と行数を今の向きの画面に合わせる。行数が変わったらスクロール範囲を画面全体にする
+static void fit_screen(struct console *con) {
+    int lines = ssd1331_height(con->dev) / CELL;
+
+    con->cols = ssd1331_width(con->dev) / CELL;
+    if (lines != con->lines) {
+        con->lines = lines;
+        con->top = 0;
+        con->rows = lines;
+        con->row = MIN(con->row, lines - 1);
+    }
+    con->col = MIN(con->col, con->cols);
+}
+
+void console_init(struct console *con, struct ssd1331 *dev, uint16_t fg, uint16_t bg) {
+    con->dev = dev;
+    con->lines = 0;
+    con->col = 0;
+    con->row = 0;
+    con->start = 0;
+    con->mode = CONSOLE_SCROLL_AUTO;
+    con->fg = fg;
+    con->bg = bg;
+    con->cursor = false;
+    con->cursor_col = -1;
+    con->cursor_row = 0;
+    clear_dirty(con);
+    clear_rows(con, 0, CONSOLE_MAX - 1);
+    fit_screen(con);
+
+    queue_cmd(con->dev, SSD1331_SET_DISP_START_LINE);
+    queue_cmd(con->dev, 0);
+    accel_fill(con->dev, NULL, 0, 0, screen_w(con) - 1, screen_h(con) - 1, bg);
+}
+
+void console_set_color(struct console *con, uint16_t fg) {
+    con->fg = fg;
+}
+
+// 開始行を使わなくなったら0に戻す
+static void check_start(struct console *con) {
+    if (!use_start_line(con) && con->start != 0)
+        console_redraw(con);
+}
+
+void console_set_region(struct console *con, int top, int rows) {
+    assert(top >= 0 && rows > 0 && top + rows <= con->lines);
+
+    flush_row(con);
+    con->top = top;
+    con->rows = rows;
+    con->col = 0;
+    con->row = top;
+    check_start(con);
+    flush(con);
+}
+
+void console_set_scroll(struct console *con, console_scroll_t mode) {
+    flush_row(con);
+    con->mode = mode;
+    check_start(con);
+    flush(con);
+}
+
+void console_show_cursor(struct console *con, bool on) {
+    con->cursor = on;
+    flush(con);
+}
+
+void console_move(struct console *con, int col, int row) {
+    assert(col >= 0 && col < con->cols && row >= 0 && row < con->lines);
+
+    flush_row(con);
+    con->col = col;
+    con->row = row;
+    flush(con);
+}
+
+void console_clear(struct console *con) {
+    int y0 = con->top * CELL;
+    int y1 = y0 + con->rows * CELL - 1;
+
+    clear_dirty(con);
+    clear_rows(con, con->top, bottom(con));
+    if (con->cursor_row >= con->top && con->cursor_row <= bottom(con))
+        con->cursor_col = -1;
+    con->col = 0;
+    con->row = con->top;
+
+    if (con->start == 0) {
+        accel_fill(con->dev, NULL, 0, y0, screen_w(con) - 1, y1, con->bg);
+    } else {
+        // 範囲は画面全体なので開始行からのずれは関係ない
+        accel_fill(con->dev, NULL, 0, 0, screen_w(con) - 1, screen_h(con) - 1, con->bg);
+    }
+}
+
+void console_redraw(struct console *con) {
+    fit_screen(con);
+    con->start = 0;
+    queue_cmd(con->dev, SSD1331_SET_DISP_START_LINE);
+    queue_cmd(con->dev, 0);
+
+    clear_dirty(con);
+    for (int r = 0; r < con->lines; r++)
+        draw_cells(con, r, 0, con->cols - 1);
+    con->cursor_col = -1;
+    flush(con);
+}
+
+void console_putc(struct console *con, char ch) {
+    PERF_SCOPE(PERF_TEXT);
+    put(con, ch);
+    flush(con);
+}
+
+void console_puts(struct console *con, const char *str) {
+    PERF_SCOPE(PERF_TEXT);
+    while (*str)
+        put(con, *str++);
+    flush(con);
+}
+
+int console_vprintf(struct console *con, const char *fmt, va_list ap) {
+    // 画面に収まる分だけ出力する
+    char buf[CONSOLE_COLS * CONSOLE_ROWS + 1];
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+
+    console_puts(con, buf);
+    return n;
+}
+
+int console_printf(struct console *con, const char *fmt, ...) {
+    va_list ap;
+
+    va_start(ap, fmt);
+    int n = console_vprintf(con, fmt, ap);
+    va_end(ap);
+    return n;
+}
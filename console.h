@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "ssd1331.h"
+
+/* ハードウェアスクロールによる12桁8行のテキストコンソール
+
+   フレームバッファを使わず、文字はrender_text()でパネルに直接送る。
+   1行送るときは画面を描き直さず、次のどちらかで表示をずらしてから
+   新しく現れた8ピクセルの行だけをクリアする。
+
+   * 開始行 (CONSOLE_SCROLL_AUTOでスクロール範囲が画面全体の場合):
+     GDDRAMの64行をリングとして使い、SET_DISP_START_LINEを8行ずつ進める。
+     コマンドは2バイトで済むが、パネルの行とGDDRAMの行がずれるので
+     コンソールを使っている間は他の描画をパネルに送ってはならない
+   * COPY (スクロール範囲が画面の一部の場合、またはCONSOLE_SCROLL_COPY):
+     範囲の各行をアクセラレータのCOPYで1行上に移す。開始行は0のままなので
+     範囲外の行 (ステータス表示など) は通常の描画で更新できる
+
+   12桁の行を1行追加したときの転送量は約1.5KB (全画面の描き直しは12KB)。
+
+   90/270度の画面では8桁12行になり、開始行はRAMの行の方向にしか動かないので
+   常にCOPYでスクロールする。向きを変えたらconsole_redraw()で桁数と行数を合わせる。
+
+   桁あふれは次の行に折り返す (12桁ちょうどの行に続く'\n'で空行はできない)。
+   制御文字は'\n' (行頭に戻して改行), '\r', '\b', '\t' (4桁ごと), '\f' (範囲をクリア) を扱う。
+*/
+
+#define CONSOLE_COLS    (SSD1331_WIDTH / 8)
+#define CONSOLE_ROWS    (SSD1331_HEIGHT / 8)
+#define CONSOLE_MAX     CONSOLE_COLS    // どちらの向きでも桁数と行数はこれ以下
+
+typedef enum console_scroll {
+    CONSOLE_SCROLL_AUTO,    // 範囲が画面全体なら開始行、一部ならCOPY
+    CONSOLE_SCROLL_COPY     // 常にCOPY (開始行を動かさない)
+} console_scroll_t;
+
+struct console {
+    struct ssd1331 *dev;
+    uint8_t top;            // スクロール範囲の先頭の行
+    uint8_t rows;           // スクロール範囲の行数
+    uint8_t cols;           // 画面の桁数と行数 (向きで変わる)
+    uint8_t lines;
+    uint8_t col;            // カーソルの桁 (colsなら次の文字で折り返す)
+    uint8_t row;            // カーソルの行 (画面上の行)
+    uint8_t start;          // パネルの開始行 (GDDRAMの行)
+    console_scroll_t mode;
+    uint16_t fg;
+    uint16_t bg;
+    bool cursor;            // カーソルを表示する
+    int8_t cursor_col;      // 表示中のカーソルの位置 (-1: 表示していない)
+    int8_t cursor_row;
+    int8_t dirty0;          // カーソルの行で未転送の桁の範囲 (dirty0 > dirty1なら無し)
+    int8_t dirty1;
+    char text[CONSOLE_MAX][CONSOLE_MAX];
+    uint16_t color[CONSOLE_MAX][CONSOLE_MAX];
+};
+
+// devの画面全体をスクロール範囲にして、bgで画面をクリアする
+void console_init(struct console *con, struct ssd1331 *dev, uint16_t fg, uint16_t bg);
+// 以降の文字の色
+void console_set_color(struct console *con, uint16_t fg);
+// スクロール範囲をtop行からrows行にする。カーソルは範囲の先頭に移る。
+// 開始行が0でなくなっていればCOPYに切り替えるため画面全体を描き直す
+void console_set_region(struct console *con, int top, int rows);
+void console_set_scroll(struct console *con, console_scroll_t mode);
+void console_show_cursor(struct console *con, bool on);
+void console_move(struct console *con, int col, int row);
+// スクロール範囲をクリアしてカーソルを範囲の先頭に戻す
+void console_clear(struct console *con);
+// 保持している文字から画面全体を描き直す。桁数と行数は今の向きに合わせ、
+// 収まらなくなったスクロール範囲は画面全体に戻す
+void console_redraw(struct console *con);
+void console_putc(struct console *con, char ch);
+void console_puts(struct console *con, const char *str);
+int console_printf(struct console *con, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+int console_vprintf(struct console *con, const char *fmt, va_list ap);
+
+#endif // CONSOLE_H
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "damage.h"
+
+// ウィンドウ設定: SET_COL_ADDR, c0, c1, SET_ROW_ADDR, r0, r1
+#define WINDOW_CMD_BYTES    6
+
+static inline int rect_area(const struct damage_rect *r) {
+    return (r->x1 - r->x0 + 1) * (r->y1 - r->y0 + 1);
+}
+
+static inline struct damage_rect rect_union(const struct damage_rect *a, const struct damage_rect *b) {
+    struct damage_rect u = {
+        .x0 = MIN(a->x0, b->x0),
+        .y0 = MIN(a->y0, b->y0),
+        .x1 = MAX(a->x1, b->x1),
+        .y1 = MAX(a->y1, b->y1)
+    };
+    return u;
+}
+
+// aとbを併合したときに増えるピクセル数
+static inline int merge_cost(const struct damage_rect *a, const struct damage_rect *b) {
+    struct damage_rect u = rect_union(a, b);
+    return rect_area(&u) - rect_area(a) - rect_area(b);
+}
+
+static void remove_rect(struct damage *d, int i) {
+    d->rects[i] = d->rects[--d->count];
+}
+
+void damage_init(struct damage *d) {
+    d->full_percent = DAMAGE_FULL_PERCENT;
+    damage_clear(d);
+}
+
+void damage_clear(struct damage *d) {
+    d->count = 0;
+    d->full = false;
+}
+
+void damage_add_all(struct damage *d) {
+    d->count = 0;
+    d->full = true;
+}
+
+void damage_add(struct damage *d, int x0, int y0, int x1, int y1) {
+    if (d->full)
+        return;
+
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    if (x1 < 0 || y1 < 0 || x0 >= SSD1331_WIDTH || y0 >= SSD1331_HEIGHT)
+        return;
+
+    struct damage_rect r = {
+        .x0 = MAX(x0, 0),
+        .y0 = MAX(y0, 0),
+        .x1 = MIN(x1, SSD1331_WIDTH - 1),
+        .y1 = MIN(y1, SSD1331_HEIGHT - 1)
+    };
+
+    // 併合してもほとんど面積が増えない矩形があれば併合する。
+    // 併合で大きくなった矩形がさらに別の矩形と併合できることがあるので繰り返す
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < d->count; i++) {
+            if (merge_cost(&d->rects[i], &r) <= DAMAGE_MERGE_SLACK) {
+                r = rect_union(&d->rects[i], &r);
+                remove_rect(d, i);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (d->count < DAMAGE_MAX_RECTS) {
+        d->rects[d->count++] = r;
+        return;
+    }
+
+    // 空きがなければ増加面積が最小の矩形と併合する
+    int best = 0;
+    int best_cost = merge_cost(&d->rects[0], &r);
+    for (int i = 1; i < d->count; i++) {
+        int cost = merge_cost(&d->rects[i], &r);
+        if (cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    r = rect_union(&d->rects[best], &r);
+    remove_rect(d, best);
+    // 併合結果で再度登録し直す (他の矩形との併合も試みる)
+    damage_add(d, r.x0, r.y0, r.x1, r.y1);
+}
+
+size_t damage_bytes(const struct damage *d) {
+    if (d->full)
+        return WINDOW_CMD_BYTES + 2 * SSD1331_BUF_LEN;
+
+    size_t bytes = 0;
+    for (int i = 0; i < d->count; i++)
+        bytes += WINDOW_CMD_BYTES + 2 * rect_area(&d->rects[i]);
+    return bytes;
+}
+
+bool damage_use_full(const struct damage *d) {
+    if (d->full)
+        return true;
+
+    size_t full = WINDOW_CMD_BYTES + 2 * SSD1331_BUF_LEN;
+    return damage_bytes(d) * 100 >= full * d->full_percent;
+}
+
+size_t damage_flush_bytes(const struct damage *d) {
+    if (damage_use_full(d))
+        return WINDOW_CMD_BYTES + 2 * SSD1331_BUF_LEN;
+    return damage_bytes(d);
+}
+
+size_t damage_add_cost(const struct damage *d, int x0, int y0, int x1, int y1) {
+    struct damage tmp = *d;
+
+    damage_add(&tmp, x0, y0, x1, y1);
+    size_t before = damage_flush_bytes(d);
+    size_t after = damage_flush_bytes(&tmp);
+    // 併合でウィンドウが減ると転送量が減ることもある
+    return after > before ? after - before : 0;
+}
+
+bool damage_covers(const struct damage *d, int x0, int y0, int x1, int y1) {
+    if (d->full)
+        return true;
+
+    for (int i = 0; i < d->count; i++) {
+        const struct damage_rect *r = &d->rects[i];
+        if (r->x0 <= x0 && x1 <= r->x1 && r->y0 <= y0 && y1 <= r->y1)
+            return true;
+    }
+    return false;
+}
+
+bool damage_intersects(const struct damage *d, int x0, int y0, int x1, int y1) {
+    if (d->full)
+        return true;
+
+    for (int i = 0; i < d->count; i++) {
+        const struct damage_rect *r = &d->rects[i];
+        if (r->x0 <= x1 && x0 <= r->x1 && r->y0 <= y1 && y0 <= r->y1)
+            return true;
+    }
+    return false;
+}
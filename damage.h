@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* フレームバッファの変更領域 (ダメージ) の追跡
+
+   描画関数が変更した矩形を登録し、重なったり近接した矩形は併合して
+   少数の矩形にまとめる。render_dirty()は矩形ごとにウィンドウを1つ設定して
+   データを1回のバーストで送る。
+*/
+
+#define DAMAGE_MAX_RECTS        16  // 保持する矩形の最大数
+#define DAMAGE_MERGE_SLACK      8   // 併合で増えてもよい余分なピクセル数 (ウィンドウ設定1回分程度)
+#define DAMAGE_FULL_PERCENT     75  // 部分転送がこの割合(%)以上なら全画面を送る
+
+struct damage_rect {
+    uint8_t x0;
+    uint8_t y0;
+    uint8_t x1;
+    uint8_t y1;
+};
+
+struct damage {
+    struct damage_rect rects[DAMAGE_MAX_RECTS];
+    int count;
+    bool full;          // 全画面が変更されている
+    int full_percent;   // 全画面転送に切り替える閾値 (%): 0なら常に全画面、100超で常に部分転送
+};
+
+void damage_init(struct damage *d);
+void damage_clear(struct damage *d);
+// 変更領域 (x0,y0)-(x1,y1) を登録する。画面外の部分は切り取られる
+void damage_add(struct damage *d, int x0, int y0, int x1, int y1);
+void damage_add_all(struct damage *d);
+// 部分転送した場合のSPI上のバイト数 (ウィンドウ設定のコマンドを含む)
+size_t damage_bytes(const struct damage *d);
+// 部分転送より全画面転送を選ぶべきか
+bool damage_use_full(const struct damage *d);
+// render_dirty()で実際に転送されるバイト数 (全画面への切り替えを考慮)
+size_t damage_flush_bytes(const struct damage *d);
+// 変更領域 (x0,y0)-(x1,y1) を追加したときに増える転送バイト数
+size_t damage_add_cost(const struct damage *d, int x0, int y0, int x1, int y1);
+// (x0,y0)-(x1,y1) (x0 <= x1, y0 <= y1) が1つの矩形に含まれるか (全画面なら常に含まれる)
+bool damage_covers(const struct damage *d, int x0, int y0, int x1, int y1);
+// 変更領域が (x0,y0)-(x1,y1) と重なるか
+bool damage_intersects(const struct damage *d, int x0, int y0, int x1, int y1);
+
+#endif // DAMAGE_H
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "gfx.h"
+#include "dlist.h"
+
+void dl_init(struct dlist *dl, struct dl_op *ops, int max, uint16_t background) {
+    dl->ops = ops;
+    dl->max = max;
+    dl->background = background;
+    dl_clear(dl);
+}
+
+void dl_clear(struct dlist *dl) {
+    dl->count = 0;
+}
+
+static bool push(struct dlist *dl, dl_op_type_t type, int x0, int y0, int x1, int y1,
+                 uint16_t color, const void *data) {
+    if (dl->count == dl->max)
+        return false;
+
+    struct dl_op *op = &dl->ops[dl->count++];
+    op->type = type;
+    op->x0 = x0;
+    op->y0 = y0;
+    op->x1 = x1;
+    op->y1 = y1;
+    op->color = color;
+    op->data = data;
+    return true;
+}
+
+bool dl_line(struct dlist *dl, int x0, int y0, int x1, int y1, uint16_t color) {
+    return push(dl, DL_LINE, x0, y0, x1, y1, color, NULL);
+}
+
+bool dl_rect(struct dlist *dl, int x0, int y0, int x1, int y1, uint16_t color) {
+    return push(dl, DL_RECT, MIN(x0, x1), MIN(y0, y1), MAX(x0, x1), MAX(y0, y1), color, NULL);
+}
+
+bool dl_fill(struct dlist *dl, int x0, int y0, int x1, int y1, uint16_t color) {
+    return push(dl, DL_FILL, MIN(x0, x1), MIN(y0, y1), MAX(x0, x1), MAX(y0, y1), color, NULL);
+}
+
+bool dl_text(struct dlist *dl, int x, int y, const char *str, uint16_t color) {
+    return push(dl, DL_TEXT, x, y, 0, 0, color, str);
+}
+
+bool dl_image(struct dlist *dl, int x, int y, int width, int height, const uint16_t *img) {
+    return push(dl, DL_IMAGE, x, y, width, height, 0, img);
+}
+
+// 命令が描く行の範囲
+static void op_rows(const struct dl_op *op, int *top, int *bottom) {
+    switch (op->type) {
+    case DL_TEXT:
+        *top = op->y0;
+        *bottom = op->y0 + 7;
+        break;
+    case DL_IMAGE:
+        *top = op->y0;
+        *bottom = op->y0 + op->y1 - 1;
+        break;
+    default:
+        *top = MIN(op->y0, op->y1);
+        *bottom = MAX(op->y0, op->y1);
+        break;
+    }
+}
+
+static void raster_band(struct dlist *dl, struct framebuffer *fb, uint16_t *buf, int y0, int rows) {
+    int top, bottom;
+
+    fb_init_band(fb, buf, y0, rows);
+    fb_clear(fb, dl->background);
+
+    for (int i = 0; i < dl->count; i++) {
+        const struct dl_op *op = &dl->ops[i];
+
+        op_rows(op, &top, &bottom);
+        if (bottom < y0 || top >= y0 + rows)
+            continue;
+
+        switch (op->type) {
+        case DL_LINE:
+            draw_line(fb, op->x0, op->y0, op->x1, op->y1, op->color);
+            break;
+        case DL_RECT:
+            draw_rect(fb, op->x0, op->y0, op->x1, op->y1, op->color);
+            break;
+        case DL_FILL:
+            fill_rect(fb, op->x0, op->y0, op->x1, op->y1, op->color);
+            break;
+        case DL_TEXT:
+            write_string(fb, op->x0, op->y0, op->data, op->color);
+            break;
+        case DL_IMAGE:
+            draw_image(fb, op->x0, op->y0, op->x1, op->y1, op->data);
+            break;
+        }
+    }
+}
+
+void dl_render(struct ssd1331 *dev, struct dlist *dl, uint16_t *band0, uint16_t *band1, int band_rows) {
+    uint16_t *bands[2] = { band0, band1 ? band1 : band0 };
+    struct render_area area = {
+        start_col : 0,
+        end_col : SSD1331_WIDTH - 1
+    };
+    struct framebuffer fb;
+    int n = 0;
+
+    for (int y = 0; y < SSD1331_HEIGHT; y += band_rows, n ^= 1) {
+        int rows = MIN(band_rows, SSD1331_HEIGHT - y);
+
+        // バンドが1つの場合は前のバンドの転送が終わってから描画する。
+        // 2つの場合は前々回に渡したこのバンドの転送が終わるのを待てば、
+        // 前回のバンドの転送と並行して描画できる
+        render_wait_queued(dev, band1 ? 1 : 0);
+        raster_band(dl, &fb, bands[n], y, rows);
+
+        // 90/270度ではバンドを列の順に読んで送る (転送の完了を待つ)
+        if (ssd1331_transposed(dev)) {
+            render_transposed(dev, &fb, 0, y, SSD1331_WIDTH - 1, y + rows - 1);
+            continue;
+        }
+        area.start_row = y;
+        area.end_row = y + rows - 1;
+        calc_render_area_buflen(&area);
+        render_async(dev, bands[n], &area, NULL, NULL);
+    }
+    render_wait(dev);
+}
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef DLIST_H
+#define DLIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ディスプレイリスト: 描画命令を記録しておき、バンド単位で描画して転送する
+
+   全画面のフレームバッファ (12KB) の代わりに数行分のバンドバッファだけで
+   画面を描画できる。バンドを2つ渡すと、一方をDMAで転送している間に
+   もう一方に次のバンドを描画する。
+
+   テキストと画像はポインタだけを記録するので、dl_render()が終わるまで
+   呼び出し側で保持しておくこと。
+*/
+
+typedef enum dl_op_type {
+    DL_LINE,
+    DL_RECT,
+    DL_FILL,
+    DL_TEXT,
+    DL_IMAGE
+} dl_op_type_t;
+
+// 座標は画面の外 (負の値や96以上) でもよく、描画時に即時の描画と同じく切り取る
+struct dl_op {
+    uint8_t type;
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;         // DL_TEXTでは未使用、DL_IMAGEでは幅
+    int16_t y1;         // DL_TEXTでは未使用、DL_IMAGEでは高さ
+    uint16_t color;
+    const void *data;   // DL_TEXT: 文字列、DL_IMAGE: RGB565の画像
+};
+
+struct dlist {
+    struct dl_op *ops;
+    int count;
+    int max;
+    uint16_t background;
+};
+
+void dl_init(struct dlist *dl, struct dl_op *ops, int max, uint16_t background);
+void dl_clear(struct dlist *dl);
+
+// 記録できなければfalseを返す
+bool dl_line(struct dlist *dl, int x0, int y0, int x1, int y1, uint16_t color);
+bool dl_rect(struct dlist *dl, int x0, int y0, int x1, int y1, uint16_t color);
+bool dl_fill(struct dlist *dl, int x0, int y0, int x1, int y1, uint16_t color);
+bool dl_text(struct dlist *dl, int x, int y, const char *str, uint16_t color);
+bool dl_image(struct dlist *dl, int x, int y, int width, int height, const uint16_t *img);
+
+// band_rows行ずつのバンドに描画して転送する。band0, band1はそれぞれ
+// band_rows * SSD1331_WIDTH個のピクセルを持つ。band1がNULLならバンド1つで
+// 転送の完了を待ちながら描画する。90/270度の画面では座標をフレームバッファと同じく
+// 転置して記録し、バンドは1つずつ送り終えてから次を描く
+void dl_render(struct ssd1331 *dev, struct dlist *dl, uint16_t *band0, uint16_t *band1, int band_rows);
+
+#endif // DLIST_H
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ssd1331.h"
+#include "ssd1331_emu.h"
+#include "gfx.h"
+#include "accel.h"
+#include "glyph.h"
+#include "asset_pack.h"
+
+/* ホスト用のデモ: ドライバをSSD1331のモデルにつないで描画し、
+   段階ごとの転送量とSPIでの転送時間を表示して、最後の画面をPPMに書き出す
+
+     ssd1331_emu [-c SPIクロック(Hz)] [-o 出力.ppm]
+*/
+
+static uint32_t spi_hz = 10 * 1000 * 1000;
+static struct ssd1331_bus bus;
+static struct ssd1331 oled;
+
+static void report(const char *stage) {
+    printf("%-12s ", stage);
+    emu_print_stats(stdout, spi_hz);
+    emu_stats_reset();
+}
+
+int main(int argc, char *argv[]) {
+    const char *out = "ssd1331.ppm";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:o:")) != -1) {
+        switch (opt) {
+        case 'c':
+            spi_hz = strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            out = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c spi_hz] [-o out.ppm]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ssd1331_bus_init(&bus, SPI_INSTANCE, SPI_SCK_PIN, SPI_MOSI_PIN, spi_hz);
+    ssd1331_init(&oled, &bus, SPI_CSN_PIN, SPI_DCN_PIN, SPI_RESN_PIN);
+    report("init");
+
+    uint16_t buf[SSD1331_BUF_LEN];
+    struct damage damage;
+    struct framebuffer fb;
+    fb_init(&fb, buf, &damage);
+
+    // 文字はパックのフォントで描く
+    struct glyph_font font = asset_font(asset_pack, ASSET_FONT);
+    glyph_set_font(&font);
+
+    accel_clear(&oled, &fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+    report("clear");
+
+    const char *text[] = {
+        "ABCDEFGHIJKL",
+        "MNOPQRSTUVWX",
+        "YZ0123456789"
+    };
+    for (int i = 0; i < count_of(text); i++)
+        write_string(&fb, 0, 24 + 8 * i, text[i], COL_WHITE);
+    render_dirty(&oled, &fb);
+    report("text");
+
+    fill_circle(&fb, 12, 10, 8, COL_RED);
+    fill_triangle(&fb, 30, 2, 46, 18, 26, 18, COL_GREEN);
+    draw_rect(&fb, 52, 2, 70, 18, COL_YELLOW);
+    draw_circle(&fb, 84, 10, 8, COL_AQUA);
+    render_dirty(&oled, &fb);
+    report("shapes");
+
+    // フラッシュのパックからアイコンのシートとロゴを直接送る
+    for (int i = 0; i < 4; i++) {
+        int sx, sy;
+        asset_tile(asset_pack, ASSET_ICONS, i, &sx, &sy);
+        render_blit(&oled, 16 * i, 40, asset_rgb565(asset_pack, ASSET_ICONS), ASSET_ICONS_WIDTH, sx, sy, 16, 16);
+    }
+    struct qimage logo = asset_qimage(asset_pack, ASSET_LOGO);
+    render_qimage(&oled, 70, 40, &logo);
+    report("assets");
+
+    for (int x = 0; x < SSD1331_WIDTH; x += 4) {
+        accel_line(&oled, &fb, x, 56, SSD1331_WIDTH - 1 - x, SSD1331_HEIGHT - 1, COL_ORANGE);
+        render_dirty(&oled, &fb);
+    }
+    report("lines");
+
+    if (!emu_dump_ppm(out)) {
+        perror(out);
+        return 1;
+    }
+    printf("wrote %s\n", out);
+    return 0;
+}
@@ -1,9 +1,49 @@
-static uint8_t font[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // null
+// tools/font_compiler で生成: 編集しないこと
+
+#define FONT_FIRST      0x20
+#define FONT_LAST       0x7E
+#define FONT_WIDTH      8
+#define FONT_HEIGHT     8
+
+// 1文字8バイト: 各行のビットマップ (MSBが左端)
+static const uint8_t font[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // 0x20
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x10, 0x00,     // !
+    0x28, 0x28, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00,     // "
+    0x28, 0x28, 0xfe, 0x28, 0xfe, 0x28, 0x28, 0x00,     // #
+    0x10, 0x7e, 0x90, 0x7c, 0x12, 0xfc, 0x10, 0x00,     // $
+    0xc2, 0xc4, 0x08, 0x10, 0x20, 0x46, 0x86, 0x00,     // %
+    0x70, 0x88, 0x90, 0x60, 0x94, 0x88, 0x74, 0x00,     // &
+    0x10, 0x10, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,     // '
+    0x08, 0x10, 0x20, 0x20, 0x20, 0x10, 0x08, 0x00,     // (
+    0x20, 0x10, 0x08, 0x08, 0x08, 0x10, 0x20, 0x00,     // )
+    0x00, 0x92, 0x54, 0x38, 0x54, 0x92, 0x00, 0x00,     // 0x2A
+    0x00, 0x10, 0x10, 0xfe, 0x10, 0x10, 0x00, 0x00,     // +
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x10, 0x20,     // ,
+    0x00, 0x00, 0x00, 0xfe, 0x00, 0x00, 0x00, 0x00,     // -
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00,     // .
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00,     // 0x2F
+    0x7c, 0x86, 0x8a, 0x92, 0xa2, 0xc2, 0x7c, 0x00,     // 0
+    0x10, 0x30, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00,     // 1
+    0x78, 0x84, 0x04, 0x78, 0x80, 0x80, 0xfc, 0x00,     // 2
+    0xfc, 0x02, 0x02, 0x7c, 0x02, 0x02, 0xfc, 0x00,     // 3
+    0x08, 0x18, 0x28, 0x48, 0x88, 0xfe, 0x08, 0x00,     // 4
+    0xfc, 0x80, 0x80, 0xfc, 0x02, 0x02, 0xfc, 0x00,     // 5
+    0x7c, 0x80, 0x80, 0xfc, 0x82, 0x82, 0x7c, 0x00,     // 6
+    0xfe, 0x02, 0x04, 0x08, 0x10, 0x20, 0x20, 0x00,     // 7
+    0x7c, 0x82, 0x82, 0x7c, 0x82, 0x82, 0x7c, 0x00,     // 8
+    0x7c, 0x82, 0x82, 0x7e, 0x02, 0x04, 0x08, 0x00,     // 9
+    0x00, 0x30, 0x30, 0x00, 0x30, 0x30, 0x00, 0x00,     // :
+    0x00, 0x30, 0x30, 0x00, 0x30, 0x10, 0x20, 0x00,     // ;
+    0x08, 0x10, 0x20, 0x40, 0x20, 0x10, 0x08, 0x00,     // <
+    0x00, 0x00, 0xfe, 0x00, 0xfe, 0x00, 0x00, 0x00,     // =
+    0x20, 0x10, 0x08, 0x04, 0x08, 0x10, 0x20, 0x00,     // >
+    0x7c, 0x82, 0x04, 0x08, 0x10, 0x00, 0x10, 0x00,     // ?
+    0x7c, 0x82, 0x9e, 0xa4, 0x98, 0x80, 0x7e, 0x00,     // @
     0x10, 0x28, 0x44, 0x82, 0xfe, 0x82, 0x82, 0x00,     // A
-    0xfC, 0x82, 0x82, 0xfC, 0x82, 0x82, 0xfC, 0x00,     // B
+    0xfc, 0x82, 0x82, 0xfc, 0x82, 0x82, 0xfc, 0x00,     // B
     0x7c, 0x82, 0x80, 0x80, 0x80, 0x82, 0x7c, 0x00,     // C
-    0xfc, 0x82, 0x82, 0x82, 0x82, 0x82, 0xfC, 0x00,     // D
+    0xfc, 0x82, 0x82, 0x82, 0x82, 0x82, 0xfc, 0x00,     // D
     0xfe, 0x80, 0x80, 0xfe, 0x80, 0x80, 0xfe, 0x00,     // E
     0xfe, 0x80, 0x80, 0xf8, 0x80, 0x80, 0x80, 0x00,     // F
     0xfe, 0x82, 0x80, 0x80, 0x8e, 0x82, 0xfe, 0x00,     // G
@@ -22,20 +62,60 @@ static uint8_t font[] = {
     0xfe, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00,     // T
     0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x7c, 0x00,     // U
     0x82, 0x82, 0x82, 0x82, 0x44, 0x28, 0x10, 0x00,     // V
-    0x82, 0x82, 0x82, 0x92, 0xaa, 0xc6, 0x82, 0x00,     // w
+    0x82, 0x82, 0x82, 0x92, 0xaa, 0xc6, 0x82, 0x00,     // W
     0x42, 0x24, 0x18, 0x18, 0x18, 0x24, 0x42, 0x00,     // X
     0x82, 0x44, 0x28, 0x10, 0x10, 0x10, 0x10, 0x00,     // Y
     0xfe, 0x04, 0x08, 0x10, 0x20, 0x40, 0xfe, 0x00,     // Z
-    0x7c, 0x86, 0x8a, 0x92, 0xa2, 0xc2, 0x7c, 0x00,     // 0
-    0x10, 0x30, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00,     // 1
-    0x78, 0x84, 0x04, 0x78, 0x80, 0x80, 0xfc, 0x00,     // 2
-    0xfc, 0x02, 0x02, 0x7c, 0x02, 0x02, 0xfc, 0x00,     // 3
-    0x08, 0x18, 0x28, 0x48, 0x88, 0xfe, 0x08, 0x00,     // 4
-    0xfc, 0x80, 0x80, 0xfc, 0x02, 0x02, 0xfc, 0x00,     // 5
-    0x7c, 0x80, 0x80, 0xfc, 0x82, 0x82, 0x7c, 0x00,     // 6
-    0xfe, 0x02, 0x04, 0x08, 0x10, 0x20, 0x20, 0x00,     // 7
-    0x7c, 0x82, 0x82, 0x7c, 0x82, 0x82, 0x7c, 0x00,     // 8
-    0x7c, 0x82, 0x82, 0x7e, 0x02, 0x04, 0x08, 0x00,     // 9
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00,     // .
-    0x00, 0x30, 0x30, 0x00, 0x30, 0x30, 0x00, 0x00,     // :
+    0x3c, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x00,     // [
+    0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x00,     // 0x5C
+    0x3c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x3c, 0x00,     // ]
+    0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00,     // ^
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00,     // _
+    0x20, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,     // `
+    0x00, 0x00, 0x78, 0x04, 0x7c, 0x84, 0x7c, 0x00,     // a
+    0x80, 0x80, 0xb8, 0xc4, 0x84, 0xc4, 0xb8, 0x00,     // b
+    0x00, 0x00, 0x78, 0x84, 0x80, 0x84, 0x78, 0x00,     // c
+    0x04, 0x04, 0x74, 0x8c, 0x84, 0x8c, 0x74, 0x00,     // d
+    0x00, 0x00, 0x78, 0x84, 0xfc, 0x80, 0x78, 0x00,     // e
+    0x18, 0x24, 0x20, 0x78, 0x20, 0x20, 0x20, 0x00,     // f
+    0x00, 0x00, 0x7c, 0x84, 0x84, 0x7c, 0x04, 0x78,     // g
+    0x80, 0x80, 0xb8, 0xc4, 0x84, 0x84, 0x84, 0x00,     // h
+    0x10, 0x00, 0x30, 0x10, 0x10, 0x10, 0x38, 0x00,     // i
+    0x08, 0x00, 0x18, 0x08, 0x08, 0x08, 0x88, 0x70,     // j
+    0x80, 0x80, 0x88, 0x90, 0xe0, 0x90, 0x88, 0x00,     // k
+    0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00,     // l
+    0x00, 0x00, 0xd8, 0xa8, 0xa8, 0xa8, 0xa8, 0x00,     // m
+    0x00, 0x00, 0xb8, 0xc4, 0x84, 0x84, 0x84, 0x00,     // n
+    0x00, 0x00, 0x78, 0x84, 0x84, 0x84, 0x78, 0x00,     // o
+    0x00, 0x00, 0xb8, 0xc4, 0x84, 0xf8, 0x80, 0x80,     // p
+    0x00, 0x00, 0x74, 0x8c, 0x84, 0x7c, 0x04, 0x04,     // q
+    0x00, 0x00, 0xb8, 0xc4, 0x80, 0x80, 0x80, 0x00,     // r
+    0x00, 0x00, 0x7c, 0x80, 0x78, 0x04, 0xf8, 0x00,     // s
+    0x20, 0x20, 0xf8, 0x20, 0x20, 0x24, 0x18, 0x00,     // t
+    0x00, 0x00, 0x84, 0x84, 0x84, 0x8c, 0x74, 0x00,     // u
+    0x00, 0x00, 0x84, 0x84, 0x84, 0x48, 0x30, 0x00,     // v
+    0x00, 0x00, 0x82, 0x82, 0x92, 0xaa, 0x44, 0x00,     // w
+    0x00, 0x00, 0x84, 0x48, 0x30, 0x48, 0x84, 0x00,     // x
+    0x00, 0x00, 0x84, 0x84, 0x84, 0x7c, 0x04, 0x78,     // y
+    0x00, 0x00, 0xfc, 0x08, 0x30, 0x40, 0xfc, 0x00,     // z
+    0x0c, 0x10, 0x10, 0x60, 0x10, 0x10, 0x0c, 0x00,     // {
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00,     // |
+    0x60, 0x10, 0x10, 0x0c, 0x10, 0x10, 0x60, 0x00,     // }
+    0x00, 0x00, 0x62, 0x92, 0x8c, 0x00, 0x00, 0x00,     // ~
+};
+
+// プロポーショナル表示用: 上位4bitが左の空白桁数、下位4bitが文字幅
+static const uint8_t font_prop[] = {
+    0x03, 0x31, 0x23, 0x07, 0x07, 0x07, 0x06, 0x22,
+    0x23, 0x23, 0x07, 0x07, 0x22, 0x07, 0x12, 0x07,
+    0x07, 0x23, 0x06, 0x07, 0x07, 0x07, 0x07, 0x07,
+    0x07, 0x07, 0x22, 0x22, 0x14, 0x07, 0x24, 0x07,
+    0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+    0x07, 0x23, 0x05, 0x16, 0x07, 0x07, 0x07, 0x07,
+    0x07, 0x07, 0x07, 0x06, 0x07, 0x07, 0x07, 0x07,
+    0x16, 0x07, 0x07, 0x24, 0x07, 0x24, 0x15, 0x07,
+    0x23, 0x06, 0x06, 0x06, 0x06, 0x06, 0x15, 0x06,
+    0x06, 0x23, 0x05, 0x05, 0x23, 0x05, 0x06, 0x06,
+    0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x07,
+    0x06, 0x06, 0x06, 0x15, 0x31, 0x15, 0x07,
 };
@@ -0,0 +1,106 @@
+// tools/font_compiler -a 4 で生成: 編集しないこと
+
+#define FONT_AA_FIRST   0x20
+#define FONT_AA_LAST    0x7E
+#define FONT_AA_WIDTH   8
+#define FONT_AA_HEIGHT  8
+#define FONT_AA_BPP     4
+
+// 1文字32バイト: 各行の覆われ具合 (4bpp, 上位ビットが左端)
+static const uint8_t font_aa[] = {
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // 0x20
+    0x00, 0x0d, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0d, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x0b, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // !
+    0x00, 0xd0, 0xd0, 0x00,  0x00, 0xf0, 0xf0, 0x00,  0x00, 0xd0, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // "
+    0x00, 0xd0, 0xd0, 0x00,  0x05, 0xf2, 0xf5, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x02, 0xf4, 0xf2, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x05, 0xf2, 0xf5, 0x00,  0x00, 0xd0, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // #
+    0x00, 0x5d, 0x50, 0x00,  0x5e, 0xff, 0xff, 0xd0,  0xd2, 0x2f, 0x20, 0x00,  0x5e, 0xff, 0xfe, 0x50,  0x00, 0x2f, 0x22, 0xd0,  0xdf, 0xff, 0xfe, 0x50,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x00, 0x00, 0x00,     // $
+    0xaa, 0x00, 0x05, 0xc0,  0xaa, 0x00, 0x5d, 0x50,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x05, 0xd5, 0x00, 0x00,  0x5d, 0x50, 0x0a, 0xa0,  0xc5, 0x00, 0x0a, 0xa0,  0x00, 0x00, 0x00, 0x00,     // %
+    0x5e, 0xfe, 0x50, 0x00,  0xe5, 0x02, 0xd0, 0x00,  0xe5, 0x5d, 0x50, 0x00,  0x2f, 0xf2, 0x00, 0x00,  0xe5, 0x5c, 0x2b, 0x00,  0xe5, 0x02, 0xb2, 0x00,  0x5e, 0xfd, 0x2b, 0x00,  0x00, 0x00, 0x00, 0x00,     // &
+    0x00, 0x0d, 0x00, 0x00,  0x00, 0x5e, 0x00, 0x00,  0x00, 0xc5, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // '
+    0x00, 0x05, 0xc0, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0xe5, 0x00, 0x00,  0x00, 0xf0, 0x00, 0x00,  0x00, 0xe5, 0x00, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x05, 0xc0, 0x00,  0x00, 0x00, 0x00, 0x00,     // (
+    0x00, 0xc5, 0x00, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x05, 0xe0, 0x00,  0x00, 0x00, 0xf0, 0x00,  0x00, 0x05, 0xe0, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0xc5, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // )
+    0x00, 0x00, 0x00, 0x00,  0xc5, 0x0d, 0x05, 0xc0,  0x5c, 0x2f, 0x2c, 0x50,  0x02, 0xdf, 0xd2, 0x00,  0x5c, 0x2f, 0x2c, 0x50,  0xc5, 0x0d, 0x05, 0xc0,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // 0x2A
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x0d, 0x00, 0x00,  0x00, 0x5f, 0x50, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x00, 0x5f, 0x50, 0x00,  0x00, 0x0d, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // +
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0xda, 0x00, 0x00,  0x00, 0x2e, 0x00, 0x00,  0x00, 0xc5, 0x00, 0x00,     // ,
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // -
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x0a, 0xa0, 0x00, 0x00,  0x0a, 0xa0, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // .
+    0x00, 0x00, 0x05, 0xc0,  0x00, 0x00, 0x5d, 0x50,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x05, 0xd5, 0x00, 0x00,  0x5d, 0x50, 0x00, 0x00,  0xc5, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // 0x2F
+    0x5e, 0xff, 0xfb, 0x30,  0xe5, 0x00, 0x1a, 0xb0,  0xf0, 0x05, 0xc1, 0xf0,  0xf0, 0x5d, 0x50, 0xf0,  0xf1, 0xc5, 0x00, 0xf0,  0xba, 0x10, 0x05, 0xe0,  0x3b, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // 0
+    0x00, 0x5d, 0x00, 0x00,  0x00, 0xdf, 0x00, 0x00,  0x00, 0x5f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0xdf, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // 1
+    0x5e, 0xff, 0xe5, 0x00,  0xc5, 0x00, 0x5e, 0x00,  0x00, 0x00, 0x5e, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0xe5, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xaf, 0xff, 0xfd, 0x00,  0x00, 0x00, 0x00, 0x00,     // 2
+    0xdf, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x05, 0xe0,  0x00, 0x00, 0x05, 0xe0,  0x0d, 0xff, 0xff, 0x20,  0x00, 0x00, 0x05, 0xe0,  0x00, 0x00, 0x05, 0xe0,  0xdf, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // 3
+    0x00, 0x05, 0xd0, 0x00,  0x00, 0x5e, 0xf0, 0x00,  0x05, 0xd2, 0xf0, 0x00,  0x5d, 0x50, 0xf0, 0x00,  0xe2, 0x05, 0xf5, 0x00,  0xaf, 0xff, 0xff, 0xd0,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x00, 0x00, 0x00,     // 4
+    0xaf, 0xff, 0xfd, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xaf, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x05, 0xe0,  0x00, 0x00, 0x05, 0xe0,  0xdf, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // 5
+    0x5e, 0xff, 0xfd, 0x00,  0xe5, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xff, 0xff, 0xfe, 0x50,  0xf5, 0x00, 0x05, 0xe0,  0xe5, 0x00, 0x05, 0xe0,  0x5e, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // 6
+    0xdf, 0xff, 0xff, 0xa0,  0x00, 0x00, 0x02, 0xe0,  0x00, 0x00, 0x5d, 0x50,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0xe5, 0x00, 0x00,  0x00, 0xd0, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // 7
+    0x5e, 0xff, 0xfe, 0x50,  0xe5, 0x00, 0x05, 0xe0,  0xe5, 0x00, 0x05, 0xe0,  0x2f, 0xff, 0xff, 0x20,  0xe5, 0x00, 0x05, 0xe0,  0xe5, 0x00, 0x05, 0xe0,  0x5e, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // 8
+    0x5e, 0xff, 0xfe, 0x50,  0xe5, 0x00, 0x05, 0xe0,  0xe5, 0x00, 0x05, 0xf0,  0x5e, 0xff, 0xff, 0xf0,  0x00, 0x00, 0x02, 0xe0,  0x00, 0x00, 0x5d, 0x50,  0x00, 0x00, 0xc5, 0x00,  0x00, 0x00, 0x00, 0x00,     // 9
+    0x00, 0x00, 0x00, 0x00,  0x00, 0xaa, 0x00, 0x00,  0x00, 0xaa, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0xaa, 0x00, 0x00,  0x00, 0xaa, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // :
+    0x00, 0x00, 0x00, 0x00,  0x00, 0xaa, 0x00, 0x00,  0x00, 0xaa, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0xda, 0x00, 0x00,  0x00, 0x2e, 0x00, 0x00,  0x00, 0xc5, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // ;
+    0x00, 0x05, 0xc0, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x05, 0xd5, 0x00, 0x00,  0x0d, 0x20, 0x00, 0x00,  0x05, 0xd5, 0x00, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x05, 0xc0, 0x00,  0x00, 0x00, 0x00, 0x00,     // <
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // =
+    0x00, 0xc5, 0x00, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x00, 0x2d, 0x00,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0xc5, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // >
+    0x5e, 0xff, 0xfe, 0x50,  0xc5, 0x00, 0x02, 0xd0,  0x00, 0x00, 0x5d, 0x50,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x0c, 0x50, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x0b, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // ?
+    0x5e, 0xff, 0xfe, 0x50,  0xe5, 0x00, 0x02, 0xe0,  0xf0, 0x5e, 0xff, 0xb0,  0xf0, 0xd2, 0x2e, 0x40,  0xf0, 0x5e, 0xe5, 0x00,  0xe5, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,     // @
+    0x00, 0x5d, 0x50, 0x00,  0x05, 0xd2, 0xd5, 0x00,  0x5d, 0x50, 0x5d, 0x50,  0xe2, 0x00, 0x02, 0xe0,  0xff, 0xff, 0xff, 0xf0,  0xf5, 0x00, 0x05, 0xf0,  0xd0, 0x00, 0x00, 0xd0,  0x00, 0x00, 0x00, 0x00,     // A
+    0xaf, 0xff, 0xfe, 0x50,  0xf5, 0x00, 0x05, 0xe0,  0xf5, 0x00, 0x05, 0xe0,  0xff, 0xff, 0xff, 0x20,  0xf5, 0x00, 0x05, 0xe0,  0xf5, 0x00, 0x05, 0xe0,  0xaf, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // B
+    0x5e, 0xff, 0xfe, 0x50,  0xe5, 0x00, 0x05, 0xc0,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xe5, 0x00, 0x05, 0xc0,  0x5e, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // C
+    0xaf, 0xff, 0xfe, 0x50,  0xf5, 0x00, 0x05, 0xe0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf5, 0x00, 0x05, 0xe0,  0xaf, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // D
+    0xaf, 0xff, 0xff, 0xd0,  0xf5, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xff, 0xff, 0xff, 0xd0,  0xf5, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xaf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,     // E
+    0xaf, 0xff, 0xff, 0xd0,  0xf5, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xff, 0xff, 0xd0, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // F
+    0xaf, 0xff, 0xff, 0xa0,  0xf5, 0x00, 0x05, 0xd0,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0xdf, 0xa0,  0xf5, 0x00, 0x02, 0xf0,  0xaf, 0xff, 0xff, 0xa0,  0x00, 0x00, 0x00, 0x00,     // G
+    0xd0, 0x00, 0x00, 0xd0,  0xf0, 0x00, 0x00, 0xf0,  0xf5, 0x00, 0x05, 0xf0,  0xff, 0xff, 0xff, 0xf0,  0xf5, 0x00, 0x05, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xd0, 0x00, 0x00, 0xd0,  0x00, 0x00, 0x00, 0x00,     // H
+    0x00, 0xdf, 0xd0, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0xdf, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // I
+    0x00, 0xdf, 0xd0, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0xc5, 0x5e, 0x00, 0x00,  0x5e, 0xe5, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // J
+    0x0d, 0x00, 0x05, 0xc0,  0x0f, 0x00, 0x5d, 0x50,  0x0f, 0x55, 0xd5, 0x00,  0x0f, 0xff, 0x20, 0x00,  0x0f, 0x55, 0xd5, 0x00,  0x0f, 0x00, 0x5d, 0x50,  0x0d, 0x00, 0x05, 0xc0,  0x00, 0x00, 0x00, 0x00,     // K
+    0xd0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xaf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,     // L
+    0xd5, 0x00, 0x05, 0xd0,  0xfe, 0x50, 0x5e, 0xf0,  0xf2, 0xd2, 0xd2, 0xf0,  0xf0, 0x5d, 0x50, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xd0, 0x00, 0x00, 0xd0,  0x00, 0x00, 0x00, 0x00,     // M
+    0xd5, 0x00, 0x00, 0xd0,  0xfe, 0x50, 0x00, 0xf0,  0xf2, 0xd5, 0x00, 0xf0,  0xf0, 0x5d, 0x50, 0xf0,  0xf0, 0x05, 0xd2, 0xf0,  0xf0, 0x00, 0x5e, 0xf0,  0xd0, 0x00, 0x05, 0xd0,  0x00, 0x00, 0x00, 0x00,     // N
+    0x5e, 0xff, 0xfe, 0x50,  0xe5, 0x00, 0x05, 0xe0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xe5, 0x00, 0x05, 0xe0,  0x5e, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // O
+    0xaf, 0xff, 0xfe, 0x50,  0xf5, 0x00, 0x05, 0xe0,  0xf5, 0x00, 0x05, 0xe0,  0xff, 0xff, 0xfe, 0x50,  0xf5, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // P
+    0x5e, 0xff, 0xfe, 0x50,  0xe5, 0x00, 0x05, 0xe0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x0c, 0x50, 0xf0,  0xf0, 0x05, 0xc1, 0xf0,  0xe5, 0x00, 0x1a, 0xf0,  0x5e, 0xff, 0xff, 0xa0,  0x00, 0x00, 0x00, 0x00,     // Q
+    0xaf, 0xff, 0xfe, 0x50,  0xf5, 0x00, 0x05, 0xe0,  0xf5, 0x00, 0x05, 0xe0,  0xff, 0xff, 0xfe, 0x50,  0xf5, 0x05, 0xe2, 0x00,  0xf0, 0x00, 0x5d, 0x50,  0xd0, 0x00, 0x05, 0xc0,  0x00, 0x00, 0x00, 0x00,     // R
+    0x5e, 0xff, 0xe5, 0x00,  0xe5, 0x00, 0x5c, 0x00,  0xe5, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x5e, 0x00,  0xc5, 0x00, 0x5e, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x00, 0x00,     // S
+    0xdf, 0xff, 0xff, 0xd0,  0x00, 0x5f, 0x50, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0d, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // T
+    0xd0, 0x00, 0x00, 0xd0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xe5, 0x00, 0x05, 0xe0,  0x5e, 0xff, 0xfe, 0x50,  0x00, 0x00, 0x00, 0x00,     // U
+    0xd0, 0x00, 0x00, 0xd0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xe5, 0x00, 0x05, 0xe0,  0x5d, 0x50, 0x5d, 0x50,  0x05, 0xd2, 0xd5, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x00, 0x00, 0x00,     // V
+    0xd0, 0x00, 0x00, 0xd0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x5d, 0x50, 0xf0,  0xf2, 0xd2, 0xd2, 0xf0,  0xfe, 0x50, 0x5e, 0xf0,  0xd5, 0x00, 0x05, 0xd0,  0x00, 0x00, 0x00, 0x00,     // W
+    0x0c, 0x50, 0x05, 0xc0,  0x05, 0xd6, 0x6d, 0x50,  0x00, 0x69, 0x96, 0x00,  0x00, 0x0f, 0xf0, 0x00,  0x00, 0x69, 0x96, 0x00,  0x05, 0xd6, 0x6d, 0x50,  0x0c, 0x50, 0x05, 0xc0,  0x00, 0x00, 0x00, 0x00,     // X
+    0xc5, 0x00, 0x05, 0xc0,  0x5d, 0x50, 0x5d, 0x50,  0x05, 0xd2, 0xd5, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0d, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // Y
+    0xdf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x2e, 0x50,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x05, 0xd5, 0x00, 0x00,  0x5e, 0x20, 0x00, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,     // Z
+    0x00, 0xaf, 0xfd, 0x00,  0x00, 0xf5, 0x00, 0x00,  0x00, 0xf0, 0x00, 0x00,  0x00, 0xf0, 0x00, 0x00,  0x00, 0xf0, 0x00, 0x00,  0x00, 0xf5, 0x00, 0x00,  0x00, 0xaf, 0xfd, 0x00,  0x00, 0x00, 0x00, 0x00,     // [
+    0xc5, 0x00, 0x00, 0x00,  0x5d, 0x50, 0x00, 0x00,  0x05, 0xd5, 0x00, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x05, 0xd5, 0x00,  0x00, 0x00, 0x5d, 0x50,  0x00, 0x00, 0x05, 0xc0,  0x00, 0x00, 0x00, 0x00,     // 0x5C
+    0x00, 0xdf, 0xfa, 0x00,  0x00, 0x00, 0x5f, 0x00,  0x00, 0x00, 0x0f, 0x00,  0x00, 0x00, 0x0f, 0x00,  0x00, 0x00, 0x0f, 0x00,  0x00, 0x00, 0x5f, 0x00,  0x00, 0xdf, 0xfa, 0x00,  0x00, 0x00, 0x00, 0x00,     // ]
+    0x00, 0x5d, 0x50, 0x00,  0x05, 0xd2, 0xd5, 0x00,  0x0c, 0x50, 0x5c, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // ^
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xdf, 0xff, 0xff, 0xd0,  0x00, 0x00, 0x00, 0x00,     // _
+    0x00, 0xc5, 0x00, 0x00,  0x00, 0x5d, 0x50, 0x00,  0x00, 0x05, 0xc0, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // `
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x0d, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x2e, 0x00,  0x5e, 0xff, 0xff, 0x00,  0xd2, 0x00, 0x2f, 0x00,  0x5e, 0xff, 0xfa, 0x00,  0x00, 0x00, 0x00, 0x00,     // a
+    0xd0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf2, 0xef, 0xe5, 0x00,  0xfe, 0x50, 0x5e, 0x00,  0xf2, 0x00, 0x0f, 0x00,  0xfe, 0x50, 0x5e, 0x00,  0xd2, 0xef, 0xe5, 0x00,  0x00, 0x00, 0x00, 0x00,     // b
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0xe5, 0x00, 0x5c, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xe5, 0x00, 0x5c, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x00, 0x00,     // c
+    0x00, 0x00, 0x0d, 0x00,  0x00, 0x00, 0x0f, 0x00,  0x5e, 0xfe, 0x2f, 0x00,  0xe5, 0x05, 0xef, 0x00,  0xf0, 0x00, 0x2f, 0x00,  0xe5, 0x05, 0xef, 0x00,  0x5e, 0xfe, 0x2d, 0x00,  0x00, 0x00, 0x00, 0x00,     // d
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0xe2, 0x00, 0x2e, 0x00,  0xff, 0xff, 0xfa, 0x00,  0xe2, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // e
+    0x00, 0x5e, 0xe5, 0x00,  0x00, 0xe5, 0x5c, 0x00,  0x05, 0xf5, 0x00, 0x00,  0x0d, 0xff, 0xd0, 0x00,  0x05, 0xf5, 0x00, 0x00,  0x00, 0xf0, 0x00, 0x00,  0x00, 0xd0, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // f
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xfa, 0x00,  0xe5, 0x00, 0x5f, 0x00,  0xe5, 0x00, 0x5f, 0x00,  0x5e, 0xff, 0xff, 0x00,  0x00, 0x00, 0x2e, 0x00,  0x0d, 0xff, 0xe5, 0x00,     // g
+    0xd0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf2, 0xef, 0xe5, 0x00,  0xfe, 0x50, 0x5e, 0x00,  0xf5, 0x00, 0x0f, 0x00,  0xf0, 0x00, 0x0f, 0x00,  0xd0, 0x00, 0x0d, 0x00,  0x00, 0x00, 0x00, 0x00,     // h
+    0x00, 0x0b, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0xda, 0x00, 0x00,  0x00, 0x5f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0xdf, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // i
+    0x00, 0x00, 0xb0, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x0d, 0xa0, 0x00,  0x00, 0x05, 0xf0, 0x00,  0x00, 0x00, 0xf0, 0x00,  0x00, 0x00, 0xf0, 0x00,  0xc5, 0x05, 0xe0, 0x00,  0x5e, 0xfe, 0x50, 0x00,     // j
+    0xd0, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xf0, 0x05, 0xc0, 0x00,  0xf5, 0x5d, 0x50, 0x00,  0xff, 0xf2, 0x00, 0x00,  0xf5, 0x5d, 0x50, 0x00,  0xd0, 0x05, 0xc0, 0x00,  0x00, 0x00, 0x00, 0x00,     // k
+    0x00, 0xda, 0x00, 0x00,  0x00, 0x5f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x5f, 0x50, 0x00,  0x00, 0xdf, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // l
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xad, 0x2d, 0xa0, 0x00,  0xf2, 0xd2, 0xf0, 0x00,  0xf0, 0xf0, 0xf0, 0x00,  0xf0, 0xf0, 0xf0, 0x00,  0xd0, 0xd0, 0xd0, 0x00,  0x00, 0x00, 0x00, 0x00,     // m
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd2, 0xef, 0xe5, 0x00,  0xfe, 0x50, 0x5e, 0x00,  0xf5, 0x00, 0x0f, 0x00,  0xf0, 0x00, 0x0f, 0x00,  0xd0, 0x00, 0x0d, 0x00,  0x00, 0x00, 0x00, 0x00,     // n
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0xe5, 0x00, 0x5e, 0x00,  0xf0, 0x00, 0x0f, 0x00,  0xe5, 0x00, 0x5e, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x00, 0x00,     // o
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd2, 0xef, 0xe5, 0x00,  0xfe, 0x50, 0x5e, 0x00,  0xf2, 0x00, 0x5e, 0x00,  0xff, 0xff, 0xe5, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x00, 0x00,     // p
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xfe, 0x2d, 0x00,  0xe5, 0x05, 0xef, 0x00,  0xe5, 0x00, 0x2f, 0x00,  0x5e, 0xff, 0xff, 0x00,  0x00, 0x00, 0x5f, 0x00,  0x00, 0x00, 0x0d, 0x00,     // q
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd2, 0xef, 0xe5, 0x00,  0xfe, 0x50, 0x5c, 0x00,  0xf5, 0x00, 0x00, 0x00,  0xf0, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // r
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xfd, 0x00,  0xd2, 0x00, 0x00, 0x00,  0x5e, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x2d, 0x00,  0xdf, 0xff, 0xe5, 0x00,  0x00, 0x00, 0x00, 0x00,     // s
+    0x00, 0xd0, 0x00, 0x00,  0x05, 0xf5, 0x00, 0x00,  0xdf, 0xff, 0xd0, 0x00,  0x05, 0xf5, 0x00, 0x00,  0x00, 0xf0, 0x00, 0x00,  0x00, 0xe5, 0x5c, 0x00,  0x00, 0x5e, 0xe5, 0x00,  0x00, 0x00, 0x00, 0x00,     // t
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x0d, 0x00,  0xf0, 0x00, 0x0f, 0x00,  0xf0, 0x00, 0x5f, 0x00,  0xe5, 0x05, 0xef, 0x00,  0x5e, 0xfe, 0x2d, 0x00,  0x00, 0x00, 0x00, 0x00,     // u
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x0d, 0x00,  0xf0, 0x00, 0x0f, 0x00,  0xe5, 0x00, 0x5e, 0x00,  0x5d, 0x55, 0xd5, 0x00,  0x05, 0xee, 0x50, 0x00,  0x00, 0x00, 0x00, 0x00,     // v
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x00, 0xd0,  0xf0, 0x00, 0x00, 0xf0,  0xf0, 0x5d, 0x50, 0xf0,  0xe2, 0xd2, 0xd2, 0xe0,  0x5d, 0x50, 0x5d, 0x50,  0x00, 0x00, 0x00, 0x00,     // w
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xc5, 0x00, 0x5c, 0x00,  0x5d, 0x55, 0xd5, 0x00,  0x02, 0xff, 0x20, 0x00,  0x5d, 0x55, 0xd5, 0x00,  0xc5, 0x00, 0x5c, 0x00,  0x00, 0x00, 0x00, 0x00,     // x
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xd0, 0x00, 0x0d, 0x00,  0xf0, 0x00, 0x0f, 0x00,  0xe5, 0x00, 0x5f, 0x00,  0x5e, 0xff, 0xff, 0x00,  0x00, 0x00, 0x2e, 0x00,  0x0d, 0xff, 0xe5, 0x00,     // y
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0xdf, 0xff, 0xfd, 0x00,  0x00, 0x02, 0xe5, 0x00,  0x05, 0xee, 0x50, 0x00,  0x5e, 0x20, 0x00, 0x00,  0xdf, 0xff, 0xfd, 0x00,  0x00, 0x00, 0x00, 0x00,     // z
+    0x00, 0x05, 0xed, 0x00,  0x00, 0x0e, 0x50, 0x00,  0x00, 0x5e, 0x00, 0x00,  0x0d, 0xf2, 0x00, 0x00,  0x00, 0x5e, 0x00, 0x00,  0x00, 0x0e, 0x50, 0x00,  0x00, 0x05, 0xed, 0x00,  0x00, 0x00, 0x00, 0x00,     // {
+    0x00, 0x0d, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0f, 0x00, 0x00,  0x00, 0x0d, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // |
+    0x0d, 0xe5, 0x00, 0x00,  0x00, 0x5e, 0x00, 0x00,  0x00, 0x0e, 0x50, 0x00,  0x00, 0x02, 0xfd, 0x00,  0x00, 0x0e, 0x50, 0x00,  0x00, 0x5e, 0x00, 0x00,  0x0d, 0xe5, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // }
+    0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x5e, 0xe5, 0x00, 0xd0,  0xe5, 0x5d, 0x55, 0xe0,  0xd0, 0x05, 0xee, 0x50,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,  0x00, 0x00, 0x00, 0x00,     // ~
+};
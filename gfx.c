@@ -0,0 +1,621 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1331.h"
+#include "gfx.h"
+#include "glyph.h"
+#include "perf.h"
+
+// ラインの変更領域はこのピクセル数ごとの区間の外接矩形として登録する。
+// 斜めのラインを1つの外接矩形にすると画面全体になってしまうため。
+// ラインの外接矩形が変更済みなら区間に分けずに登録を省く (draw_line())
+#define LINE_DAMAGE_SEG     8
+
+static inline void mark(struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    if (fb->damage)
+        damage_add(fb->damage, x0, y0, x1, y1);
+}
+
+// 描画できる範囲: 画面とバンドの行の共通部分
+static inline int clip_top(struct framebuffer *fb) {
+    return MAX(0, fb->y0);
+}
+
+static inline int clip_bottom(struct framebuffer *fb) {
+    return MIN(SSD1331_HEIGHT, fb->y0 + fb->height) - 1;
+}
+
+static inline bool visible(struct framebuffer *fb, int x, int y) {
+    return (unsigned)x < SSD1331_WIDTH && y >= clip_top(fb) && y <= clip_bottom(fb);
+}
+
+// 形式に合わせて1ピクセルを書き込む。範囲は確かめない
+static inline void put(struct framebuffer *fb, int x, int y, uint16_t color) {
+    if (fb->format == FB_RGB565)
+        fb_row(fb, y)[x] = color;
+    else
+        fb_put_index(fb, x, y, color);
+}
+
+static inline void put_pixel(struct framebuffer *fb, int x, int y, uint16_t color) {
+    if (visible(fb, x, y))
+        put(fb, x, y, color);
+}
+
+// n個のピクセルを塗る: 4バイト境界に揃えてから2ピクセルずつ32bitで書き込む
+static inline void hspan(uint16_t *p, int n, uint16_t color) {
+    if (n > 0 && ((uintptr_t)p & 2)) {
+        *p++ = color;
+        n--;
+    }
+
+    pix2_t c2 = color | (uint32_t)color << 16;
+    pix2_t *q = (pix2_t *)p;
+    for (; n >= 2; n -= 2)
+        *q++ = c2;
+    if (n)
+        *(uint16_t *)q = color;
+}
+
+// 4bppの行pのx列目からn個の番号を塗る: 端の半端なニブル以外は1バイトずつ書く
+static void hspan4(uint8_t *p, int x, int n, uint8_t index) {
+    index &= 0x0f;
+    p += x >> 1;
+    if (n > 0 && (x & 1)) {
+        *p = (*p & 0xf0) | index;
+        p++;
+        n--;
+    }
+    memset(p, index * 0x11, n >> 1);
+    if (n & 1) {
+        p += n >> 1;
+        *p = (*p & 0x0f) | index << 4;
+    }
+}
+
+// y行目のx列目からn個のピクセルを塗る
+static inline void span(struct framebuffer *fb, int x, int y, int n, uint16_t color) {
+    switch (fb->format) {
+    case FB_RGB565:
+        hspan(fb_row(fb, y) + x, n, color);
+        break;
+    case FB_INDEX4:
+        hspan4(fb_irow(fb, y), x, n, color);
+        break;
+    default:
+        memset(fb_irow(fb, y) + x, color, n);
+        break;
+    }
+}
+
+void fb_init(struct framebuffer *fb, uint16_t *buf, struct damage *damage) {
+    fb->buf = buf;
+    fb->y0 = 0;
+    fb->height = SSD1331_HEIGHT;
+    fb->format = FB_RGB565;
+    fb->palette = NULL;
+    fb->damage = damage;
+    if (damage)
+        damage_init(damage);
+}
+
+void fb_init_band(struct framebuffer *fb, uint16_t *buf, int y0, int height) {
+    fb->buf = buf;
+    fb->y0 = y0;
+    fb->height = height;
+    fb->format = FB_RGB565;
+    fb->palette = NULL;
+    fb->damage = NULL;
+}
+
+void fb_init_indexed(struct framebuffer *fb, uint8_t *buf, fb_format_t format, const uint16_t *palette, struct damage *damage) {
+    assert(format == FB_INDEX8 || format == FB_INDEX4);
+    fb->ibuf = buf;
+    fb->y0 = 0;
+    fb->height = SSD1331_HEIGHT;
+    fb->format = format;
+    fb->palette = palette;
+    fb->damage = damage;
+    if (damage)
+        damage_init(damage);
+}
+
+void fb_init_rgb332(struct framebuffer *fb, uint8_t *buf, struct damage *damage) {
+    fb->ibuf = buf;
+    fb->y0 = 0;
+    fb->height = SSD1331_HEIGHT;
+    fb->format = FB_RGB332;
+    fb->palette = NULL;
+    fb->damage = damage;
+    if (damage)
+        damage_init(damage);
+}
+
+void fb_set_palette(struct framebuffer *fb, const uint16_t *palette) {
+    assert(fb->format == FB_INDEX8 || fb->format == FB_INDEX4);
+    fb->palette = palette;
+    if (fb->damage)
+        damage_add_all(fb->damage);
+}
+
+void fb_expand_row(const struct framebuffer *fb, int x, int y, int n, uint16_t *dst) {
+    const uint16_t *pal = fb->palette;
+    const uint8_t *s = fb_irow(fb, y);
+
+    if (fb->format == FB_RGB332) {
+        s += x;
+        while (n--)
+            *dst++ = rgb332_to_565(*s++);
+        return;
+    }
+
+    if (fb->format == FB_INDEX8) {
+        s += x;
+        for (; n >= 4; n -= 4, s += 4, dst += 4) {
+            dst[0] = pal[s[0]];
+            dst[1] = pal[s[1]];
+            dst[2] = pal[s[2]];
+            dst[3] = pal[s[3]];
+        }
+        while (n--)
+            *dst++ = pal[*s++];
+        return;
+    }
+
+    // 4bpp: 1バイトで2ピクセル。奇数列から始まるときは下位ニブルから
+    s += x >> 1;
+    if (n > 0 && (x & 1)) {
+        *dst++ = pal[*s++ & 0x0f];
+        n--;
+    }
+    for (; n >= 2; n -= 2, s++, dst += 2) {
+        dst[0] = pal[*s >> 4];
+        dst[1] = pal[*s & 0x0f];
+    }
+    if (n)
+        *dst = pal[*s >> 4];
+}
+
+void fb_expand_col(const struct framebuffer *fb, int x, int y, int n, uint16_t *dst) {
+    if (fb->format == FB_RGB565) {
+        const uint16_t *s = fb->buf + (y - fb->y0) * SSD1331_WIDTH + x;
+        for (; n > 0; n--, s += SSD1331_WIDTH)
+            *dst++ = *s;
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint8_t v = fb_get_index(fb, x, y + i);
+        dst[i] = fb->format == FB_RGB332 ? rgb332_to_565(v) : fb->palette[v];
+    }
+}
+
+void fb_clear(struct framebuffer *fb, uint16_t color) {
+    PERF_SCOPE(PERF_FILL);
+    if (fb->format == FB_RGB565) {
+        for (int i = 0; i < fb->height * SSD1331_WIDTH; i++)
+            fb->buf[i] = color;
+    } else {
+        memset(fb->ibuf, fb->format != FB_INDEX4 ? color : (color & 0x0f) * 0x11, fb->height * FB_STRIDE(fb->format));
+    }
+    if (fb->damage)
+        damage_add_all(fb->damage);
+}
+
+void set_pixel(struct framebuffer *fb, int x, int y, uint16_t color) {
+    PERF_SCOPE(PERF_PIXEL);
+    if (!visible(fb, x, y))
+        return;
+
+    put(fb, x, y, color);
+    mark(fb, x, y, x, y);
+}
+
+void draw_hline(struct framebuffer *fb, int x0, int x1, int y, uint16_t color) {
+    PERF_SCOPE(PERF_LINE);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    x0 = MAX(x0, 0);
+    x1 = MIN(x1, SSD1331_WIDTH - 1);
+    if (x0 > x1 || y < clip_top(fb) || y > clip_bottom(fb))
+        return;
+
+    span(fb, x0, y, x1 - x0 + 1, color);
+    mark(fb, x0, y, x1, y);
+}
+
+void draw_vline(struct framebuffer *fb, int x, int y0, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_LINE);
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    y0 = MAX(y0, clip_top(fb));
+    y1 = MIN(y1, clip_bottom(fb));
+    if (y0 > y1 || (unsigned)x >= SSD1331_WIDTH)
+        return;
+
+    if (fb->format == FB_RGB565) {
+        uint16_t *p = fb_row(fb, y0) + x;
+        for (int y = y0; y <= y1; y++, p += SSD1331_WIDTH)
+            *p = color;
+    } else {
+        for (int y = y0; y <= y1; y++)
+            fb_put_index(fb, x, y, color);
+    }
+    mark(fb, x, y0, x, y1);
+}
+
+// Cohen-Sutherlandの領域コード
+#define OUT_LEFT    1
+#define OUT_RIGHT   2
+#define OUT_TOP     4
+#define OUT_BOTTOM  8
+
+static inline int outcode(int x, int y, int w, int h) {
+    int code = 0;
+
+    if (x < 0)
+        code |= OUT_LEFT;
+    else if (x > w - 1)
+        code |= OUT_RIGHT;
+    if (y < 0)
+        code |= OUT_TOP;
+    else if (y > h - 1)
+        code |= OUT_BOTTOM;
+    return code;
+}
+
+bool clip_line(int *x0, int *y0, int *x1, int *y1, int w, int h) {
+    int c0 = outcode(*x0, *y0, w, h);
+    int c1 = outcode(*x1, *y1, w, h);
+
+    while (true) {
+        if (!(c0 | c1))
+            return true;
+        if (c0 & c1)
+            return false;
+
+        int c = c0 ? c0 : c1;
+        int dx = *x1 - *x0;
+        int dy = *y1 - *y0;
+        int x, y;
+
+        if (c & OUT_TOP) {
+            y = 0;
+            x = *x0 + dx * (y - *y0) / dy;
+        } else if (c & OUT_BOTTOM) {
+            y = h - 1;
+            x = *x0 + dx * (y - *y0) / dy;
+        } else if (c & OUT_LEFT) {
+            x = 0;
+            y = *y0 + dy * (x - *x0) / dx;
+        } else {
+            x = w - 1;
+            y = *y0 + dy * (x - *x0) / dx;
+        }
+
+        if (c == c0) {
+            *x0 = x;
+            *y0 = y;
+            c0 = outcode(x, y, w, h);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            c1 = outcode(x, y, w, h);
+        }
+    }
+}
+
+void draw_line(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_LINE);
+    // バンドの行で切り取ると始点が変わって全画面に描いたときと違う点を通るので、
+    // 画面だけで切り取り、バンドの外の行は描かずに進める
+    if (!clip_line(&x0, &y0, &x1, &y1, SSD1331_WIDTH, SSD1331_HEIGHT))
+        return;
+
+    // 水平線と垂直線は専用の処理で描く
+    if (y0 == y1) {
+        draw_hline(fb, x0, x1, y0, color);
+        return;
+    }
+    if (x0 == x1) {
+        draw_vline(fb, x0, y0, y1, color);
+        return;
+    }
+
+    int dx =  abs(x1 - x0);
+    int sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1-y0);
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    int e2;
+    int seg_x = x0, seg_y = y0, n = 0;
+    int seg = LINE_DAMAGE_SEG;
+    int top = clip_top(fb);
+    int bottom = clip_bottom(fb);
+    // 切り取り済みなのでx方向の範囲の確認はせずに、バッファ内の位置を進める
+    int pos = (y0 - fb->y0) * SSD1331_WIDTH + x0;
+    int step_y = sy * SSD1331_WIDTH;
+
+    // 区間ごとのdamage_add()の併合の探索はピクセルを書くより重い。外接矩形が
+    // 1つの変更済みの矩形に含まれていれば (全画面の描き直しの途中など) 1回の確認で済ませ、
+    // 区間に分けない (segが0ならnは区間の長さに達しない)
+    if (!fb->damage || damage_covers(fb->damage, MIN(x0, x1), MIN(y0, y1), MAX(x0, x1), MAX(y0, y1)))
+        seg = 0;
+
+    while (true) {
+        if (y0 >= top && y0 <= bottom) {
+            if (fb->format == FB_RGB565)
+                fb->buf[pos] = color;
+            else
+                fb_put_index(fb, x0, y0, color);
+        } else if (sy > 0 ? y0 > bottom : y0 < top)
+            break;
+        if (++n == seg) {
+            mark(fb, seg_x, seg_y, x0, y0);
+            seg_x = x0;
+            seg_y = y0;
+            n = 0;
+        }
+        if (x0 == x1 && y0 == y1)
+            break;
+        e2 = 2 * err;
+
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+            pos += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+            pos += step_y;
+        }
+    }
+    if (seg && n > 0)
+        mark(fb, seg_x, seg_y, x0, y0);
+}
+
+void fill_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_FILL);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    x0 = MAX(x0, 0);
+    x1 = MIN(x1, SSD1331_WIDTH - 1);
+    y0 = MAX(y0, clip_top(fb));
+    y1 = MIN(y1, clip_bottom(fb));
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    for (int y = y0; y <= y1; y++)
+        span(fb, x0, y, x1 - x0 + 1, color);
+    mark(fb, x0, y0, x1, y1);
+}
+
+void draw_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color) {
+    PERF_SCOPE(PERF_RECT);
+    draw_hline(fb, x0, x1, y0, color);
+    draw_hline(fb, x0, x1, y1, color);
+    draw_vline(fb, x0, y0, y1, color);
+    draw_vline(fb, x1, y0, y1, color);
+}
+
+void draw_circle(struct framebuffer *fb, int cx, int cy, int r, uint16_t color) {
+    PERF_SCOPE(PERF_CIRCLE);
+    int x = r, y = 0;
+    int err = 1 - r;
+
+    if (r < 0)
+        return;
+
+    // 中点アルゴリズムで1/8円を求め、対称な8点を描く
+    while (x >= y) {
+        put_pixel(fb, cx + x, cy + y, color);
+        put_pixel(fb, cx - x, cy + y, color);
+        put_pixel(fb, cx + x, cy - y, color);
+        put_pixel(fb, cx - x, cy - y, color);
+        put_pixel(fb, cx + y, cy + x, color);
+        put_pixel(fb, cx - y, cy + x, color);
+        put_pixel(fb, cx + y, cy - x, color);
+        put_pixel(fb, cx - y, cy - x, color);
+
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+    mark(fb, cx - r, cy - r, cx + r, cy + r);
+}
+
+void fill_circle(struct framebuffer *fb, int cx, int cy, int r, uint16_t color) {
+    PERF_SCOPE(PERF_CIRCLE);
+    int x = r, y = 0;
+    int err = 1 - r;
+
+    if (r < 0)
+        return;
+
+    // 1/8円の各点について上下対称の水平スパンを塗る
+    struct damage *d = fb->damage;
+    fb->damage = NULL;
+    while (x >= y) {
+        draw_hline(fb, cx - x, cx + x, cy + y, color);
+        draw_hline(fb, cx - x, cx + x, cy - y, color);
+        if (err >= 0) {
+            // xが変わる直前の行だけ外側のスパンを塗る (同じ行を何度も塗らない)
+            draw_hline(fb, cx - y, cx + y, cy + x, color);
+            draw_hline(fb, cx - y, cx + y, cy - x, color);
+        }
+
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+    fb->damage = d;
+    mark(fb, cx - r, cy - r, cx + r, cy + r);
+}
+
+void draw_triangle(struct framebuffer *fb, int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color) {
+    PERF_SCOPE(PERF_TRIANGLE);
+    draw_line(fb, x0, y0, x1, y1, color);
+    draw_line(fb, x1, y1, x2, y2, color);
+    draw_line(fb, x2, y2, x0, y0, color);
+}
+
+void fill_triangle(struct framebuffer *fb, int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color) {
+    PERF_SCOPE(PERF_TRIANGLE);
+    int t;
+
+    // y0 <= y1 <= y2 に並べる
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+    if (y1 > y2) { t = y1; y1 = y2; y2 = t; t = x1; x1 = x2; x2 = t; }
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+
+    if (y0 == y2) {
+        draw_hline(fb, MIN(x0, MIN(x1, x2)), MAX(x0, MAX(x1, x2)), y0, color);
+        return;
+    }
+
+    struct damage *d = fb->damage;
+    fb->damage = NULL;
+
+    // 各行で長辺 (0-2) と短辺 (0-1 または 1-2) の間を塗る。描画範囲外の行は飛ばす
+    int top = MAX(y0, clip_top(fb));
+    int bottom = MIN(y2, clip_bottom(fb));
+    for (int y = top; y <= bottom; y++) {
+        int xa = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
+        int xb;
+        if (y < y1 || y1 == y2)
+            xb = y1 == y0 ? x1 : x0 + (x1 - x0) * (y - y0) / (y1 - y0);
+        else
+            xb = x1 + (x2 - x1) * (y - y1) / (y2 - y1);
+        draw_hline(fb, xa, xb, y, color);
+    }
+
+    fb->damage = d;
+    mark(fb, MIN(x0, MIN(x1, x2)), y0, MAX(x0, MAX(x1, x2)), y2);
+}
+
+// 転送元の矩形を転送先の範囲 [0, max_x] x [top, bottom] に切り取る。見えなければfalseを返す
+static bool clip_blit(int *x, int *y, int *sx, int *sy, int *w, int *h, int max_x, int top, int bottom) {
+    if (*x < 0) {
+        *sx -= *x;
+        *w += *x;
+        *x = 0;
+    }
+    if (*y < top) {
+        *sy += top - *y;
+        *h -= top - *y;
+        *y = top;
+    }
+    *w = MIN(*w, max_x - *x + 1);
+    *h = MIN(*h, bottom - *y + 1);
+    return *w > 0 && *h > 0;
+}
+
+void copy_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, int dx, int dy) {
+    PERF_SCOPE(PERF_BLIT);
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    int w = x1 - x0 + 1;
+    int h = y1 - y0 + 1;
+    int top = clip_top(fb), bottom = clip_bottom(fb);
+
+    // 転送先と転送元の両方を画面とバンドの範囲に切り取る。
+    // バンドでは転送元の行がバッファにない部分は描けない
+    if (!clip_blit(&dx, &dy, &x0, &y0, &w, &h, SSD1331_WIDTH - 1, top, bottom)
+        || !clip_blit(&x0, &y0, &dx, &dy, &w, &h, SSD1331_WIDTH - 1, top, bottom))
+        return;
+
+    // 下へコピーするときは下の行から処理して未コピーの行を上書きしないようにする
+    for (int i = 0; i < h; i++) {
+        int row = dy > y0 ? h - 1 - i : i;
+
+        if (fb->format == FB_RGB565) {
+            memmove(fb_row(fb, dy + row) + dx, fb_row(fb, y0 + row) + x0, 2 * w);
+        } else if (fb->format != FB_INDEX4) {
+            memmove(fb_irow(fb, dy + row) + dx, fb_irow(fb, y0 + row) + x0, w);
+        } else {
+            // 4bppはニブルの位置がずれることがあるので1ピクセルずつ。
+            // 同じ行で右へコピーするときは右から処理する
+            bool rtl = dy == y0 && dx > x0;
+            for (int j = 0; j < w; j++) {
+                int col = rtl ? w - 1 - j : j;
+                fb_put_index(fb, dx + col, dy + row, fb_get_index(fb, x0 + col, y0 + row));
+            }
+        }
+    }
+    mark(fb, dx, dy, dx + w - 1, dy + h - 1);
+}
+
+bool fb_clip_blit(struct framebuffer *fb, int *x, int *y, int *sx, int *sy, int *w, int *h) {
+    return clip_blit(x, y, sx, sy, w, h, SSD1331_WIDTH - 1, clip_top(fb), clip_bottom(fb));
+}
+
+bool render_clip_blit(struct ssd1331 *dev, int *x, int *y, int *sx, int *sy, int *w, int *h) {
+    return clip_blit(x, y, sx, sy, w, h, ssd1331_width(dev) - 1, 0, ssd1331_height(dev) - 1);
+}
+
+void blit(struct framebuffer *fb, int x, int y, const uint16_t *src, int stride, int sx, int sy, int w, int h) {
+    PERF_SCOPE(PERF_BLIT);
+    assert(fb->format == FB_RGB565);
+    if (!clip_blit(&x, &y, &sx, &sy, &w, &h, SSD1331_WIDTH - 1, clip_top(fb), clip_bottom(fb)))
+        return;
+
+    const uint16_t *s = src + sy * stride + sx;
+    uint16_t *d = fb_row(fb, y) + x;
+
+    // 転送元も転送先も行の間に隙間がなければ1回でコピーする
+    if (stride == w && w == SSD1331_WIDTH)
+        memcpy(d, s, 2 * w * h);
+    else
+        for (int i = 0; i < h; i++, s += stride, d += SSD1331_WIDTH)
+            memcpy(d, s, 2 * w);
+    mark(fb, x, y, x + w - 1, y + h - 1);
+}
+
+void render_blit(struct ssd1331 *dev, int x, int y, const uint16_t *src, int stride, int sx, int sy, int w, int h) {
+    PERF_SCOPE(PERF_BLIT);
+    if (!render_clip_blit(dev, &x, &y, &sx, &sy, &w, &h))
+        return;
+
+    const uint16_t *s = src + sy * stride + sx;
+    struct render_area area = {
+        start_col : x,
+        end_col : x + w - 1,
+        start_row : y,
+        end_row : y + h - 1
+    };
+
+    // 転送元から直接SPIへ書き出す。フラッシュ上のconstデータでもRAMに写さない。
+    // 行の幅がstrideと同じなら矩形全体を1回で書き出す
+    render_begin(dev, &area);
+    if (stride == w)
+        render_write(dev, s, w * h);
+    else
+        for (int i = 0; i < h; i++, s += stride)
+            render_write(dev, s, w);
+    render_end(dev);
+}
+
+void draw_image(struct framebuffer *fb, int x, int y, int width, int height, const uint16_t *img) {
+    PERF_SCOPE(PERF_BLIT);
+    blit(fb, x, y, img, width, 0, 0, width, height);
+}
+
+void write_char(struct framebuffer *fb, int x, int y, uint8_t ch, uint16_t color) {
+    draw_char(fb, x, y, ch, color, COL_BLACK, TEXT_OPAQUE);
+}
+
+void write_string(struct framebuffer *fb, int x, int y, const char *str, uint16_t color) {
+    draw_text(fb, x, y, str, color, COL_BLACK, TEXT_OPAQUE);
+}
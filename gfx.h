@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef GFX_H
+#define GFX_H
+
+#include <stdint.h>
+#include "ssd1331.h"
+#include "damage.h"
+
+/* フレームバッファへの描画関数
+
+   描画関数は変更した領域をフレームバッファに付けられたdamageに登録する。
+   画面の外にはみ出した部分は切り取られる。
+   バンド (画面の一部の行だけを持つバッファ) にも描画でき、その場合は
+   バンドの範囲外の行は描かれない。
+
+   ピクセルの形式はRGB565のほかに次のものがあり、描画関数のcolorはその形式の値になる。
+   どれもRGB565の画像や色を扱うblit(), draw_image(), draw_qimage()と
+   アクセラレータは使えない。
+
+   * RGB332 (8bpp): パネルの256色モードでそのまま1ピクセル1バイトで送る。
+     転送量がRGB565の半分になる
+   * パレットの番号 (8bppで256色、4bppで16色): render_dirty()が送るときに
+     パレットでRGB565に展開する。バッファはRGB565の12KBに対して6KBまたは3KBになり、
+     パレットを差し替えれば描き直さずに画面全体の色を変えられる
+*/
+
+// 2ピクセルをまとめて書き込むための型 (uint16_tのバッファを32bitでアクセスする)
+typedef uint32_t __attribute__((may_alias)) pix2_t;
+
+// ピクセルの形式
+typedef enum fb_format {
+    FB_RGB565,      // 16bpp
+    FB_RGB332,      // 8bpp: パネルの256色モードの色
+    FB_INDEX8,      // 8bpp: 256色のパレットの番号
+    FB_INDEX4       // 4bpp: 16色のパレットの番号 (上位ニブルが左のピクセル)
+} fb_format_t;
+
+// 形式ごとの1ピクセルのビット数、1行と全画面のバイト数
+#define FB_BPP(format)      ((format) == FB_RGB565 ? 16 : (format) == FB_INDEX4 ? 4 : 8)
+#define FB_STRIDE(format)   (SSD1331_WIDTH * FB_BPP(format) / 8)
+#define FB_BYTES(format)    (FB_STRIDE(format) * SSD1331_HEIGHT)
+
+struct framebuffer {
+    union {
+        uint16_t *buf;      // height行分のRGB565ピクセル (1行はSSD1331_WIDTH個)
+        uint8_t *ibuf;      // 8/4bppの形式のピクセル
+    };
+    int16_t y0;             // buf[0]の画面上の行
+    uint8_t height;         // bufが持つ行数
+    uint8_t format;         // fb_format_t
+    const uint16_t *palette;  // FB_INDEX8/4で番号からRGB565への表 (256色または16色)
+    struct damage *damage;  // NULLの場合は変更領域を追跡しない
+};
+
+// 画面のy行目のバッファ内の先頭
+static inline uint16_t *fb_row(struct framebuffer *fb, int y) {
+    return fb->buf + (y - fb->y0) * SSD1331_WIDTH;
+}
+
+// 8/4bppで画面のy行目のバッファ内の先頭
+static inline uint8_t *fb_irow(const struct framebuffer *fb, int y) {
+    return fb->ibuf + (y - fb->y0) * FB_STRIDE(fb->format);
+}
+
+// 8/4bppの (x,y) に値 (パレットの番号またはRGB332の色) を書き込む。範囲は確かめない
+static inline void fb_put_index(struct framebuffer *fb, int x, int y, uint8_t index) {
+    uint8_t *p = fb_irow(fb, y);
+
+    if (fb->format != FB_INDEX4) {
+        p[x] = index;
+    } else {
+        p += x >> 1;
+        *p = x & 1 ? (*p & 0xf0) | (index & 0x0f) : (*p & 0x0f) | index << 4;
+    }
+}
+
+static inline uint8_t fb_get_index(const struct framebuffer *fb, int x, int y) {
+    const uint8_t *p = fb_irow(fb, y);
+
+    if (fb->format != FB_INDEX4)
+        return p[x];
+    return x & 1 ? p[x >> 1] & 0x0f : p[x >> 1] >> 4;
+}
+
+// 画面のy行目をバッファが持っているか
+static inline bool fb_has_row(struct framebuffer *fb, int y) {
+    return (unsigned)(y - fb->y0) < fb->height;
+}
+
+void fb_init(struct framebuffer *fb, uint16_t *buf, struct damage *damage);
+// 画面のy0行目からheight行分のバンドとして初期化する
+void fb_init_band(struct framebuffer *fb, uint16_t *buf, int y0, int height);
+// FB_INDEX8またはFB_INDEX4の全画面のバッファ (FB_BYTES(format)バイト) として初期化する
+void fb_init_indexed(struct framebuffer *fb, uint8_t *buf, fb_format_t format, const uint16_t *palette, struct damage *damage);
+// RGB332の全画面のバッファ (FB_BYTES(FB_RGB332)バイト) として初期化する
+void fb_init_rgb332(struct framebuffer *fb, uint8_t *buf, struct damage *damage);
+// パレットを差し替える。次のrender_dirty()で画面全体を新しい色で送る
+void fb_set_palette(struct framebuffer *fb, const uint16_t *palette);
+// 8/4bppのy行目の (x,y) からnピクセルをRGB565に展開してdstに書く
+void fb_expand_row(const struct framebuffer *fb, int x, int y, int n, uint16_t *dst);
+// x列目の (x,y) から下へnピクセルをRGB565にしてdstに書く (どの形式でもよい。90/270度の画面へ送るときに使う)
+void fb_expand_col(const struct framebuffer *fb, int x, int y, int n, uint16_t *dst);
+void fb_clear(struct framebuffer *fb, uint16_t color);
+
+void set_pixel(struct framebuffer *fb, int x, int y, uint16_t color);
+void draw_hline(struct framebuffer *fb, int x0, int x1, int y, uint16_t color);
+void draw_vline(struct framebuffer *fb, int x, int y0, int y1, uint16_t color);
+void draw_line(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color);
+// ラインをw x hの画面に切り取る (Cohen-Sutherland)。見えなければfalseを返す
+bool clip_line(int *x0, int *y0, int *x1, int *y1, int w, int h);
+void draw_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color);
+void fill_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, uint16_t color);
+void draw_circle(struct framebuffer *fb, int cx, int cy, int r, uint16_t color);
+void fill_circle(struct framebuffer *fb, int cx, int cy, int r, uint16_t color);
+void draw_triangle(struct framebuffer *fb, int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+void fill_triangle(struct framebuffer *fb, int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+// (x0,y0)-(x1,y1) を (dx,dy) にコピーする。領域の重なりも扱う。転送元と転送先の両方を画面とバンドに切り取る
+void copy_rect(struct framebuffer *fb, int x0, int y0, int x1, int y1, int dx, int dy);
+void draw_image(struct framebuffer *fb, int x, int y, int width, int height, const uint16_t *img);
+// 1行がstrideピクセルの画像 (アイコンをまとめたシートなど) の (sx,sy) から w x h の矩形を
+// (x,y) に描く。srcはフラッシュ上のconstデータでもよい
+void blit(struct framebuffer *fb, int x, int y, const uint16_t *src, int stride, int sx, int sy, int w, int h);
+// 転送元の (sx,sy) からの w x h を (x,y) に描くときに、画面とバンドの範囲に切り取る。
+// 見えなければfalseを返す
+bool fb_clip_blit(struct framebuffer *fb, int *x, int *y, int *sx, int *sy, int *w, int *h);
+// render_blit()と同じく、パネルの論理座標の画面に切り取る
+bool render_clip_blit(struct ssd1331 *dev, int *x, int *y, int *sx, int *sy, int *w, int *h);
+// blit()と同じ矩形をフレームバッファを介さずにパネルへ直接送る
+void render_blit(struct ssd1331 *dev, int x, int y, const uint16_t *src, int stride, int sx, int sy, int w, int h);
+void write_char(struct framebuffer *fb, int x, int y, uint8_t ch, uint16_t color);
+void write_string(struct framebuffer *fb, int x, int y, const char *str, uint16_t color);
+
+#endif // GFX_H
@@ -0,0 +1,293 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "glyph.h"
+#include "font.h"
+#include "perf.h"
+
+// ニブル (4ピクセル分のビット) を前景色/背景色の4ピクセルに展開する表
+static struct {
+    bool valid;
+    uint16_t fg;
+    uint16_t bg;
+    union {
+        uint32_t w[2];
+        uint16_t h[4];
+    } span[16];
+} lut;
+
+static void build_lut(uint16_t fg, uint16_t bg) {
+    if (lut.valid && lut.fg == fg && lut.bg == bg)
+        return;
+
+    for (int n = 0; n < 16; n++)
+        for (int k = 0; k < 4; k++)
+            lut.span[n].h[k] = (n & (0x8 >> k)) ? fg : bg;
+    lut.fg = fg;
+    lut.bg = bg;
+    lut.valid = true;
+}
+
+// 8/4bpp用: ニブルを前景/背景の値の4ピクセル (8bppは4バイト、4bppは2バイト) に展開する表
+static struct {
+    bool valid;
+    bool nibble;
+    uint8_t fg;
+    uint8_t bg;
+    uint8_t span[16][4];
+} ilut;
+
+static void build_ilut(bool nibble, uint8_t fg, uint8_t bg) {
+    if (ilut.valid && ilut.nibble == nibble && ilut.fg == fg && ilut.bg == bg)
+        return;
+
+    for (int n = 0; n < 16; n++) {
+        uint8_t p[4];
+        for (int k = 0; k < 4; k++)
+            p[k] = (n & (0x8 >> k)) ? fg : bg;
+        if (!nibble) {
+            memcpy(ilut.span[n], p, 4);
+        } else {
+            ilut.span[n][0] = (p[0] & 0x0f) << 4 | (p[1] & 0x0f);
+            ilut.span[n][1] = (p[2] & 0x0f) << 4 | (p[3] & 0x0f);
+        }
+    }
+    ilut.nibble = nibble;
+    ilut.fg = fg;
+    ilut.bg = bg;
+    ilut.valid = true;
+}
+
+// 描画に使うフォント。glyph_set_font()で変えるまでは組み込みのfont.h
+static struct glyph_font cur = {
+    bits : font,
+    prop : font_prop,
+    first : FONT_FIRST,
+    last : FONT_LAST
+};
+
+void glyph_set_font(const struct glyph_font *f) {
+    static const struct glyph_font builtin = {
+        bits : font,
+        prop : font_prop,
+        first : FONT_FIRST,
+        last : FONT_LAST
+    };
+
+    if (!f)
+        f = &builtin;
+    // 範囲外の文字は空白で描く
+    assert(f->first <= ' ' && f->last >= ' ');
+    cur = *f;
+}
+
+static inline const uint8_t *glyph(uint8_t ch) {
+    if (ch < cur.first || ch > cur.last)
+        ch = ' ';
+    return &cur.bits[(ch - cur.first) * FONT_HEIGHT];
+}
+
+static inline int glyph_left(uint8_t ch, int flags) {
+    if (!(flags & TEXT_PROPORTIONAL) || ch < cur.first || ch > cur.last)
+        return 0;
+    return cur.prop[ch - cur.first] >> 4;
+}
+
+// 次の文字までの幅: プロポーショナルでは文字幅に1桁の間隔を加える
+static inline int glyph_advance(uint8_t ch, int flags) {
+    if (!(flags & TEXT_PROPORTIONAL))
+        return FONT_WIDTH;
+    if (ch < cur.first || ch > cur.last)
+        ch = ' ';
+    return (cur.prop[ch - cur.first] & 0x0f) + 1;
+}
+
+// 1行分の8ピクセルを展開する: dstが4バイト境界なら32bitずつ書き込む
+static inline void expand_row(uint16_t *dst, uint8_t bits) {
+    const uint32_t *hi = lut.span[bits >> 4].w;
+    const uint32_t *lo = lut.span[bits & 0x0f].w;
+
+    if (((uintptr_t)dst & 3) == 0) {
+        pix2_t *d = (pix2_t *)dst;
+        d[0] = hi[0];
+        d[1] = hi[1];
+        d[2] = lo[0];
+        d[3] = lo[1];
+    } else {
+        const uint16_t *h = lut.span[bits >> 4].h;
+        const uint16_t *l = lut.span[bits & 0x0f].h;
+        dst[0] = h[0];
+        dst[1] = h[1];
+        dst[2] = h[2];
+        dst[3] = h[3];
+        dst[4] = l[0];
+        dst[5] = l[1];
+        dst[6] = l[2];
+        dst[7] = l[3];
+    }
+}
+
+// 切り取りや透過がある場合の1行: 列 [c0, c1] だけを描く
+static inline void put_row(uint16_t *dst, uint8_t bits, int c0, int c1, uint16_t fg, uint16_t bg, bool transparent) {
+    for (int k = c0; k <= c1; k++) {
+        if (bits & (0x80 >> k))
+            dst[k] = fg;
+        else if (!transparent)
+            dst[k] = bg;
+    }
+}
+
+// 8/4bppの1行分の8ピクセルを展開する。4bppではxが偶数 (バイト境界) でなければならない
+static inline void expand_row_index(struct framebuffer *fb, int x, int y, uint8_t bits) {
+    int n = fb->format == FB_INDEX4 ? 2 : 4;
+    uint8_t *dst = fb_irow(fb, y) + x * FB_BPP(fb->format) / 8;
+
+    memcpy(dst, ilut.span[bits >> 4], n);
+    memcpy(dst + n, ilut.span[bits & 0x0f], n);
+}
+
+static inline void put_row_index(struct framebuffer *fb, int x, int y, uint8_t bits, int c0, int c1,
+                                 uint8_t fg, uint8_t bg, bool transparent) {
+    for (int k = c0; k <= c1; k++) {
+        if (bits & (0x80 >> k))
+            fb_put_index(fb, x + k, y, fg);
+        else if (!transparent)
+            fb_put_index(fb, x + k, y, bg);
+    }
+}
+
+int draw_char(struct framebuffer *fb, int x, int y, uint8_t ch, uint16_t fg, uint16_t bg, int flags) {
+    PERF_SCOPE(PERF_TEXT);
+    const uint8_t *g = glyph(ch);
+    int left = glyph_left(ch, flags);
+    int adv = glyph_advance(ch, flags);
+    bool transparent = flags & TEXT_TRANSPARENT;
+
+    // 描く列の範囲を画面内に切り取る
+    int c0 = MAX(0, -x);
+    int c1 = MIN(adv, FONT_WIDTH) - 1;
+    if (x + c1 > SSD1331_WIDTH - 1)
+        c1 = SSD1331_WIDTH - 1 - x;
+    int r0 = MAX(y, MAX(0, fb->y0));
+    int r1 = MIN(y + FONT_HEIGHT - 1, MIN(SSD1331_HEIGHT - 1, fb->y0 + fb->height - 1));
+    if (c0 > c1 || r0 > r1)
+        return adv;
+
+    bool fast = !transparent && c0 == 0 && c1 == FONT_WIDTH - 1 && left == 0;
+    if (fb->format != FB_RGB565) {
+        // 8/4bpp: fgとbgはパレットの番号またはRGB332の色
+        fast = fast && (fb->format != FB_INDEX4 || !(x & 1));
+        if (fast)
+            build_ilut(fb->format == FB_INDEX4, fg, bg);
+        for (int row = r0; row <= r1; row++) {
+            uint8_t bits = g[row - y] << left;
+
+            if (fast)
+                expand_row_index(fb, x, row, bits);
+            else
+                put_row_index(fb, x, row, bits, c0, c1, fg, bg, transparent);
+        }
+    } else {
+        if (!transparent)
+            build_lut(fg, bg);
+        for (int row = r0; row <= r1; row++) {
+            uint16_t *dst = fb_row(fb, row) + x;
+            uint8_t bits = g[row - y] << left;
+
+            if (fast)
+                expand_row(dst, bits);
+            else
+                put_row(dst, bits, c0, c1, fg, bg, transparent);
+        }
+    }
+
+    if (fb->damage)
+        damage_add(fb->damage, x + c0, r0, x + c1, r1);
+    return adv;
+}
+
+int draw_text(struct framebuffer *fb, int x, int y, const char *str, uint16_t fg, uint16_t bg, int flags) {
+    PERF_SCOPE(PERF_TEXT);
+    // 画面外の文字は描かずに幅だけ進める
+    struct damage *d = fb->damage;
+    int x_start = x;
+
+    fb->damage = NULL;
+    while (*str && x < SSD1331_WIDTH)
+        x += draw_char(fb, x, y, *str++, fg, bg, flags);
+    fb->damage = d;
+
+    // 文字列全体を1つの矩形として登録する
+    if (d && x > x_start)
+        damage_add(d, x_start, y, x - 1, y + FONT_HEIGHT - 1);
+    while (*str)
+        x += glyph_advance(*str++, flags);
+    return x;
+}
+
+int text_width(const char *str, int flags) {
+    int w = 0;
+
+    while (*str)
+        w += glyph_advance(*str++, flags);
+    return w;
+}
+
+void render_text(struct ssd1331 *dev, int x, int y, const char *str, uint16_t fg, uint16_t bg, int flags) {
+    PERF_SCOPE(PERF_TEXT);
+    // 1行分のピクセル: 最後の文字は8ピクセル全部を展開するので余分を持つ
+    uint16_t row[SSD1331_WIDTH + FONT_WIDTH] __attribute__((aligned(4)));
+    int w = text_width(str, flags);
+
+    assert(!(flags & TEXT_TRANSPARENT));
+    if (x < 0 || x >= ssd1331_width(dev) || y < 0 || y > ssd1331_height(dev) - FONT_HEIGHT || w == 0)
+        return;
+    w = MIN(w, ssd1331_width(dev) - x);
+
+    struct render_area area = {
+        start_col : x,
+        end_col : x + w - 1,
+        start_row : y,
+        end_row : y + FONT_HEIGHT - 1
+    };
+
+    build_lut(fg, bg);
+    render_begin(dev, &area);
+    for (int i = 0; i < FONT_HEIGHT; i++) {
+        int cx = 0;
+        for (const char *p = str; *p && cx < w; p++) {
+            uint8_t ch = *p;
+            uint8_t bits = glyph(ch)[i] << glyph_left(ch, flags);
+            // 固定幅では8ピクセル単位なので常に32bitずつ書き込める
+            expand_row(row + cx, bits);
+            cx += glyph_advance(ch, flags);
+        }
+        render_write(dev, row, w);
+    }
+    render_end(dev);
+}
+
+void render_cells(struct ssd1331 *dev, int x, int y, const char *text, const uint16_t *color, int n, uint16_t bg) {
+    // 画面の幅に入る桁だけを送る
+    char s[SSD1331_WIDTH / FONT_WIDTH + 1];
+    int c0 = 0;
+
+    n = MIN(n, SSD1331_WIDTH / FONT_WIDTH);
+    while (c0 < n) {
+        uint16_t fg = color[c0];
+        int c = c0;
+
+        for (; c < n; c++) {
+            if (text[c] != ' ' && color[c] != fg)
+                break;
+            s[c - c0] = text[c];
+        }
+        s[c - c0] = '\0';
+        render_text(dev, x + c0 * FONT_WIDTH, y, s, fg, bg, TEXT_OPAQUE);
+        c0 = c;
+    }
+}
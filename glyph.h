@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#include <stdint.h>
+#include "gfx.h"
+
+/* 8x8フォントによる文字の描画
+
+   フォントはtools/font_compilerで生成したfont.h (0x20-0x7Eの全ASCII) を使う。
+   glyph_set_font()でアセットのパックのフォント (asset_font()) などに替えられる。
+   ビットマップの各行はニブルごとに前景色/背景色の4ピクセル (32bitワード2つ) の
+   表に引き当てて展開する。表は色が変わったときだけ作り直す。
+*/
+
+#define TEXT_OPAQUE         0x00    // 背景色も描く
+#define TEXT_TRANSPARENT    0x01    // 点灯ピクセルだけ描き、背景はそのまま残す
+#define TEXT_PROPORTIONAL   0x02    // 文字ごとの幅で詰めて描く
+
+// 8x8のフォント: first-lastの文字のビットマップ (1文字8バイト、MSBが左端) と
+// プロポーショナル表示用の表 (1文字1バイト、font.hのfont_prop[]と同じ)
+struct glyph_font {
+    const uint8_t *bits;
+    const uint8_t *prop;
+    uint8_t first;          // 空白 (0x20) を含むこと
+    uint8_t last;
+};
+
+// 以降の描画に使うフォントを替える (内容をコピーする)。NULLなら組み込みのfont.hに戻す
+void glyph_set_font(const struct glyph_font *font);
+
+// 文字を描いて次の文字のx座標までの幅を返す。画面やバンドの外は切り取られる
+int draw_char(struct framebuffer *fb, int x, int y, uint8_t ch, uint16_t fg, uint16_t bg, int flags);
+// 文字列を描いて最後の文字の次のx座標を返す
+int draw_text(struct framebuffer *fb, int x, int y, const char *str, uint16_t fg, uint16_t bg, int flags);
+int text_width(const char *str, int flags);
+// フレームバッファを介さず、文字列の矩形をウィンドウにして1回のバーストでパネルに送る
+// (TEXT_TRANSPARENTは指定できない)
+void render_text(struct ssd1331 *dev, int x, int y, const char *str, uint16_t fg, uint16_t bg, int flags);
+// 固定幅のn桁の文字text[i]をcolor[i]の色で (x, y) から送る (コンソールや文字セルの1行)。
+// 色が同じ (空白はどの色とも同じとみなす) 桁をまとめてrender_text()で1回ずつ送る
+void render_cells(struct ssd1331 *dev, int x, int y, const char *text, const uint16_t *color, int n, uint16_t bg);
+
+#endif // GLYPH_H
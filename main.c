@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "pico/stdlib.h"
+#include "pico/binary_info.h"
+#include "hardware/spi.h"
+#include "ssd1331.h"
+#include "gfx.h"
+#include "accel.h"
+#include "asset_pack.h"
+
+/* SSD1331のデモ: 画像、文字、スクロール、反転表示、ラインを順に表示する */
+
+static struct ssd1331_bus bus;
+static struct ssd1331 oled;
+
+// パックの画像を (x, y) に送る。形式はマニフェストで選ぶ (rgb332なら256色モードで送る)
+static void show_image(int id, int x, int y) {
+    const struct asset_entry *e = asset_entry(asset_pack, id);
+    struct render_area area = {
+        start_col : x,
+        end_col : x + e->width - 1,
+        start_row : y,
+        end_row : y + e->height - 1
+    };
+
+    calc_render_area_buflen(&area);
+    switch (asset_format(asset_pack, id)) {
+    case ASSET_FMT_RGB332:
+        render332(&oled, asset_data(asset_pack, id), &area);
+        break;
+    case ASSET_FMT_QIMAGE: {
+        struct qimage img = asset_qimage(asset_pack, id);
+        render_qimage(&oled, x, y, &img);
+        break;
+    }
+    default:
+        render(&oled, asset_rgb565(asset_pack, id), &area);
+        break;
+    }
+}
+
+int main() {
+    // stdioの初期化
+    stdio_init_all();
+
+#if !defined(spi_default)
+#warning this example requires a board with spi pins
+    puts("Default SPI pins were not defined");
+#else
+    // ssd1331の初期化: リセットの待ち時間はアラームで進むので、その間に下の準備をする。
+    // パネルへの最初の転送 (accel_clear) は初期化が終わるまで待つ
+    ssd1331_bus_init(&bus, SPI_INSTANCE, SPI_SCK_PIN, SPI_MOSI_PIN, 10 * 1000 * 1000);
+    ssd1331_init_async(&oled, &bus, SPI_CSN_PIN, SPI_DCN_PIN, SPI_RESN_PIN, 0, NULL, NULL);
+    //printf("Hello, SSD1331\n");
+
+    // 描画領域を初期化
+    struct render_area frame_area = {
+        start_col: 0,
+        end_col : SSD1331_WIDTH - 1,
+        start_row : 0,
+        end_row : SSD1331_HEIGHT - 1
+    };
+
+    calc_render_area_buflen(&frame_area);
+
+    // 画面全体を黒で塗りつぶす
+    // 描画関数はfbを通してbufに描き、変更領域をdamageに記録する
+    uint16_t buf[SSD1331_BUF_LEN];
+    struct damage damage;
+    struct framebuffer fb;
+    fb_init(&fb, buf, &damage);
+
+    // パネルはCLEAR_WINコマンドで消去し、bufも同じ内容にする
+    accel_clear(&oled, &fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+
+    // 文字はパックのフォントで描く
+    struct glyph_font font = asset_font(asset_pack, ASSET_FONT);
+    glyph_set_font(&font);
+
+/*
+    // 色定義の確認
+    static uint16_t colors[] = {
+         COL_WHITE, COL_RED, COL_GREEN, COL_BLUE,
+         COL_YELLOW, COL_MAGENTA, COL_AQUA, COL_PURPLE,
+         COL_REDPINK, COL_ORANGE, COL_LGRAY, COL_GRAY, COL_BLACK
+    };
+
+    for (int i = 0; i < 13; i++) {
+        for (int j = 0; j < SSD1331_BUF_LEN; j++) {
+            buf[j] = color;
+            //buf[2*j] = (uint8_t)((colors[i] >> 8) & 0xff);
+            //buf[2*j+1] = (uint8_t)(colors[i] & 0xff);
+        }
+        render(&oled, buf, &frame_area);
+        sleep_ms(500);
+    }
+
+    // 画面を3回フラッシュ
+    for (int i = 0; i < 3; i++) {
+        send_cmd(&oled, SSD1331_SET_ALL_ON);
+        sleep_ms(500);
+        send_cmd(&oled, SSD1331_SET_ALL_OFF);
+        sleep_ms(500);
+    }
+*/
+
+restart:
+
+    // 画像を描画: ビルド時に生成したパック (assets/assets.txt) からフラッシュのまま送る
+    show_image(ASSET_ICONS, (SSD1331_WIDTH - ASSET_ICONS_WIDTH) / 2, 16);
+    show_image(ASSET_LOGO, (SSD1331_WIDTH - ASSET_LOGO_WIDTH) / 2, 40);
+    sleep_ms(1000);
+    render(&oled, buf, &frame_area);
+
+    // フォント出力
+    char *text[] = {
+        "ABCDEFGHIJKL",
+        "MNOPQRSTUVWX",
+        "YZ0123456789"
+    };
+
+    int y = 24;
+    for (int i = 0; i < count_of(text); i++) {
+        write_string(&fb, 0, y, text[i], COL_WHITE);
+        y += 8;
+    }
+    render_dirty(&oled, &fb);
+
+    // 横スクロール
+    scroll(&oled, 24, 0, SCROLL_HIGH, true);
+    sleep_ms(3000);
+    scroll(&oled, 24, 0, SCROLL_HIGH, false);
+
+    // 反転表示
+    send_cmd(&oled, SSD1331_SET_INV_DISP);
+    sleep_ms(1000);
+    send_cmd(&oled, SSD1331_SET_NORM_DISP);
+
+    sleep_ms(1000);
+    render(&oled, buf, &frame_area);
+
+
+    // ラインを描画
+    uint16_t color = COL_WHITE;
+    for (int i = 0; i < 2; i++) {
+        for (int x = 0; x < SSD1331_WIDTH; x++) {
+            accel_line(&oled, &fb, x, 0,  SSD1331_WIDTH - 1 - x, SSD1331_HEIGHT - 1, color);
+            render_dirty(&oled, &fb);
+        }
+
+        for (int y = SSD1331_HEIGHT - 1; y >= 0 ;y--) {
+            accel_line(&oled, &fb, 0, y, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1 - y, color);
+            render_dirty(&oled, &fb);
+        }
+        color = COL_BLACK;
+    }
+
+    goto restart;
+/*
+    // センサーの値: 変わった桁だけが送られる
+    static struct textgrid grid;
+    static const struct grid_field pres = { 3, 1, 9, GRID_ALIGN_RIGHT, COL_WHITE };
+    static const struct grid_field temp = { 3, 2, 9, GRID_ALIGN_RIGHT, COL_WHITE };
+    static const struct grid_field humi = { 3, 3, 9, GRID_ALIGN_RIGHT, COL_WHITE };
+
+    grid_init(&grid, &oled, COL_BLACK);
+    grid_puts(&grid, 0, 1, "P:", COL_YELLOW);
+    grid_puts(&grid, 0, 2, "T:", COL_YELLOW);
+    grid_puts(&grid, 0, 3, "H:", COL_YELLOW);
+    grid_printf(&grid, &pres, "%7.2f", 1007.41);
+    grid_printf(&grid, &temp, "%5.2f", 25.91);
+    grid_printf(&grid, &humi, "%5.2f", 30.04);
+*/
+
+#endif
+
+    return 0;
+}
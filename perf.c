@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ssd1331.h"
+#include "perf.h"
+
+#ifdef SSD1331_PERF
+
+struct perf_stats perf;
+
+static const char *prim_names[PERF_PRIM_COUNT] = {
+    "pixel", "line", "rect", "fill", "circle", "triangle", "text", "blit", "qimage", "accel", "sprite", "blend", "affine"
+};
+
+// 描画関数の入れ子の深さ: 外側の呼び出しだけを数える
+static int depth;
+
+// 実行中のフラッシュの開始時刻と開始時のバイト数
+static uint64_t flush_t0;
+static uint32_t flush_b0;
+
+void perf_reset(void) {
+    hal_ticks_start();
+    memset(&perf, 0, sizeof(perf));
+    perf.start_us = hal_time_us();
+    perf.frame_us = perf.start_us;
+}
+
+void perf_frame(void) {
+    uint64_t now = hal_time_us();
+
+    perf.frames++;
+    perf.frame_us_last = now - perf.frame_us;
+    perf.frame_us = now;
+}
+
+float perf_fps(void) {
+    uint64_t us = perf.frame_us - perf.start_us;
+    return us ? perf.frames * 1e6f / us : 0;
+}
+
+const char *perf_prim_name(perf_prim_t prim) {
+    return prim_names[prim];
+}
+
+const struct perf_stats *perf_get(void) {
+    return &perf;
+}
+
+void perf_flush_begin(void) {
+    flush_t0 = hal_time_us();
+    flush_b0 = perf.bytes;
+}
+
+void perf_flush_end(void) {
+    uint32_t us = hal_time_us() - flush_t0;
+
+    perf.flushes++;
+    perf.flush_bytes += perf.bytes - flush_b0;
+    perf.flush_us += us;
+    if (us > perf.flush_us_max)
+        perf.flush_us_max = us;
+}
+
+struct perf_scope perf_scope_begin(perf_prim_t prim) {
+    struct perf_scope s = { prim, depth++ == 0, 0 };
+
+    if (s.outer)
+        s.t0 = hal_ticks();
+    return s;
+}
+
+void perf_scope_end(struct perf_scope *s) {
+    depth--;
+    if (!s->outer)
+        return;
+
+    perf.prim[s->prim].calls++;
+    perf.prim[s->prim].ticks += (hal_ticks() - s->t0) & HAL_TICKS_MASK;
+}
+
+void perf_print(void) {
+    uint32_t tpu = hal_ticks_per_us();
+
+    printf("spi: %u bytes, %u transactions, %u format switches, %u window skips\n",
+           perf.bytes, perf.transactions, perf.format_switches, perf.window_skips);
+    if (perf.flushes)
+        printf("flush: %u, avg %u bytes, avg %u us, max %u us\n", perf.flushes,
+               perf.flush_bytes / perf.flushes, (uint32_t)(perf.flush_us / perf.flushes), perf.flush_us_max);
+    for (int i = 0; i < PERF_PRIM_COUNT; i++) {
+        if (!perf.prim[i].calls)
+            continue;
+        printf("%-9s %8u calls %10.1f us %8.2f us/call\n", perf_prim_name(i), perf.prim[i].calls,
+               (double)perf.prim[i].ticks / tpu, (double)perf.prim[i].ticks / tpu / perf.prim[i].calls);
+    }
+    if (perf.frames)
+        printf("frames: %u, %.1f fps (last %u us)\n", perf.frames, perf_fps(), perf.frame_us_last);
+}
+
+#endif // SSD1331_PERF
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include "ssd1331_hal.h"
+
+/* 性能カウンタ
+
+   SSD1331_PERFを定義してビルドしたときだけ有効になる。定義しなければ
+   カウンタは作られず、計測のマクロは何もしない (API呼び出しも空になる)。
+
+   * SPIのバイト数、CS#のトランザクション数、SPIフォーマットの切り替え回数、
+     省いたウィンドウの設定の回数
+   * フラッシュ (ピクセルデータを送る1回のトランザクション) の回数と時間
+   * 描画関数ごとの呼び出し回数と時間 (hal_ticks()の単位)。描画関数の中から
+     呼ばれた別の描画関数は数えず、外側の関数の時間に含める
+   * perf_frame()で数えたフレーム数とfps
+
+   カウンタはロックしないので、コア1で転送するパイプラインでは
+   転送の値と描画の値をそれぞれ片方のコアだけが更新する。
+*/
+
+typedef enum perf_prim {
+    PERF_PIXEL,
+    PERF_LINE,
+    PERF_RECT,
+    PERF_FILL,
+    PERF_CIRCLE,
+    PERF_TRIANGLE,
+    PERF_TEXT,
+    PERF_BLIT,
+    PERF_QIMAGE,
+    PERF_ACCEL,
+    PERF_SPRITE,
+    PERF_BLEND,
+    PERF_AFFINE,
+    PERF_PRIM_COUNT
+} perf_prim_t;
+
+struct perf_stats {
+    uint32_t bytes;             // SPIに書き出したバイト数
+    uint32_t transactions;      // CS#をアサートした回数
+    uint32_t format_switches;   // SPIフォーマットを切り替えた回数
+    uint32_t window_skips;      // 同じウィンドウなので設定を省いた回数
+    uint32_t flushes;
+    uint32_t flush_bytes;       // フラッシュで送ったバイト数 (コマンドを含む)
+    uint64_t flush_us;          // フラッシュの時間の合計
+    uint32_t flush_us_max;
+    struct {
+        uint32_t calls;
+        uint64_t ticks;
+    } prim[PERF_PRIM_COUNT];
+    uint32_t frames;
+    uint64_t start_us;          // perf_reset()した時刻
+    uint64_t frame_us;          // 最後にperf_frame()した時刻
+    uint32_t frame_us_last;     // 直前のフレームの間隔
+};
+
+#ifdef SSD1331_PERF
+
+extern struct perf_stats perf;
+
+void perf_reset(void);
+// 1フレーム描き終わるごとに呼ぶ
+void perf_frame(void);
+// perf_reset()からの平均fps
+float perf_fps(void);
+const struct perf_stats *perf_get(void);
+const char *perf_prim_name(perf_prim_t prim);
+void perf_print(void);
+
+// ドライバ内部で使う計測用の関数とマクロ
+void perf_flush_begin(void);
+void perf_flush_end(void);
+
+struct perf_scope {
+    uint8_t prim;
+    bool outer;
+    uint32_t t0;
+};
+
+struct perf_scope perf_scope_begin(perf_prim_t prim);
+void perf_scope_end(struct perf_scope *scope);
+
+#define PERF_ADD(field, n)  (perf.field += (n))
+// 関数の先頭に置くと、関数を抜けるまでをprimの時間として数える
+#define PERF_SCOPE(prim)    struct perf_scope _perf_scope __attribute__((cleanup(perf_scope_end))) = perf_scope_begin(prim)
+
+#else
+
+static inline void perf_reset(void) {}
+static inline void perf_frame(void) {}
+static inline float perf_fps(void) { return 0; }
+static inline const struct perf_stats *perf_get(void) { return NULL; }
+static inline const char *perf_prim_name(perf_prim_t prim) { return ""; }
+static inline void perf_print(void) {}
+
+static inline void perf_flush_begin(void) {}
+static inline void perf_flush_end(void) {}
+
+#define PERF_ADD(field, n)  ((void)0)
+#define PERF_SCOPE(prim)    ((void)0)
+
+#endif // SSD1331_PERF
+
+#endif // PERF_H
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "pipeline.h"
+
+// コア1への停止の依頼とその応答
+#define PIPE_STOP   0xffffffffu
+
+// コア1から参照するパイプライン (同時に動かせるのは1つだけ)
+static struct pipeline *active;
+
+static void core1_main(void) {
+    struct render_area area = {
+        start_col : 0,
+        end_col : SSD1331_WIDTH - 1,
+        start_row : 0,
+        end_row : SSD1331_HEIGHT - 1
+    };
+
+    calc_render_area_buflen(&area);
+    while (true) {
+        uint32_t n = hal_fifo_pop();
+        if (n == PIPE_STOP) {
+            hal_fifo_push(PIPE_STOP);
+            return;
+        }
+
+        uint64_t t = hal_time_us();
+        // 90/270度では転置して持っているフレームを列の順に読んで送る
+        if (ssd1331_transposed(active->dev))
+            render_transposed(active->dev, &active->fb[n], 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+        else
+            render(active->dev, active->fb[n].buf, &area);
+        active->flush_us = hal_time_us() - t;
+        active->flushed++;
+        hal_fifo_push(n);
+    }
+}
+
+void pipe_start(struct pipeline *pipe, struct ssd1331 *dev, uint16_t *buf0, uint16_t *buf1) {
+    assert(!active);
+
+    pipe->dev = dev;
+    fb_init(&pipe->fb[0], buf0, NULL);
+    fb_init(&pipe->fb[1], buf1, NULL);
+    pipe->back = 0;
+    pipe->in_flight = 0;
+    pipe->submitted = 0;
+    pipe->flushed = 0;
+    pipe->flush_us = 0;
+
+    // 描画中のDMA転送が残っていればコア1に渡す前に終わらせる
+    bus_wait(dev->bus);
+    active = pipe;
+    hal_core1_launch(core1_main);
+}
+
+// 届いている完了通知を受け取る。waitなら少なくとも1つ届くまで待つ
+static void collect(struct pipeline *pipe, bool wait) {
+    while (pipe->in_flight && (wait || hal_fifo_ready())) {
+        hal_fifo_pop();
+        pipe->in_flight--;
+        wait = false;
+    }
+}
+
+struct framebuffer *pipe_acquire(struct pipeline *pipe) {
+    // コア1は依頼された順に転送するので、2つとも転送待ちなら先に渡した方
+    // (次に描くバッファ) の完了を待てばよい
+    collect(pipe, pipe->in_flight == 2);
+    return &pipe->fb[pipe->back];
+}
+
+struct framebuffer *pipe_try_acquire(struct pipeline *pipe) {
+    collect(pipe, false);
+    return pipe->in_flight == 2 ? NULL : &pipe->fb[pipe->back];
+}
+
+void pipe_submit(struct pipeline *pipe) {
+    assert(pipe->in_flight < 2);
+
+    hal_fifo_push(pipe->back);
+    pipe->in_flight++;
+    pipe->submitted++;
+    pipe->back ^= 1;
+}
+
+void pipe_sync(struct pipeline *pipe) {
+    while (pipe->in_flight)
+        collect(pipe, true);
+}
+
+void pipe_stop(struct pipeline *pipe) {
+    pipe_sync(pipe);
+    hal_fifo_push(PIPE_STOP);
+    while (hal_fifo_pop() != PIPE_STOP)
+        ;
+    active = NULL;
+}
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gfx.h"
+
+/* 2コアによるパイプライン描画
+
+   フレームバッファを2つ使い、コア0がフレームN+1を描いている間に
+   コア1がフレームNを全画面転送する。バッファの所有権はコア間FIFOで
+   バッファ番号を送って受け渡す (コア0→コア1: 転送の依頼, コア1→コア0: 転送の完了)。
+
+   pipe_start()の後はコア1がパネルのSPIバスを専有するので、コア0から同じバスへの
+   render()などの転送関数を呼んではならない。
+
+     struct framebuffer *fb = pipe_acquire(&pipe);  // 空いているバッファを受け取る
+     ... fbに描く ...
+     pipe_submit(&pipe);                             // コア1に転送を依頼する
+
+   両方のバッファが転送待ちのとき、pipe_acquire()は片方の転送が終わるまで待つ。
+   待たずに描画を飛ばしたい場合はpipe_try_acquire()を使う。
+*/
+
+struct pipeline {
+    struct ssd1331 *dev;        // コア1が転送するパネル
+    struct framebuffer fb[2];
+    uint8_t back;               // コア0が次に描くバッファ
+    uint8_t in_flight;          // コア1に渡して戻っていないバッファの数
+    uint32_t submitted;         // 転送を依頼したフレーム数
+    volatile uint32_t flushed;  // 転送が終わったフレーム数 (コア1が更新する)
+    volatile uint32_t flush_us; // 直近のフレームの転送時間 (コア1が更新する)
+};
+
+// 2つのバッファ (それぞれSSD1331_BUF_LEN個のピクセル) を使ってdevに転送するコア1を起動する
+void pipe_start(struct pipeline *pipe, struct ssd1331 *dev, uint16_t *buf0, uint16_t *buf1);
+// 転送の終わった方のバッファを返す。両方とも転送待ちなら空くまで待つ
+struct framebuffer *pipe_acquire(struct pipeline *pipe);
+// 空いているバッファがなければ待たずにNULLを返す
+struct framebuffer *pipe_try_acquire(struct pipeline *pipe);
+// pipe_acquire()で受け取ったバッファの転送をコア1に依頼する
+void pipe_submit(struct pipeline *pipe);
+// 依頼したすべてのフレームの転送が終わるまで待つ
+void pipe_sync(struct pipeline *pipe);
+// 転送を終えてからコア1を止める。以降はコア0から転送関数を使える
+void pipe_stop(struct pipeline *pipe);
+
+#endif // PIPELINE_H
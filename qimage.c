@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+#include "ssd1331.h"
+#include "qimage.h"
+#include "perf.h"
+
+void qdec_init(struct qdec *dec, const struct qimage *img) {
+    dec->p = img->data;
+    dec->end = img->data + img->size;
+    dec->color = 0;
+    dec->run = 0;
+    memset(dec->index, 0, sizeof(dec->index));
+}
+
+// 成分ごとに差を加える。各成分はそれぞれのビット幅で桁あふれさせる
+static inline uint16_t add_diff(uint16_t c, int dr, int dg, int db) {
+    int r = ((c >> 11) + dr) & 0x1f;
+    int g = (((c >> 5) & 0x3f) + dg) & 0x3f;
+    int b = ((c & 0x1f) + db) & 0x1f;
+    return (r << 11) | (g << 5) | b;
+}
+
+void qdec_read(struct qdec *dec, uint16_t *dst, int n) {
+    const uint8_t *p = dec->p;
+    uint16_t c = dec->color;
+    uint16_t *end = dst + n;
+
+    // 前の行から続く繰り返し
+    int k = MIN(dec->run, n);
+    for (int i = 0; i < k; i++)
+        *dst++ = c;
+    dec->run -= k;
+
+    while (dst < end) {
+        assert(p < dec->end);
+        uint8_t op = *p++;
+
+        if (op == QIMG_OP_RGB) {
+            c = (p[0] << 8) | p[1];
+            p += 2;
+        } else {
+            switch (op & QIMG_MASK) {
+            case QIMG_OP_INDEX:
+                c = dec->index[op];
+                break;
+            case QIMG_OP_DIFF:
+                c = add_diff(c, ((op >> 4) & 3) - 2, ((op >> 2) & 3) - 2, (op & 3) - 2);
+                break;
+            case QIMG_OP_LUMA: {
+                int dg = (op & 0x3f) - 32;
+                uint8_t rb = *p++;
+                c = add_diff(c, (rb >> 4) - 8 + (dg >> 1), dg, (rb & 0x0f) - 8 + (dg >> 1));
+                break;
+            }
+            default: {
+                // 繰り返し: 行に収まらない分は次の呼び出しに持ち越す
+                int run = (op & 0x3f) + 1;
+                k = MIN(run, end - dst);
+                for (int i = 0; i < k; i++)
+                    *dst++ = c;
+                dec->run = run - k;
+                continue;
+            }
+            }
+        }
+        dec->index[QIMG_HASH(c)] = c;
+        *dst++ = c;
+    }
+
+    dec->p = p;
+    dec->color = c;
+}
+
+// nピクセルを復号して捨てる。見えない部分も順に復号しないと直前の色や表が進まない
+static void qdec_skip(struct qdec *dec, int n) {
+    uint16_t skip[SSD1331_WIDTH];
+
+    while (n > 0) {
+        int k = MIN(n, SSD1331_WIDTH);
+        qdec_read(dec, skip, k);
+        n -= k;
+    }
+}
+
+// 幅widthの1行のうちsx桁からのwピクセルをdstに取り出し、左右の残りは捨てる
+static void read_cols(struct qdec *dec, uint16_t *dst, int width, int sx, int w) {
+    qdec_skip(dec, sx);
+    qdec_read(dec, dst, w);
+    qdec_skip(dec, width - sx - w);
+}
+
+void draw_qimage(struct framebuffer *fb, int x, int y, const struct qimage *img) {
+    assert(fb->format == FB_RGB565);
+    PERF_SCOPE(PERF_QIMAGE);
+    struct qdec dec;
+    int sx = 0, sy = 0, w = img->width, h = img->height;
+
+    // blit()と同じく画面とバンドに切り取る
+    if (!fb_clip_blit(fb, &x, &y, &sx, &sy, &w, &h))
+        return;
+
+    // 見える行より上の行も順に復号しなければならないので捨てる
+    qdec_init(&dec, img);
+    qdec_skip(&dec, sy * img->width);
+    for (int i = 0; i < h; i++)
+        read_cols(&dec, fb_row(fb, y + i) + x, img->width, sx, w);
+    if (fb->damage)
+        damage_add(fb->damage, x, y, x + w - 1, y + h - 1);
+}
+
+void render_qimage(struct ssd1331 *dev, int x, int y, const struct qimage *img) {
+    PERF_SCOPE(PERF_QIMAGE);
+    uint16_t row[SSD1331_WIDTH];
+    struct qdec dec;
+    int sx = 0, sy = 0, w = img->width, h = img->height;
+
+    if (!render_clip_blit(dev, &x, &y, &sx, &sy, &w, &h))
+        return;
+
+    struct render_area area = {
+        start_col : x,
+        end_col : x + w - 1,
+        start_row : y,
+        end_row : y + h - 1
+    };
+
+    // 1行復号するたびに見える桁だけを送る。ウィンドウを見える矩形にしておけば
+    // 行の区切りを意識せずに続けて書き込める
+    qdec_init(&dec, img);
+    qdec_skip(&dec, sy * img->width);
+    render_begin(dev, &area);
+    for (int i = 0; i < h; i++) {
+        read_cols(&dec, row, img->width, sx, w);
+        render_write(dev, row, w);
+    }
+    render_end(dev);
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef QIMAGE_H
+#define QIMAGE_H
+
+#include <stdint.h>
+#include "gfx.h"
+
+/* RGB565の圧縮画像 (QOI形式をRGB565向けにしたもの)
+
+   tools/bmp_to_hex.c の -q オプションで生成する。ピクセルは左上から行順に並び、
+   各ピクセルは直前のピクセルとの関係で次のいずれかの命令で表す。
+
+     00iiiiii             : 最近使った64色の表のi番目
+     01rrggbb             : 直前の色との差 (各成分 -2..1)
+     10gggggg rrrrbbbb    : Gの差 (-32..31) と、R/BのGの差の1/2からのずれ (-8..7)
+     11nnnnnn             : 直前の色をn+1回繰り返す (1..62)
+     11111110 hhhhhhhh llllllll : RGB565の値そのもの
+
+   直前の色の初期値は黒で、繰り返しは行をまたいでもよい。
+   復号器は1行ずつ取り出せるので、全画面分のバッファを持たずに転送できる。
+*/
+
+#define QIMG_OP_INDEX   0x00
+#define QIMG_OP_DIFF    0x40
+#define QIMG_OP_LUMA    0x80
+#define QIMG_OP_RUN     0xc0
+#define QIMG_OP_RGB     0xfe
+#define QIMG_MASK       0xc0
+#define QIMG_RUN_MAX    62
+
+#define QIMG_HASH(c)    ((((c) >> 11) * 3 + (((c) >> 5) & 0x3f) * 5 + ((c) & 0x1f) * 7) & 0x3f)
+
+struct qimage {
+    uint8_t width;
+    uint8_t height;
+    uint32_t size;          // dataのバイト数
+    const uint8_t *data;
+};
+
+// 復号の途中の状態
+struct qdec {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint16_t color;         // 直前の色
+    uint8_t run;            // 残りの繰り返し回数
+    uint16_t index[64];
+};
+
+void qdec_init(struct qdec *dec, const struct qimage *img);
+// 次のnピクセルをdstに取り出す
+void qdec_read(struct qdec *dec, uint16_t *dst, int n);
+
+// フレームバッファの (x,y) に展開する。画面とバンドの外のピクセルは復号して捨てる
+void draw_qimage(struct framebuffer *fb, int x, int y, const struct qimage *img);
+// フレームバッファを介さず、1行ずつ復号しながらパネルへ送る。画面の外は切り取る
+void render_qimage(struct ssd1331 *dev, int x, int y, const struct qimage *img);
+
+#endif // QIMAGE_H
@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "rgb888.h"
+#include "perf.h"
+
+#define CHUNK   32      // パネルへ直接送るときに1回で変換するピクセル数
+
+// 4x4の組織的ディザの行列 (0-15)
+static const uint8_t bayer[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+// 成分cを最大値maxに比例させる。ディザではcを0-256に広げたc'から (c' * max + t) / 256 にする
+// (tは0-255のしきい値)。c = 255はtによらず最大値になり、最大値を超えないので飽和の判定は要らない
+#define SCALE(c, max, t)    ((((c) + ((c) >> 7)) * (max) + (t)) >> 8)
+
+static inline __attribute__((always_inline)) void span(uint16_t *dst, const uint8_t *src, int n, int x, int y, bool bgr, bool dither) {
+    // RとBの位置はループの外で決めておく
+    const uint8_t *r = src + (bgr ? 2 : 0), *g = src + 1, *b = src + (bgr ? 0 : 2);
+    int i = 0;
+
+    if (!dither) {
+        for (; i < n; i++, r += 3, g += 3, b += 3)
+            dst[i] = (*r >> 3) << 11 | (*g >> 2) << 5 | *b >> 3;
+        return;
+    }
+
+    // この行のしきい値を4ピクセル分並べ、4ピクセルずつ変換してレジスタに置いたまま使う
+    const uint8_t *row = bayer[y & 3];
+    uint32_t t0 = row[x & 3] * 16 + 8, t1 = row[(x + 1) & 3] * 16 + 8;
+    uint32_t t2 = row[(x + 2) & 3] * 16 + 8, t3 = row[(x + 3) & 3] * 16 + 8;
+
+    for (; i + 4 <= n; i += 4, r += 12, g += 12, b += 12) {
+        dst[i] = SCALE(r[0], 31, t0) << 11 | SCALE(g[0], 63, t0) << 5 | SCALE(b[0], 31, t0);
+        dst[i + 1] = SCALE(r[3], 31, t1) << 11 | SCALE(g[3], 63, t1) << 5 | SCALE(b[3], 31, t1);
+        dst[i + 2] = SCALE(r[6], 31, t2) << 11 | SCALE(g[6], 63, t2) << 5 | SCALE(b[6], 31, t2);
+        dst[i + 3] = SCALE(r[9], 31, t3) << 11 | SCALE(g[9], 63, t3) << 5 | SCALE(b[9], 31, t3);
+    }
+    // 残り (3ピクセル以下) のしきい値は順にt0, t1, t2
+    uint32_t t[3] = { t0, t1, t2 };
+    for (int k = 0; i < n; i++, k++, r += 3, g += 3, b += 3)
+        dst[i] = SCALE(*r, 31, t[k]) << 11 | SCALE(*g, 63, t[k]) << 5 | SCALE(*b, 31, t[k]);
+}
+
+void rgb888_span(uint16_t *dst, const uint8_t *src, int n, int x, int y, int flags) {
+    // 形式ごとに判定を外へ出した版を使う
+    switch (flags & (RGB888_BGR | RGB888_DITHER)) {
+    case 0:
+        span(dst, src, n, x, y, false, false);
+        break;
+    case RGB888_BGR:
+        span(dst, src, n, x, y, true, false);
+        break;
+    case RGB888_DITHER:
+        span(dst, src, n, x, y, false, true);
+        break;
+    default:
+        span(dst, src, n, x, y, true, true);
+        break;
+    }
+}
+
+void rgb888_begin_fb(struct rgb888_stream *s, struct framebuffer *fb, int x, int y, int w, int h, int flags) {
+    assert(fb->format == FB_RGB565);
+    assert(x >= 0 && x + w <= SSD1331_WIDTH && y >= 0 && y + h <= SSD1331_HEIGHT && w > 0 && h > 0);
+
+    memset(s, 0, sizeof(*s));
+    s->fb = fb;
+    s->flags = flags;
+    s->left = x;
+    s->top = y;
+    s->width = w;
+    s->height = h;
+}
+
+void rgb888_begin(struct rgb888_stream *s, struct ssd1331 *dev, int x, int y, int w, int h, int flags) {
+    struct render_area area = {
+        start_col : x,
+        end_col : x + w - 1,
+        start_row : y,
+        end_row : y + h - 1
+    };
+
+    assert(x >= 0 && x + w <= ssd1331_width(dev) && y >= 0 && y + h <= ssd1331_height(dev) && w > 0 && h > 0);
+
+    memset(s, 0, sizeof(*s));
+    s->dev = dev;
+    s->flags = flags;
+    s->left = x;
+    s->top = y;
+    s->width = w;
+    s->height = h;
+    render_begin(dev, &area);
+}
+
+// n個の完全なピクセルを書き込む。行の途中で切れていてもよい
+static void emit(struct rgb888_stream *s, const uint8_t *src, size_t n) {
+    while (n > 0 && s->y < s->height) {
+        int k = MIN(n, (size_t)(s->width - s->x));
+
+        if (s->fb) {
+            if (fb_has_row(s->fb, s->top + s->y))
+                rgb888_span(fb_row(s->fb, s->top + s->y) + s->left + s->x, src, k, s->x, s->y, s->flags);
+        } else {
+            // ウィンドウは行の終わりで次の行へ進むので、行の区切りに関係なく続けて送ればよい
+            uint16_t buf[CHUNK];
+            k = MIN(k, CHUNK);
+            rgb888_span(buf, src, k, s->x, s->y, s->flags);
+            render_write(s->dev, buf, k);
+        }
+
+        src += 3 * k;
+        n -= k;
+        s->x += k;
+        if (s->x == s->width) {
+            s->x = 0;
+            s->y++;
+        }
+    }
+}
+
+void rgb888_write(struct rgb888_stream *s, const uint8_t *data, size_t len) {
+    PERF_SCOPE(PERF_BLIT);
+
+    // 前回途中で切れたピクセルを先に完成させる
+    while (s->npart > 0 && len > 0) {
+        s->part[s->npart++] = *data++;
+        len--;
+        if (s->npart == 3) {
+            emit(s, s->part, 1);
+            s->npart = 0;
+        }
+    }
+
+    size_t n = len / 3;
+    emit(s, data, n);
+    data += 3 * n;
+    len -= 3 * n;
+    memcpy(s->part + s->npart, data, len);
+    s->npart += len;
+}
+
+void rgb888_end(struct rgb888_stream *s) {
+    if (!s->fb)
+        render_end(s->dev);
+    else if (s->fb->damage)
+        damage_add(s->fb->damage, s->left, s->top, s->left + s->width - 1, s->top + s->height - 1);
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef RGB888_H
+#define RGB888_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gfx.h"
+
+/* 実行時に受け取るRGB888 (BGR888) の画像のRGB565への変換
+
+   UARTやUSBで届く画像やカメラのサムネイルを、届いた分ずつ変換して
+   フレームバッファに書くか、パネルへ直接送る。24bitの画像全体 (96x64で18KB) を
+   RAMに持たなくてよい。データは画素の途中で切れていてもよい。
+
+   RGB()と同じく下位のビットを捨てると、なだらかなグラデーションに縞が出る。
+   RGB888_DITHERでは4x4の組織的ディザ (Bayer) をかけ、各成分を0-255から
+   0-31 (Gは0-63) に比例させてから、画素の位置ごとのしきい値で切り上げるかを決める。
+   0と255はしきい値によらず0と最大値になる (白と黒にディザの点が出ない)。
+   しきい値は画像の左上からの位置で決まるので、分けて届いても結果は同じになる。
+
+   変換は1バイトずつ読む。ディザでは行のしきい値4つをループの外で求め、
+   4ピクセルずつ変換してレジスタに置いたまま使う。
+*/
+
+#define RGB888_BGR      0x01    // 1ピクセルがB, G, Rの順 (BMPやカメラに多い)
+#define RGB888_DITHER   0x02    // 4x4の組織的ディザをかける
+
+// srcのnピクセルをdstに変換する。(x, y) は先頭のピクセルの画像内の位置 (ディザのしきい値を決める)
+void rgb888_span(uint16_t *dst, const uint8_t *src, int n, int x, int y, int flags);
+
+// 変換して書き込む途中の状態
+struct rgb888_stream {
+    struct framebuffer *fb;     // NULLならdevへ直接送る
+    struct ssd1331 *dev;
+    uint8_t flags;
+    uint8_t left;               // 書き込む矩形の左上 (fbのとき)
+    uint8_t top;
+    uint8_t width;
+    uint8_t height;
+    uint8_t x;                  // 次のピクセルの画像内の位置
+    uint8_t y;
+    uint8_t npart;              // partに溜めた、途中で切れたピクセルのバイト数
+    uint8_t part[3];
+};
+
+// fbの (x, y) からw x hに書き込む準備をする。バンドの範囲外の行は捨てる
+void rgb888_begin_fb(struct rgb888_stream *s, struct framebuffer *fb, int x, int y, int w, int h, int flags);
+// パネルの (x, y) からw x hのウィンドウに直接送る準備をする。rgb888_end()までバスを占有する
+void rgb888_begin(struct rgb888_stream *s, struct ssd1331 *dev, int x, int y, int w, int h, int flags);
+// 届いたlenバイトを変換して書き込む。画像の終わりを超えた分は捨てる
+void rgb888_write(struct rgb888_stream *s, const uint8_t *data, size_t len);
+// fbなら書いた範囲をdamageに登録し、パネルならトランザクションを終える
+void rgb888_end(struct rgb888_stream *s);
+
+#endif // RGB888_H
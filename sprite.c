@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "sprite.h"
+#include "perf.h"
+
+// 合成した1行: comp_flush()は送り終わってから戻るので共用する
+static uint16_t row[SSD1331_WIDTH];
+
+void sprite_init(struct sprite *s, const uint16_t *img, int stride, int w, int h) {
+    memset(s, 0, sizeof(*s));
+    s->img = img;
+    s->stride = stride;
+    s->w = w;
+    s->h = h;
+    s->visible = true;
+}
+
+void sprite_move(struct sprite *s, int x, int y) {
+    s->x = x;
+    s->y = y;
+}
+
+void sprite_set_image(struct sprite *s, const uint16_t *img, int stride) {
+    s->img = img;
+    s->stride = stride;
+    s->dirty = true;
+}
+
+void sprite_set_key(struct sprite *s, uint16_t key) {
+    s->key = key;
+    s->keyed = true;
+    s->dirty = true;
+}
+
+void sprite_show(struct sprite *s, bool visible) {
+    s->visible = visible;
+}
+
+void comp_init(struct compositor *comp, struct ssd1331 *dev) {
+    comp->dev = dev;
+    comp->count = 0;
+    damage_init(&comp->damage);
+    comp_set_background(comp, NULL, 0, COL_BLACK);
+}
+
+void comp_set_background(struct compositor *comp, const uint16_t *img, int stride, uint16_t color) {
+    comp->bg = img;
+    comp->bg_stride = stride;
+    comp->bg_color = color;
+    damage_add_all(&comp->damage);
+}
+
+bool comp_add(struct compositor *comp, struct sprite *s) {
+    if (comp->count == COMP_MAX_SPRITES)
+        return false;
+
+    s->shown = false;
+    comp->sprites[comp->count++] = s;
+    return true;
+}
+
+static void add_shown(struct compositor *comp, struct sprite *s) {
+    if (s->shown)
+        damage_add(&comp->damage, s->shown_x, s->shown_y,
+                   s->shown_x + s->shown_w - 1, s->shown_y + s->shown_h - 1);
+}
+
+void comp_remove(struct compositor *comp, struct sprite *s) {
+    for (int i = 0; i < comp->count; i++) {
+        if (comp->sprites[i] != s)
+            continue;
+
+        add_shown(comp, s);
+        s->shown = false;
+        memmove(&comp->sprites[i], &comp->sprites[i + 1], (comp->count - i - 1) * sizeof(comp->sprites[0]));
+        comp->count--;
+        return;
+    }
+}
+
+void comp_invalidate(struct compositor *comp, int x0, int y0, int x1, int y1) {
+    damage_add(&comp->damage, x0, y0, x1, y1);
+}
+
+// 同じzでは順番を変えない挿入ソート
+static void sort_sprites(struct compositor *comp) {
+    for (int i = 1; i < comp->count; i++) {
+        struct sprite *s = comp->sprites[i];
+        int j = i;
+
+        for (; j > 0 && comp->sprites[j - 1]->z > s->z; j--)
+            comp->sprites[j] = comp->sprites[j - 1];
+        comp->sprites[j] = s;
+    }
+}
+
+static inline bool changed(const struct sprite *s) {
+    if (s->dirty || s->visible != s->shown)
+        return true;
+    return s->visible && (s->x != s->shown_x || s->y != s->shown_y || s->z != s->shown_z
+                          || s->w != s->shown_w || s->h != s->shown_h);
+}
+
+// y行目の [x0, x1] を合成する
+static void compose_row(struct compositor *comp, int y, int x0, int x1) {
+    int w = x1 - x0 + 1;
+
+    if (comp->bg) {
+        memcpy(row, comp->bg + y * comp->bg_stride + x0, 2 * w);
+    } else {
+        for (int i = 0; i < w; i++)
+            row[i] = comp->bg_color;
+    }
+
+    for (int i = 0; i < comp->count; i++) {
+        struct sprite *s = comp->sprites[i];
+
+        if (!s->visible || y < s->y || y >= s->y + s->h)
+            continue;
+        int a = MAX(x0, s->x);
+        int b = MIN(x1, s->x + s->w - 1);
+        if (a > b)
+            continue;
+
+        const uint16_t *src = s->img + (y - s->y) * s->stride + (a - s->x);
+        uint16_t *dst = row + (a - x0);
+        int n = b - a + 1;
+        if (!s->keyed) {
+            memcpy(dst, src, 2 * n);
+        } else {
+            uint16_t key = s->key;
+            for (int k = 0; k < n; k++)
+                if (src[k] != key)
+                    dst[k] = src[k];
+        }
+    }
+}
+
+// x列目の [y0, y1] を合成する (90/270度の画面へ送るとき)
+static void compose_col(struct compositor *comp, int x, int y0, int y1) {
+    int h = y1 - y0 + 1;
+
+    for (int i = 0; i < h; i++)
+        row[i] = comp->bg ? comp->bg[(y0 + i) * comp->bg_stride + x] : comp->bg_color;
+
+    for (int i = 0; i < comp->count; i++) {
+        struct sprite *s = comp->sprites[i];
+
+        if (!s->visible || x < s->x || x >= s->x + s->w)
+            continue;
+        int a = MAX(y0, s->y);
+        int b = MIN(y1, s->y + s->h - 1);
+        if (a > b)
+            continue;
+
+        const uint16_t *src = s->img + (a - s->y) * s->stride + (x - s->x);
+        for (int y = a; y <= b; y++, src += s->stride)
+            if (!s->keyed || *src != s->key)
+                row[y - y0] = *src;
+    }
+}
+
+// 矩形を1行ずつ合成して1回のトランザクションで送る。90/270度の画面では
+// フレームバッファと同じく、桁と行を入れ替えたウィンドウへ1列ずつ合成して送る
+static void send_rect(struct compositor *comp, int x0, int y0, int x1, int y1) {
+    bool transposed = ssd1331_transposed(comp->dev);
+    struct render_area area = {
+        start_col : transposed ? y0 : x0,
+        end_col : transposed ? y1 : x1,
+        start_row : transposed ? x0 : y0,
+        end_row : transposed ? x1 : y1
+    };
+
+    calc_render_area_buflen(&area);
+    render_begin(comp->dev, &area);
+    if (transposed) {
+        for (int x = x0; x <= x1; x++) {
+            compose_col(comp, x, y0, y1);
+            render_write(comp->dev, row, y1 - y0 + 1);
+        }
+    } else {
+        for (int y = y0; y <= y1; y++) {
+            compose_row(comp, y, x0, x1);
+            render_write(comp->dev, row, x1 - x0 + 1);
+        }
+    }
+    render_end(comp->dev);
+}
+
+void comp_flush(struct compositor *comp) {
+    PERF_SCOPE(PERF_SPRITE);
+    struct damage *d = &comp->damage;
+
+    sort_sprites(comp);
+    for (int i = 0; i < comp->count; i++) {
+        struct sprite *s = comp->sprites[i];
+
+        if (!changed(s))
+            continue;
+        add_shown(comp, s);
+        if (s->visible)
+            damage_add(d, s->x, s->y, s->x + s->w - 1, s->y + s->h - 1);
+
+        s->shown = s->visible;
+        s->dirty = false;
+        s->shown_x = s->x;
+        s->shown_y = s->y;
+        s->shown_z = s->z;
+        s->shown_w = s->w;
+        s->shown_h = s->h;
+    }
+
+    if (damage_use_full(d)) {
+        send_rect(comp, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+    } else {
+        for (int i = 0; i < d->count; i++) {
+            struct damage_rect *r = &d->rects[i];
+            send_rect(comp, r->x0, r->y0, r->x1, r->y1);
+        }
+    }
+    damage_clear(d);
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1331.h"
+#include "damage.h"
+
+/* スプライトの合成
+
+   背景 (フラッシュ上の画像または単色) の上にスプライトを重ねてパネルへ送る。
+   全画面のフレームバッファは使わず、送る矩形を1行ずつ合成して
+   render_begin()/render_write()で送る。90/270度の画面ではフレームバッファと同じく
+   座標は転置した画面のもので、1列ずつ合成して送る (ssd1331.hの「表示の向き」)。
+
+   comp_flush()は前回送ったときから位置、表示、z順、画像が変わったスプライトの
+   前回の範囲と今の範囲を変更領域に登録し、その矩形 (重なれば併合される) だけを
+   合成し直して送る。16x16のスプライトを数ピクセル動かしたときの転送は
+   1フレーム数百バイトになる (全画面は12KB)。
+
+   スプライトの構造体は呼び出し側で持ち、comp_add()で登録する。
+   位置などを変えてからcomp_flush()を呼ぶ。
+*/
+
+#define COMP_MAX_SPRITES    16
+
+struct sprite {
+    const uint16_t *img;    // RGB565の画像 (フラッシュ上のconstデータでもよい)
+    uint16_t stride;        // imgの1行のピクセル数 (シートから切り出す場合はシートの幅)
+    uint8_t w;
+    uint8_t h;
+    int16_t x;              // 画面上の左上 (画面外にはみ出してもよい)
+    int16_t y;
+    int8_t z;               // 大きいほど手前。同じならcomp_add()の順に重ねる
+    bool visible;
+    bool keyed;             // keyの色のピクセルは描かず、下を透かす
+    uint16_t key;
+
+    // comp_flush()が最後に送った状態
+    bool shown;
+    bool dirty;             // 画像が変わった
+    int8_t shown_z;
+    int16_t shown_x;
+    int16_t shown_y;
+    uint8_t shown_w;
+    uint8_t shown_h;
+};
+
+struct compositor {
+    struct ssd1331 *dev;
+    const uint16_t *bg;     // 背景の画像 (画面の大きさ以上で1行bg_strideピクセル)。NULLならbg_color
+    uint16_t bg_stride;
+    uint16_t bg_color;
+    struct sprite *sprites[COMP_MAX_SPRITES];   // 奥から手前の順
+    int count;
+    struct damage damage;
+};
+
+// imgの (0,0) からw x hをスプライトにする。位置は (0,0) で表示する
+void sprite_init(struct sprite *s, const uint16_t *img, int stride, int w, int h);
+void sprite_move(struct sprite *s, int x, int y);
+// 画像を替える (アニメーションのコマなど)。大きさは変わらない
+void sprite_set_image(struct sprite *s, const uint16_t *img, int stride);
+void sprite_set_key(struct sprite *s, uint16_t key);
+void sprite_show(struct sprite *s, bool visible);
+
+void comp_init(struct compositor *comp, struct ssd1331 *dev);
+// 背景をimg (1行strideピクセル) にする。imgがNULLならcolorの単色。次のcomp_flush()で画面全体を送る
+void comp_set_background(struct compositor *comp, const uint16_t *img, int stride, uint16_t color);
+// 登録できなければfalseを返す
+bool comp_add(struct compositor *comp, struct sprite *s);
+// 登録を外す。表示していた範囲は次のcomp_flush()で背景に戻す
+void comp_remove(struct compositor *comp, struct sprite *s);
+// 矩形を次のcomp_flush()で送り直す (背景の画像の内容を書き換えた場合など)
+void comp_invalidate(struct compositor *comp, int x0, int y0, int x1, int y1);
+// 変わったスプライトの前回と今の範囲を合成して送る
+void comp_flush(struct compositor *comp);
+
+#endif // SPRITE_H
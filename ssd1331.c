@@ -8,12 +8,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
-#include "pico/stdlib.h"
-#include "pico/binary_info.h"
-#include "hardware/spi.h"
 #include "ssd1331.h"
-#include "font.h"
-#include "image.h"
+#include "gfx.h"
+#include "perf.h"
 
 /* SPI経由で96x64 16bit-Color OLEDディスプレイを駆動するSSD1331を
    操作するサンプルコード
@@ -30,347 +27,769 @@
 */
 
 void calc_render_area_buflen(struct render_area *area) {
-    // レンダーエリアのバッファの長さを計算する: データは16bit
+    // レンダーエリアのバッファの長さ (ピクセル数) を計算する
     area->buflen = (area->end_col - area->start_col + 1) * (area->end_row - area->start_row + 1);
 }
 
-#ifdef spi_default
+static inline void set_format(struct ssd1331_bus *bus, unsigned int bits) {
+    if (bus->bits != bits) {
+        hal_spi_set_format(bus, bits);
+        bus->bits = bits;
+        PERF_ADD(format_switches, 1);
+    }
+}
 
-void send_cmd(uint8_t cmd) {
-    spi_set_format(spi_default, 8, SPI_CPOL_0,  SPI_CPHA_0, SPI_MSB_FIRST);
-    CS_SELECT;
-    DC_COMMAND;
-    spi_write_blocking(spi_default, &cmd, 1);
-    DC_DATA;
-    CS_DESELECT;
+// SPIへの書き出しとCS#のアサートは性能カウンタで数えるため必ずここを通す
+static inline void spi_write(struct ssd1331_bus *bus, const uint8_t *buf, size_t len) {
+    hal_spi_write(bus, buf, len);
+    PERF_ADD(bytes, len);
 }
 
-void send_cmd_list(uint8_t *buf, size_t len) {
-    for (int i = 0; i < len; i++)
-        send_cmd(buf[i]);
+static inline void spi_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len) {
+    hal_spi_write16(bus, buf, len);
+    PERF_ADD(bytes, 2 * len);
 }
 
-void send_data(uint16_t *buf, size_t len) {
-    spi_set_format(spi_default, 16, SPI_CPOL_0,  SPI_CPHA_0, SPI_MSB_FIRST);
-    CS_SELECT;
-    DC_DATA;
-    spi_write16_blocking(spi_default, buf, len);
-    DC_COMMAND;
-    CS_DESELECT;
+// CS#, D/C#, RES#: グループではすべてのメンバーのピンを同じレベルにする
+#define FOR_PINS(dev, pin, value)                               \
+    do {                                                        \
+        if ((dev)->nmembers)                                    \
+            for (int _i = 0; _i < (dev)->nmembers; _i++)        \
+                hal_gpio_put((dev)->members[_i]->pin, value);   \
+        else                                                    \
+            hal_gpio_put((dev)->pin, value);                    \
+    } while (0)
+
+static inline void cs_select(struct ssd1331 *dev) {
+    FOR_PINS(dev, cs_pin, false);
+    PERF_ADD(transactions, 1);
 }
 
-void ssd1331_init(uint freq) {
-    // SPI0 を 10MHz で使用.
-    spi_init(spi_default, freq);
+static inline void cs_deselect(struct ssd1331 *dev) {
+    FOR_PINS(dev, cs_pin, true);
+}
 
-    gpio_set_function(SPI_SCK_PIN, GPIO_FUNC_SPI);
-    gpio_set_function(SPI_MOSI_PIN, GPIO_FUNC_SPI);
+static inline void dc_command(struct ssd1331 *dev) {
+    FOR_PINS(dev, dc_pin, false);
+}
 
-    // CS# (Chip select)ピンはアクティブLOWなので、HIGH状態で初期化
-    gpio_init(SPI_CSN_PIN);
-    gpio_set_function(SPI_CSN_PIN, GPIO_FUNC_SPI);
-    gpio_set_dir(SPI_CSN_PIN, GPIO_OUT);
-    CS_DESELECT;
+static inline void dc_data(struct ssd1331 *dev) {
+    FOR_PINS(dev, dc_pin, true);
+}
 
-    // D/C# (Data/Command)ピンはアクティブLOWなので、HIGH状態で初期化
-    gpio_init(SPI_DCN_PIN);
-    //gpio_set_function(SPI_DCN_PIN, GPIO_FUNC_SIO);
-    gpio_set_dir(SPI_DCN_PIN, GPIO_OUT);
-    DC_DATA;
+// グループとそのメンバーは同じパネルに送るので、片方に送ると
+// もう片方が覚えているウィンドウやFILLの設定は当てにならなくなる
+static void touch(struct ssd1331 *dev) {
+    if (dev->nmembers) {
+        for (int i = 0; i < dev->nmembers; i++)
+            ssd1331_invalidate(dev->members[i]);
+    } else if (dev->group) {
+        ssd1331_invalidate(dev->group);
+    }
+}
 
-    // RES# (Data/Command)ピンはアクティブLOWなので、HIGH状態で初期化
-    gpio_init(SPI_RESN_PIN);
-    //gpio_set_function(SPI_RESN_PIN, GPIO_FUNC_SIO);
-    gpio_set_dir(SPI_RESN_PIN, GPIO_OUT);
-    gpio_put(SPI_RESN_PIN, 1);
+// コマンドのバイト列を送る。CS#はアサート済みであること
+static void write_cmd_bytes(struct ssd1331 *dev, const uint8_t *buf, size_t len) {
+    struct ssd1331_bus *bus = dev->bus;
 
-    // ssd1331をリセット
-    reset();
+    if (len == 0)
+        return;
 
-    // デフォルト値で初期化: Adafruit-SSD1331-OLED-Driver-Library-for-Arduinoから引用
-    uint8_t cmds[] = {
-        SSD1331_SET_DISP_OFF,
-        SSD1331_SET_ROW_ADDR, 0x00, 0x3F,
-        SSD1331_SET_COL_ADDR, 0x00, 0x5F,
-        SSD1331_REMAP_COLOR_DEPTH, 0x72,
-        SSD1331_SET_DISP_START_LINE, 0x00,
-        SSD1331_SET_DISP_OFFSET, 0x00,
-        SSD1331_SET_NORM_DISP,
-        SSD1331_SET_MUX_RATIO, 0x3F,
-        SSD1331_SET_MASTER_CONFIG, 0xBE,
-        SSD1331_POWER_SAVE, 0x0B,
-        SSD1331_ADJUST, 0x74,
-        SSD1331_DISP_CLOck, 0xF0,
-        SSD1331_SET_PRECHARGE_A, 0x64,
-        SSD1331_SET_PRECHARGE_B, 0x78,
-        SSD1331_SET_PRECHARGE_C, 0x64,
-        SSD1331_SET_PRECHARGE_LEVEL, 0x3A,
-        SSD1331_SET_VCOMH, 0x3E,
-        SSD1331_MASTER_CURRENT_CNTL, 0x06,
-        SSD1331_SET_CONTRAST_A, 0x91,
-        SSD1331_SET_CONTRAST_B, 0x50,
-        SSD1331_SET_CONTRAST_C, 0x7D,
-        SSD1331_SET_DISP_ON_NORM
-    };
+    dc_command(dev);
+    if (bus->bits == 16 && (len & 1) == 0) {
+        // MSBファーストなので2バイトずつ16bitワードに詰めれば同じビット列になる。
+        // ピクセルデータの直前でフォーマットを切り替えずに済む
+        uint16_t words[CMDQ_LEN / 2];
+        for (size_t i = 0; i < len / 2; i++)
+            words[i] = (buf[2 * i] << 8) | buf[2 * i + 1];
+        spi_write16(bus, words, len / 2);
+    } else {
+        set_format(bus, 8);
+        spi_write(bus, buf, len);
+    }
+}
 
-    send_cmd_list(cmds, count_of(cmds));
-};
+// キューにたまったコマンドを送る。CS#はアサート済みであること
+static void write_cmds(struct ssd1331 *dev) {
+    write_cmd_bytes(dev, dev->cmdq.buf, dev->cmdq.len);
+    dev->cmdq.len = 0;
+}
 
-void scroll(uint8_t h, uint8_t v, scroll_interval_t speed, bool on) {
-    // 水平スクロールを構成
-    uint8_t cmds[] = {
-        SSD1331_SETUP_SCROL,
-        h, // 水平スクロールオフセット列数
-        0x00, // 開始行アドレス
-        0x40, // スクロールする行数
-        v, // 垂直スクロールオフセットの行数
-        (uint8_t)speed, // スクロールの時間間隔
-        on ? SSD1331_ACT_SCROL : SSD1331_DEACT_SCROL
-    };
+static inline uint32_t win_pixels(struct ssd1331 *dev) {
+    return (dev->win.c1 - dev->win.c0 + 1) * (dev->win.r1 - dev->win.r0 + 1);
+}
+
+// pixels個書いた後で書き込み位置がウィンドウの先頭に戻っていなければ
+// 次は同じウィンドウでも設定し直す
+static inline void window_written(struct ssd1331 *dev, uint32_t pixels) {
+    if (pixels % win_pixels(dev))
+        dev->win.valid = false;
+}
+
+static void wait_ready(struct ssd1331 *dev) {
+    if (!ssd1331_ready(dev))
+        ssd1331_wait_ready(dev);
+}
+
+// ブロッキングの転送のためにバスを確保する: パネルの初期化と待ち行列の転送が
+// 終わるまで待ち、終わるまで (blockingを戻すまで) 割り込みから転送を始めさせない
+static void bus_acquire(struct ssd1331 *dev) {
+    struct ssd1331_bus *bus = dev->bus;
+
+    wait_ready(dev);
+    while (true) {
+        bus_wait(bus);
+        uint32_t irq = hal_irq_save();
+        bool idle = bus->count == 0;
+        if (idle)
+            bus->blocking = true;
+        hal_irq_restore(irq);
+        if (idle)
+            return;
+    }
+}
+
+// パネルの色数をbits (16: 65K色, 8: 256色) にするコマンドをキューに入れる
+static void set_depth(struct ssd1331 *dev, uint8_t bits) {
+    if (dev->depth == bits)
+        return;
 
-    send_cmd_list(cmds, count_of(cmds));
+    queue_cmd(dev, SSD1331_REMAP_COLOR_DEPTH);
+    queue_cmd(dev, (dev->remap & ~SSD1331_REMAP_DEPTH_MASK) | (bits == 8 ? SSD1331_REMAP_256 : SSD1331_REMAP_65K));
+    dev->depth = bits;
 }
 
-void render(uint16_t *buf, struct render_area *area) {
-    // render_areaでディスプレイの一部を更新
+// キューのコマンドに続けて1ピクセルbitsビットのデータを送るトランザクションを開始する
+static void begin_data(struct ssd1331 *dev, uint8_t bits) {
+    // 色数はパネルの初期化が終わってから決める
+    wait_ready(dev);
+    set_depth(dev, bits);
+    bus_acquire(dev);
+    touch(dev);
+    perf_flush_begin();
+    cs_select(dev);
+    write_cmds(dev);
+    set_format(dev->bus, bits);
+    dc_data(dev);
+    dev->win.written = 0;
+}
+
+static void end_data(struct ssd1331 *dev) {
+    dc_command(dev);
+    cs_deselect(dev);
+    dev->bus->blocking = false;
+    perf_flush_end();
+    window_written(dev, dev->win.written);
+}
+
+static void queue_window(struct ssd1331 *dev, uint8_t c0, uint8_t c1, uint8_t r0, uint8_t r1) {
+    // 90/270度では論理座標の行がRAMの列になる
+    if (ssd1331_transposed(dev)) {
+        uint8_t t0 = c0, t1 = c1;
+        c0 = r0; c1 = r1;
+        r0 = t0; r1 = t1;
+    }
+    if (dev->win.valid && dev->win.c0 == c0 && dev->win.c1 == c1 && dev->win.r0 == r0 && dev->win.r1 == r1) {
+        PERF_ADD(window_skips, 1);
+        return;
+    }
+
     uint8_t cmds[] = {
         SSD1331_SET_COL_ADDR,
-        area->start_col,
-        area->end_col,
+        c0,
+        c1,
         SSD1331_SET_ROW_ADDR,
-        area->start_row,
-        area->end_row
+        r0,
+        r1
+    };
+
+    queue_cmd_list(dev, cmds, count_of(cmds));
+    dev->win.c0 = c0;
+    dev->win.c1 = c1;
+    dev->win.r0 = r0;
+    dev->win.r1 = r1;
+    // グループはメンバーへの送信で書き込み位置が変わるので覚えない
+    dev->win.valid = !dev->nmembers;
+}
+
+// 向きごとのREMAP_COLOR_DEPTHの桁とCOMの向き。0度 (0x72) は桁とCOMの両方を逆にしたもので、
+// 90/270度はRAMの桁 = 論理座標のy、RAMの行 = 論理座標のxになる
+static uint8_t orientation_remap(int orientation) {
+    static const uint8_t rotate[] = {
+        SSD1331_REMAP_COL_REVERSE | SSD1331_REMAP_COM_REVERSE,   // 0
+        SSD1331_REMAP_VERTICAL | SSD1331_REMAP_COM_REVERSE,      // 90
+        0,                                                       // 180
+        SSD1331_REMAP_VERTICAL | SSD1331_REMAP_COL_REVERSE,      // 270
     };
+    uint8_t remap = rotate[orientation & SSD1331_ROTATE_MASK];
+    bool transposed = remap & SSD1331_REMAP_VERTICAL;
+
+    // 左右の反転は論理座標のxを、上下の反転はyを逆にする
+    if (orientation & SSD1331_MIRROR_H)
+        remap ^= transposed ? SSD1331_REMAP_COM_REVERSE : SSD1331_REMAP_COL_REVERSE;
+    if (orientation & SSD1331_MIRROR_V)
+        remap ^= transposed ? SSD1331_REMAP_COL_REVERSE : SSD1331_REMAP_COM_REVERSE;
+    return remap;
+}
+
+void ssd1331_set_orientation(struct ssd1331 *dev, int orientation) {
+    // グループはメンバーにもグループの覚えているREMAPを送るので、メンバーだけの向きは
+    // 次のグループへの転送で元に戻ってしまう。メンバーに指定したらグループ全体の向きを変える
+    if (dev->group) {
+        ssd1331_set_orientation(dev->group, orientation);
+        return;
+    }
+
+    uint8_t remap = (dev->remap & ~SSD1331_REMAP_ORIENT_MASK) | orientation_remap(orientation);
+
+    // グループではメンバーも同じ向きになる
+    dev->orientation = orientation;
+    dev->remap = remap;
+    for (int i = 0; i < dev->nmembers; i++) {
+        dev->members[i]->orientation = orientation;
+        dev->members[i]->remap = remap;
+    }
 
-    send_cmd_list(cmds, count_of(cmds));
-    send_data(buf, area->buflen);
+    // 色数が不明なら65K色にする
+    wait_ready(dev);
+    if (!dev->depth)
+        dev->depth = 16;
+    queue_cmd(dev, SSD1331_REMAP_COLOR_DEPTH);
+    queue_cmd(dev, (remap & ~SSD1331_REMAP_DEPTH_MASK) | (dev->depth == 8 ? SSD1331_REMAP_256 : SSD1331_REMAP_65K));
+    // ウィンドウの桁と行の意味が変わる
+    dev->win.valid = false;
+    flush_cmds(dev);
 }
 
-static void set_pixel(uint16_t *buf, int x, int y, uint16_t color) {
-    assert(x >= 0 && x < SSD1331_WIDTH && y >=0 && y < SSD1331_HEIGHT);
+void ssd1331_invalidate(struct ssd1331 *dev) {
+    dev->win.valid = false;
+    dev->depth = 0;
+    dev->fill_state = -1;
+}
 
-    int idx = y * 96 + x;
-    buf[idx]   = color;
+void queue_cmd(struct ssd1331 *dev, uint8_t cmd) {
+    if (dev->cmdq.len == CMDQ_LEN)
+        flush_cmds(dev);
+    dev->cmdq.buf[dev->cmdq.len++] = cmd;
 }
 
-void reset(void) {
-    RESET_OFF;
-    CS_DESELECT;
-    sleep_ms(5);
-    RESET_ON;
-    sleep_ms(80);
-    RESET_OFF;
-    sleep_ms(20);
+void queue_cmd_list(struct ssd1331 *dev, const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        queue_cmd(dev, buf[i]);
 }
 
-static void draw_line(int16_t *buf, int x0, int y0, int x1, int y1, uint16_t color) {
-    assert(x0 >= 0 && x1 <= SSD1331_WIDTH - 1
-        && y0 >= 0 && y1 <= SSD1331_HEIGHT - 1);
+void flush_cmds(struct ssd1331 *dev) {
+    if (dev->cmdq.len == 0)
+        return;
 
-    int dx =  abs(x1 - x0);
-    int sx = x0 < x1 ? 1 : -1;
-    int dy = -abs(y1-y0);
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx + dy;
-    int e2;
+    bus_acquire(dev);
+    touch(dev);
+    cs_select(dev);
+    write_cmds(dev);
+    dc_data(dev);
+    cs_deselect(dev);
+    dev->bus->blocking = false;
+}
 
-    while (true) {
-        set_pixel(buf, x0, y0, color);
-        if (x0 == x1 && y0 == y1)
-            break;
-        e2 = 2 * err;
-
-        if (e2 >= dy) {
-            err += dy;
-            x0 += sx;
-        }
-        if (e2 <= dx) {
-            err += dx;
-            y0 += sy;
-        }
-    }
+void send_cmd(struct ssd1331 *dev, uint8_t cmd) {
+    queue_cmd(dev, cmd);
+    flush_cmds(dev);
 }
 
-static inline int get_font_index(uint8_t ch) {
-    if (ch >= 'A' && ch <='Z') {
-        return  ch - 'A' + 1;
-    }
-    else if (ch >= '0' && ch <='9') {
-        return  ch - '0' + 27;
+void send_cmd_list(struct ssd1331 *dev, uint8_t *buf, size_t len) {
+    queue_cmd_list(dev, buf, len);
+    flush_cmds(dev);
+}
+
+void send_data(struct ssd1331 *dev, uint16_t *buf, size_t len) {
+    // キューにコマンドが残っていれば同じトランザクションで先に送る
+    begin_data(dev, 16);
+    spi_write16(dev->bus, buf, len);
+    dev->win.written += len;
+    end_data(dev);
+}
+
+void send_data_rect(struct ssd1331 *dev, const uint16_t *buf, int stride, int width, int height) {
+    // 行ごとにデータを書き出すが、CS#は矩形全体で1回だけアサートする
+    begin_data(dev, 16);
+    for (int y = 0; y < height; y++)
+        spi_write16(dev->bus, buf + y * stride, width);
+    dev->win.written += width * height;
+    end_data(dev);
+}
+
+// 待ち行列の先頭の転送を始める: ウィンドウまでのコマンドはブロッキングで送り、
+// ピクセルデータはDMAで送る
+static void start_job(struct ssd1331_bus *bus, struct ssd1331_job *job) {
+    struct ssd1331 *dev = job->dev;
+
+    perf_flush_begin();
+    cs_select(dev);
+    write_cmd_bytes(dev, job->cmds, job->ncmds);
+    set_format(bus, job->bits);
+    if (job->command)
+        dc_command(dev);
+    else
+        dc_data(dev);
+
+    PERF_ADD(bytes, job->len * job->bits / 8);
+    if (job->bits == 8)
+        hal_dma_write8(bus, job->buf, job->len);
+    else
+        hal_dma_write16(bus, job->buf, job->len);
+}
+
+static void flush_done(struct ssd1331_bus *bus) {
+    struct ssd1331_job *job = &bus->jobs[bus->head];
+    struct ssd1331 *dev = job->dev;
+    render_done_cb_t cb = job->cb;
+    void *arg = job->arg;
+
+    // DMAが終わった時点ではまだ送信FIFOにデータが残っているので
+    // シフトアウトが終わるのを待ってからCS#を解除する
+    hal_spi_wait_idle(bus);
+    dc_command(dev);
+    cs_deselect(dev);
+    perf_flush_end();
+
+    bus->head = (bus->head + 1) % SSD1331_BUS_JOBS;
+    bus->count--;
+    dev->pending--;
+    // 次の転送があればすぐに始めてバスを空けない
+    if (bus->count) {
+        bus->owner = bus->jobs[bus->head].dev;
+        start_job(bus, &bus->jobs[bus->head]);
+    } else {
+        bus->owner = NULL;
     }
-    else if (ch == '.') {
-        return 37;
+
+    if (cb)
+        cb(arg);
+}
+
+// 待ち行列に入れる。一杯またはブロッキングの転送中ならfalseを返す (割り込みからも呼ぶので待たない)
+static bool push_job(struct ssd1331 *dev, const void *buf, size_t len, uint8_t bits, bool command,
+                     render_done_cb_t cb, void *arg) {
+    struct ssd1331_bus *bus = dev->bus;
+    uint32_t irq = hal_irq_save();
+
+    if (bus->count == SSD1331_BUS_JOBS || bus->blocking) {
+        hal_irq_restore(irq);
+        return false;
     }
-    else if (ch == ':') {
-        return 38;
+
+    struct ssd1331_job *job = &bus->jobs[(bus->head + bus->count) % SSD1331_BUS_JOBS];
+    job->dev = dev;
+    job->buf = buf;
+    job->len = len;
+    job->bits = bits;
+    job->command = command;
+    job->cb = cb;
+    job->arg = arg;
+    job->ncmds = 0;
+    // キューのコマンドは転送の順番が来たときに同じトランザクションで送る
+    if (!command) {
+        memcpy(job->cmds, dev->cmdq.buf, dev->cmdq.len);
+        job->ncmds = dev->cmdq.len;
+        dev->cmdq.len = 0;
     }
-    else return  0; // Not got that char so space.
+
+    dev->pending++;
+    bool idle = bus->count++ == 0;
+    if (idle)
+        bus->owner = dev;
+    hal_irq_restore(irq);
+
+    if (idle)
+        start_job(bus, job);
+    return true;
 }
 
-static void write_char(uint16_t *buf, int x, int y, uint8_t ch, uint16_t color) {
-    if (x > SSD1331_WIDTH - 8 || y > SSD1331_HEIGHT - 8)
-        return;
+// リセットの各段階の時間 (us)
+#define RESET_HIGH_US       5000
+#define RESET_LOW_US        80000
+#define RESET_SETTLE_US     20000
+// 待ち行列が一杯のときに初期化のコマンド列の送信をやり直すまでの時間 (us)
+#define INIT_RETRY_US       1000
+
+// 初期値のREMAP_COLOR_DEPTH (0x72: 65K色、SSD1331_ROTATE_0の向き)
+#define REMAP_DEFAULT       (SSD1331_REMAP_65K | SSD1331_REMAP_COM_SPLIT | SSD1331_REMAP_COM_REVERSE | SSD1331_REMAP_COL_REVERSE)
+
+// 初期化のコマンド列: Adafruit-SSD1331-OLED-Driver-Library-for-Arduinoから引用。
+// DMAで送るのでconstの配列に置く
+static const uint8_t init_cmds[] = {
+    SSD1331_SET_DISP_OFF,
+    SSD1331_SET_ROW_ADDR, 0x00, 0x3F,
+    SSD1331_SET_COL_ADDR, 0x00, 0x5F,
+    SSD1331_REMAP_COLOR_DEPTH, REMAP_DEFAULT,
+    SSD1331_SET_DISP_START_LINE, 0x00,
+    SSD1331_SET_DISP_OFFSET, 0x00,
+    SSD1331_SET_NORM_DISP,
+    SSD1331_SET_MUX_RATIO, 0x3F,
+    SSD1331_SET_MASTER_CONFIG, 0xBE,
+    SSD1331_POWER_SAVE, 0x0B,
+    SSD1331_ADJUST, 0x74,
+    SSD1331_DISP_CLOck, 0xF0,
+    SSD1331_SET_PRECHARGE_A, 0x64,
+    SSD1331_SET_PRECHARGE_B, 0x78,
+    SSD1331_SET_PRECHARGE_C, 0x64,
+    SSD1331_SET_PRECHARGE_LEVEL, 0x3A,
+    SSD1331_SET_VCOMH, 0x3E,
+    SSD1331_MASTER_CURRENT_CNTL, 0x06,
+    SSD1331_SET_CONTRAST_A, 0x91,
+    SSD1331_SET_CONTRAST_B, 0x50,
+    SSD1331_SET_CONTRAST_C, 0x7D,
+    SSD1331_SET_DISP_ON_NORM
+};
 
-    uint8_t b, c, p;
-
-    ch = toupper(ch);
-    int idx = get_font_index(ch);    // 文字のfont[]内の行数
-    for (int i = 0; i < 8; i++) {
-        c = font[idx*8+i];
-        p = 0x80;
-        for (int k = 0; k < 8; k++) {
-            b = (c & p);
-            p >>= 1;
-            set_pixel(buf, x + k, y + i, b ? color : COL_BLACK);
-        }
-    }
+static void set_ready(struct ssd1331 *dev) {
+    dev->state = SSD1331_STATE_READY;
+    if (dev->ready)
+        dev->ready(dev->ready_arg);
 }
 
-static void write_string(uint16_t *buf, int x, int y, char *str, uint16_t color) {
-    // Cull out any string off the screen
-    if (x > SSD1331_WIDTH - 8 || y > SSD1331_HEIGHT - 8)
-        return;
+// 初期化のコマンド列の転送が終わった (DMA割り込みのコンテキスト)
+static void init_done(void *arg) {
+    struct ssd1331 *dev = arg;
 
-    while (*str) {
-        write_char(buf, x, y, *str++, color);
-        x += 8;
+    // コマンド列で65K色になる
+    dev->depth = 16;
+    set_ready(dev);
+}
+
+// 初期化の各段階の待ち時間が過ぎた (アラーム割り込みのコンテキスト)
+static void alarm_fired(struct ssd1331 *dev) {
+    switch (dev->state) {
+    case SSD1331_STATE_RESET:
+        hal_gpio_put(dev->res_pin, false);
+        dev->state = SSD1331_STATE_RESET_LOW;
+        hal_alarm_in_us(dev, RESET_LOW_US);
+        break;
+    case SSD1331_STATE_RESET_LOW:
+        hal_gpio_put(dev->res_pin, true);
+        dev->state = SSD1331_STATE_SETTLE;
+        hal_alarm_in_us(dev, RESET_SETTLE_US);
+        break;
+    case SSD1331_STATE_SETTLE:
+        // バスが空いていなければ少し後でやり直す
+        dev->state = SSD1331_STATE_CONFIG;
+        if (!push_job(dev, init_cmds, sizeof(init_cmds), 8, true, init_done, dev)) {
+            dev->state = SSD1331_STATE_SETTLE;
+            hal_alarm_in_us(dev, INIT_RETRY_US);
+        }
+        break;
+    default:
+        break;
     }
 }
 
-#endif // ifdef spi_default
+void ssd1331_bus_init(struct ssd1331_bus *bus, uint spi, uint sck_pin, uint mosi_pin, uint freq) {
+    memset(bus, 0, sizeof(*bus));
+    bus->spi = spi;
+    bus->sck_pin = sck_pin;
+    bus->mosi_pin = mosi_pin;
+    bus->freq = freq;
+    bus->dma_chan = -1;
+
+    // SPIを初期化 (初期化直後は8bit)
+    hal_bus_init(bus);
+    bus->bits = 8;
+
+    // render_async()用のDMAチャネルを確保
+    hal_dma_init(bus, flush_done);
+    // ssd1331_init_async()の待ち時間
+    hal_alarm_init(alarm_fired);
+}
 
-int main() {
-    // stdioの初期化
-    stdio_init_all();
+void ssd1331_init_async(struct ssd1331 *dev, struct ssd1331_bus *bus, uint cs_pin, uint dc_pin, uint res_pin,
+                        int flags, render_done_cb_t ready, void *arg) {
+    memset(dev, 0, sizeof(*dev));
+    dev->bus = bus;
+    dev->cs_pin = cs_pin;
+    dev->dc_pin = dc_pin;
+    dev->res_pin = res_pin;
+    dev->remap = REMAP_DEFAULT;
+    dev->ready = ready;
+    dev->ready_arg = arg;
+    ssd1331_invalidate(dev);
+
+    // CS#, D/C#, RES#のピンはアクティブLOWなので、HIGH状態で初期化
+    hal_gpio_init(cs_pin, true);
+    hal_gpio_init(dc_pin, true);
+    hal_gpio_init(res_pin, true);
+
+    if (flags & SSD1331_INIT_WARM) {
+        // パネルの設定はそのまま使う。色数とウィンドウは不明なので最初の転送で設定し直す
+        set_ready(dev);
+        return;
+    }
 
-#if !defined(spi_default)
-#warning this example requires a board with spi pins
-    puts("Default SPI pins were not defined");
-#else
-    // ssd1331の初期化
-    ssd1331_init(10 * 1000 * 1000);
-    //printf("Hello, SSD1331\n");
+    // RES#をHIGHにしてからのリセットの手順はalarm_fired()で進める
+    dev->state = SSD1331_STATE_RESET;
+    hal_alarm_in_us(dev, RESET_HIGH_US);
+}
 
-    // 描画領域を初期化
-    struct render_area frame_area = {
-        start_col: 0,
-        end_col : SSD1331_WIDTH - 1,
-        start_row : 0,
-        end_row : SSD1331_HEIGHT - 1
-    };
+void ssd1331_init(struct ssd1331 *dev, struct ssd1331_bus *bus, uint cs_pin, uint dc_pin, uint res_pin) {
+    ssd1331_init_async(dev, bus, cs_pin, dc_pin, res_pin, 0, NULL, NULL);
+    ssd1331_wait_ready(dev);
+}
 
-    calc_render_area_buflen(&frame_area);
+bool ssd1331_ready(const struct ssd1331 *dev) {
+    for (int i = 0; i < dev->nmembers; i++)
+        if (dev->members[i]->state != SSD1331_STATE_READY)
+            return false;
+    return dev->state == SSD1331_STATE_READY;
+}
 
-    // 画面全体を黒で塗りつぶす
-    uint16_t buf[SSD1331_BUF_LEN];
-    memset(buf, 0, 2*SSD1331_BUF_LEN);
-    render(buf, &frame_area);
+void ssd1331_wait_ready(struct ssd1331 *dev) {
+    // 初期化のコマンド列の転送の完了はDMA割り込みで、それ以外はアラームで進む
+    while (!ssd1331_ready(dev)) {
+        if (dev->bus->count)
+            hal_dma_wait(dev->bus);
+        else
+            hal_idle();
+    }
+}
 
-/*
-    // 色定義の確認
-    static uint16_t colors[] = {
-         COL_WHITE, COL_RED, COL_GREEN, COL_BLUE,
-         COL_YELLOW, COL_MAGENTA, COL_AQUA, COL_PURPLE,
-         COL_REDPINK, COL_ORANGE, COL_LGRAY, COL_GRAY, COL_BLACK
-    };
+void ssd1331_init_group(struct ssd1331 *group, struct ssd1331 *const *members, int n) {
+    assert(n > 0 && n <= SSD1331_GROUP_MAX);
 
-    for (int i = 0; i < 13; i++) {
-        for (int j = 0; j < SSD1331_BUF_LEN; j++) {
-            buf[j] = color;
-            //buf[2*j] = (uint8_t)((colors[i] >> 8) & 0xff);
-            //buf[2*j+1] = (uint8_t)(colors[i] & 0xff);
-        }
-        render(buf, &frame_area);
-        sleep_ms(500);
+    memset(group, 0, sizeof(*group));
+    group->bus = members[0]->bus;
+    for (int i = 0; i < n; i++) {
+        assert(members[i]->bus == group->bus && !members[i]->nmembers);
+        group->members[i] = members[i];
+        members[i]->group = group;
     }
+    group->nmembers = n;
+    group->remap = members[0]->remap;
+    group->state = SSD1331_STATE_READY;
+    ssd1331_invalidate(group);
+}
 
-    // 画面を3回フラッシュ
-    for (int i = 0; i < 3; i++) {
-        send_cmd(SSD1331_SET_ALL_ON);
-        sleep_ms(500);
-        send_cmd(SSD1331_SET_ALL_OFF);
-        sleep_ms(500);
+void scroll(struct ssd1331 *dev, uint8_t h, uint8_t v, scroll_interval_t speed, bool on) {
+    // 90/270度では論理座標の水平方向がRAMの行になる
+    if (ssd1331_transposed(dev)) {
+        uint8_t t = h;
+        h = v;
+        v = t;
     }
-*/
 
-    // 画像を描画
-    struct render_area area = {
-        start_row : 0,
-        end_row : IMG_HEIGHT - 1
+    // 水平スクロールを構成
+    uint8_t cmds[] = {
+        SSD1331_SETUP_SCROL,
+        h, // 水平スクロールオフセット列数
+        0x00, // 開始行アドレス
+        0x40, // スクロールする行数
+        v, // 垂直スクロールオフセットの行数
+        (uint8_t)speed, // スクロールの時間間隔
+        on ? SSD1331_ACT_SCROL : SSD1331_DEACT_SCROL
     };
 
-restart:
+    send_cmd_list(dev, cmds, count_of(cmds));
+}
 
-    area.start_col = 0;
-    area.end_col = IMG_WIDTH - 1;
+void render(struct ssd1331 *dev, const uint16_t *buf, struct render_area *area) {
+    // render_areaでディスプレイの一部を更新: ウィンドウ設定とデータを1トランザクションで送る
+    queue_window(dev, area->start_col, area->end_col, area->start_row, area->end_row);
+    begin_data(dev, 16);
+    spi_write16(dev->bus, buf, area->buflen);
+    dev->win.written += area->buflen;
+    end_data(dev);
+}
 
-    calc_render_area_buflen(&area);
+void render332(struct ssd1331 *dev, const uint8_t *buf, struct render_area *area) {
+    queue_window(dev, area->start_col, area->end_col, area->start_row, area->end_row);
+    begin_data(dev, 8);
+    spi_write(dev->bus, buf, area->buflen);
+    dev->win.written += area->buflen;
+    end_data(dev);
+}
 
-    render(img, &area);
-    sleep_ms(1000);
-    render(buf, &frame_area);
+void render_begin(struct ssd1331 *dev, struct render_area *area) {
+    queue_window(dev, area->start_col, area->end_col, area->start_row, area->end_row);
+    begin_data(dev, 16);
+}
 
-    // フォント出力
-    char *text[] = {
-        "ABCDEFGHIJKL",
-        "MNOPQRSTUVwX",
-        "YZ0123456789"
-    };
+void render_write(struct ssd1331 *dev, const uint16_t *buf, size_t len) {
+    spi_write16(dev->bus, buf, len);
+    dev->win.written += len;
+}
+
+void render_end(struct ssd1331 *dev) {
+    end_data(dev);
+}
 
-    int y = 24;
-    for (int i = 0; i < count_of(text); i++) {
-        write_string(buf, 0, y, text[i], COL_WHITE);
-        y += 8;
+// areaがNULLならウィンドウを設定せず、前の転送の続きの位置からlenピクセルを書く
+static void queue_job(struct ssd1331 *dev, const void *buf, size_t len, uint8_t bits, struct render_area *area,
+                      render_done_cb_t cb, void *arg) {
+    // bufは転送が終わるまで (render_busy()がfalseになるまで) 変更してはならない
+    struct ssd1331_bus *bus = dev->bus;
+
+    wait_ready(dev);
+    touch(dev);
+    set_depth(dev, bits);
+    if (area) {
+        queue_window(dev, area->start_col, area->end_col, area->start_row, area->end_row);
+        window_written(dev, len);
     }
-    render(buf, &frame_area);
 
-    // 横スクロール
-    scroll(24, 0, SCROLL_HIGH, true);
-    sleep_ms(3000);
-    scroll(24, 0, SCROLL_HIGH, false);
+    // 待ち行列が一杯なら空くまで待つ
+    while (!push_job(dev, buf, len, bits, false, cb, arg))
+        hal_dma_wait(bus);
+}
 
-    // 反転表示
-    send_cmd(SSD1331_SET_INV_DISP);
-    sleep_ms(1000);
-    send_cmd(SSD1331_SET_NORM_DISP);
+void render_async(struct ssd1331 *dev, const uint16_t *buf, struct render_area *area, render_done_cb_t cb, void *arg) {
+    queue_job(dev, buf, area->buflen, 16, area, cb, arg);
+}
 
-    sleep_ms(1000);
-    render(buf, &frame_area);
+void render332_async(struct ssd1331 *dev, const uint8_t *buf, struct render_area *area, render_done_cb_t cb, void *arg) {
+    queue_job(dev, buf, area->buflen, 8, area, cb, arg);
+}
 
+// RGB332の矩形を256色モードで送る。CS#は矩形全体で1回だけアサートする
+static void send_rect332(struct ssd1331 *dev, const struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    int w = x1 - x0 + 1;
 
-    // ラインを描画
-    uint16_t color = COL_WHITE;
-    for (int i = 0; i < 2; i++) {
-        for (int x = 0; x < SSD1331_WIDTH; x++) {
-            draw_line(buf, x, 0,  SSD1331_WIDTH - 1 - x, SSD1331_HEIGHT - 1, color);
-            render(buf, &frame_area);
-        }
+    queue_window(dev, x0, x1, y0, y1);
+    begin_data(dev, 8);
+    for (int y = y0; y <= y1; y++)
+        spi_write(dev->bus, fb_irow(fb, y) + x0, w);
+    dev->win.written += w * (y1 - y0 + 1);
+    end_data(dev);
+}
+
+// パレットの番号のフレームバッファを展開する作業バッファ: 2行分を2つ交互に使う
+#define STAGE_LEN   (2 * SSD1331_WIDTH)
+static uint16_t stage[2][STAGE_LEN];
+
+// パレットの番号の矩形 (x0,y0)-(x1,y1) をRGB565に展開しながら送る。
+// 作業バッファに収まる行ずつ待ち行列に入れるので、一方の作業バッファを
+// DMAで送っている間にもう一方へ次の行を展開できる。ウィンドウは矩形全体に
+// 1回だけ設定し、2つ目からの転送はデータだけを送ってその続きに書く
+static void render_indexed(struct ssd1331 *dev, const struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    int w = x1 - x0 + 1;
+    int rows = STAGE_LEN / w;
+    int k = 0;
+    struct render_area area = {
+        start_col : x0,
+        end_col : x1,
+        start_row : y0,
+        end_row : y1
+    };
 
-        for (int y = SSD1331_HEIGHT - 1; y >= 0 ;y--) {
-            draw_line(buf, 0, y, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1 - y, color);
-            render(buf, &frame_area);
+    calc_render_area_buflen(&area);
+    for (int y = y0; y <= y1; y += rows, k ^= 1) {
+        int n = MIN(rows, y1 - y + 1);
+
+        // 同じ作業バッファを使った2つ前の転送が終わるまで待つ
+        render_wait_queued(dev, 1);
+        for (int i = 0; i < n; i++)
+            fb_expand_row(fb, x0, y + i, w, stage[k] + i * w);
+        queue_job(dev, stage[k], n * w, 16, y == y0 ? &area : NULL, NULL, NULL);
+    }
+}
+
+void render_transposed(struct ssd1331 *dev, const struct framebuffer *fb, int x0, int y0, int x1, int y1) {
+    uint16_t col[SSD1331_HEIGHT];
+    int h = y1 - y0 + 1;
+
+    assert(ssd1331_transposed(dev));
+    // 論理座標の桁がフレームバッファの行、論理座標の行がフレームバッファの列になる
+    queue_window(dev, y0, y1, x0, x1);
+    begin_data(dev, 16);
+    for (int x = x0; x <= x1; x++) {
+        fb_expand_col(fb, x, y0, h, col);
+        spi_write16(dev->bus, col, h);
+    }
+    dev->win.written += h * (x1 - x0 + 1);
+    end_data(dev);
+}
+
+void render_dirty(struct ssd1331 *dev, struct framebuffer *fb) {
+    struct damage *d = fb->damage;
+    struct render_area area;
+
+    if (ssd1331_transposed(dev)) {
+        // 90/270度: どの形式も矩形ごとに列の順に読んでRGB565で送る
+        if (!d || damage_use_full(d)) {
+            render_transposed(dev, fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+        } else {
+            for (int i = 0; i < d->count; i++) {
+                struct damage_rect *r = &d->rects[i];
+                render_transposed(dev, fb, r->x0, r->y0, r->x1, r->y1);
+            }
+        }
+    } else if (fb->format == FB_RGB332) {
+        if (!d || damage_use_full(d)) {
+            send_rect332(dev, fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+        } else {
+            for (int i = 0; i < d->count; i++) {
+                struct damage_rect *r = &d->rects[i];
+                send_rect332(dev, fb, r->x0, r->y0, r->x1, r->y1);
+            }
+        }
+    } else if (fb->format != FB_RGB565) {
+        if (!d || damage_use_full(d)) {
+            render_indexed(dev, fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1);
+        } else {
+            for (int i = 0; i < d->count; i++) {
+                struct damage_rect *r = &d->rects[i];
+                render_indexed(dev, fb, r->x0, r->y0, r->x1, r->y1);
+            }
+        }
+        // 作業バッファは全てのパネルで共用するので送り終わるまで待つ
+        render_wait(dev);
+    } else if (!d || damage_use_full(d)) {
+        area.start_col = 0;
+        area.end_col = SSD1331_WIDTH - 1;
+        area.start_row = 0;
+        area.end_row = SSD1331_HEIGHT - 1;
+        calc_render_area_buflen(&area);
+        render(dev, fb->buf, &area);
+    } else {
+        // 変更された矩形ごとにウィンドウを設定してデータを送る
+        for (int i = 0; i < d->count; i++) {
+            struct damage_rect *r = &d->rects[i];
+
+            queue_window(dev, r->x0, r->x1, r->y0, r->y1);
+            send_data_rect(dev, fb->buf + r->y0 * SSD1331_WIDTH + r->x0, SSD1331_WIDTH,
+                           r->x1 - r->x0 + 1, r->y1 - r->y0 + 1);
         }
-        color = COL_BLACK;
     }
 
-    goto restart;
-/*
+    if (d)
+        damage_clear(d);
+}
 
-   //
-    char *text[3][12];  // 8行12桁
-    sprintf(text[0], "P: %7.2f", 1007.41);
-    sprintf(text[1], "T: %5.2f", 25.91);
-    sprintf(text[2], "H: %5.2f", 30.04);
+bool render_busy(struct ssd1331 *dev) {
+    return dev->pending != 0;
+}
 
-    int y = 8;
-    for (int i = 0; i < count_of(text); i++) {
-        write_string(buf, 0, y, text[i], COL_WHITE);
-        y += 10;
-    }
-    render(buf, &frame_area);
-*/
+void render_wait(struct ssd1331 *dev) {
+    render_wait_queued(dev, 0);
+}
+
+void render_wait_queued(struct ssd1331 *dev, int max) {
+    // CS#の解除、完了コールバックと次の転送の開始は割り込みハンドラで行われる
+    while (dev->pending > max)
+        hal_dma_wait(dev->bus);
+}
 
-#endif
+void bus_wait(struct ssd1331_bus *bus) {
+    while (bus->count)
+        hal_dma_wait(bus);
+}
 
-    return 0;
+void reset(struct ssd1331 *dev) {
+    bus_wait(dev->bus);
+    FOR_PINS(dev, res_pin, true);
+    cs_deselect(dev);
+    hal_sleep_us(RESET_HIGH_US);
+    FOR_PINS(dev, res_pin, false);
+    hal_sleep_us(RESET_LOW_US);
+    FOR_PINS(dev, res_pin, true);
+    hal_sleep_us(RESET_SETTLE_US);
+    ssd1331_invalidate(dev);
+    touch(dev);
 }
@@ -4,13 +4,14 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#ifndef SSD1331_H
+#define SSD1331_H
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
-#include "pico/stdlib.h"
-#include "pico/binary_info.h"
-#include "hardware/spi.h"
+#include "ssd1331_hal.h"
 
 /* SPI経由で96x64 16bit-Color OLEDディスプレイを駆動するSSD1331を
    操作するサンプルコード
@@ -23,7 +24,8 @@
    * 3.3V OUT (pin 36) -> SSD1331ボードのVCC
    * GND (pin 38)  -> SSD1331ボードのGND
 
-   spi_default (SPI0) インスタンスを使用する。
+   既定ではspi_default (SPI0) インスタンスとこの配線を使う。パネルを複数つなぐ場合は
+   ssd1331_init()にパネルごとのCS#, D/C#, RES#のピンを渡す (SCKとMOSIは共有する)。
 */
 #define SPI_SCK_PIN         PICO_DEFAULT_SPI_SCK_PIN
 #define SPI_MOSI_PIN        PICO_DEFAULT_SPI_TX_PIN
@@ -57,6 +59,31 @@
 #define COL_FRONT   COL_WHITE
 #define COL_BACK   	COL_BLACK
 
+// 256色モードの色 (RGB332): 赤3bit, 緑3bit, 青2bit
+#define RGB332(r,g,b)   (uint8_t)(((r) & 0xe0) | (((g) >> 3) & 0x1c) | ((b) >> 6))
+
+#define COL332_BLACK    RGB332(0,0,0)
+#define COL332_WHITE    RGB332(255,255,255)
+#define COL332_RED      RGB332(255,0,0)
+#define COL332_GREEN    RGB332(0,255,0)
+#define COL332_BLUE     RGB332(0,0,255)
+#define COL332_YELLOW   RGB332(255,255,0)
+#define COL332_MAGENTA  RGB332(255,0,255)
+#define COL332_AQUA     RGB332(0,255,255)
+#define COL332_ORANGE   RGB332(255,165,0)
+#define COL332_GRAY     RGB332(128,128,128)
+
+// RGB565の各成分の上位ビットを取り出す
+static inline uint8_t rgb565_to_332(uint16_t c) {
+    return ((c >> 8) & 0xe0) | ((c >> 6) & 0x1c) | ((c >> 3) & 0x03);
+}
+
+// 各成分の上位ビットを下位に繰り返して広げる (パネルが256色のデータを広げるのと同じ)
+static inline uint16_t rgb332_to_565(uint8_t c) {
+    int r = c >> 5, g = (c >> 2) & 7, b = c & 3;
+    return ((r << 2) | (r >> 1)) << 11 | ((g << 3) | g) << 5 | ((b << 3) | (b << 1) | (b >> 1));
+}
+
 // 基本コマンド
 #define SSD1331_SET_COL_ADDR        _u(0x15)    // 桁アドレスの設定: 0x00/0x5F
 #define SSD1331_SET_ROW_ADDR        _u(0x75)    // 行アドレスの設定: 0x00/0x3F
@@ -90,6 +117,44 @@
 #define SSD1331_SET_VCOMH           _u(0xBE)    // Vcomhの設定: 0x3E
 #define SSD1331_SET_COMND_LOCK      _u(0xFD)    // コマンドロックの設定: 0x12
 
+// REMAP_COLOR_DEPTHのbit7:6: 色数
+#define SSD1331_REMAP_256           _u(0x00)    // 256色: 1ピクセル1バイト (RGB332)
+#define SSD1331_REMAP_65K           _u(0x40)    // 65K色: 1ピクセル2バイト (RGB565)
+#define SSD1331_REMAP_DEPTH_MASK    _u(0xC0)
+// REMAP_COLOR_DEPTHのbit5:0: アドレスと走査の向き
+#define SSD1331_REMAP_VERTICAL      _u(0x01)    // 垂直アドレス増加 (ウィンドウを列ごとに埋める)
+#define SSD1331_REMAP_COL_REVERSE   _u(0x02)    // RAMの桁0をSEG95に出す
+#define SSD1331_REMAP_BGR           _u(0x04)
+#define SSD1331_REMAP_COM_SWAP      _u(0x08)
+#define SSD1331_REMAP_COM_REVERSE   _u(0x10)    // COM63からCOM0の順に走査する
+#define SSD1331_REMAP_COM_SPLIT     _u(0x20)    // 奇数と偶数のCOMを分ける
+#define SSD1331_REMAP_ORIENT_MASK   (SSD1331_REMAP_VERTICAL | SSD1331_REMAP_COL_REVERSE | SSD1331_REMAP_COM_REVERSE)
+
+/* 表示の向き (ssd1331_set_orientation())
+
+   回転 (時計回り) に左右、上下の反転を組み合わせる。どれもREMAP_COLOR_DEPTHの
+   桁とCOMの向きだけで行い、RAMの座標はそのまま論理座標として使うので、
+   ウィンドウ、スクロール、アクセラレータのコマンドはどの向きでも同じ座標で描ける。
+
+   90度と270度では論理座標の画面は64x96になる。ウィンドウの桁と行を入れ替えて
+   垂直アドレス増加で書き込むので、論理座標の1行がRAMの1列になり、
+   パネルが転置する (ピクセルを並べ替えない)。
+
+   96x64のフレームバッファ (とディスプレイリスト、パイプライン、スプライトの合成) は
+   90度と270度では64x96の画面を転置して持つ: 論理座標の (x, y) がフレームバッファの
+   (y, x) になる。render_transposed()が桁と行を入れ替えたウィンドウへフレームバッファを
+   列の順に読んで送るので、フレームバッファの (x, y) はどの向きでもRAMの (x, y) に置かれる。
+   図形はx座標とy座標を入れ替えて描けばよい。コンソールと文字セルは論理座標の
+   画面 (8桁12行) に合わせて文字を置く。
+*/
+#define SSD1331_ROTATE_0            0x00
+#define SSD1331_ROTATE_90           0x01
+#define SSD1331_ROTATE_180          0x02
+#define SSD1331_ROTATE_270          0x03
+#define SSD1331_ROTATE_MASK         0x03
+#define SSD1331_MIRROR_H            0x04    // 回転した後の画面を左右反転する
+#define SSD1331_MIRROR_V            0x08    // 回転した後の画面を上下反転する
+
 // 描画コマンド
 #define SSD1331_DRAW_LINE          _u(0x21)     // ラインの描画: 7バイト
 #define SSD1331_DRAW_RECT          _u(0x22)     // 矩形の描画: 10バイト
@@ -110,24 +175,199 @@ struct render_area {
     int buflen;
 };
 
+// 非同期レンダリングの完了コールバック: DMA割り込みのコンテキストで呼ばれる
+typedef void (*render_done_cb_t)(void *arg);
+
+struct framebuffer;
+
 typedef enum scroll_interval {
     SCROLL_ULTRA_HIGH, SCROLL_HIGH, SCROLL_MEDIUM, SCROLL_LOW
 } scroll_interval_t;
 
-#define CS_SELECT       gpio_put(SPI_CSN_PIN, 0)
-#define CS_DESELECT     gpio_put(SPI_CSN_PIN, 1)
-#define DC_COMMAND      gpio_put(SPI_DCN_PIN, 0)
-#define DC_DATA         gpio_put(SPI_DCN_PIN, 1)
-#define RESET_ON        gpio_put(SPI_RESN_PIN, 0)
-#define RESET_OFF       gpio_put(SPI_RESN_PIN, 1)
+// コマンドキューの長さ: これを超えると途中で送信される
+#define CMDQ_LEN        64
+
+// バスごとの非同期転送の待ち行列の長さ: あふれるとrender_async()は空くまで待つ
+#define SSD1331_BUS_JOBS    8
+
+// ブロードキャスト用のグループにまとめられるパネルの数
+#define SSD1331_GROUP_MAX   4
+
+struct ssd1331;
+
+// render_async()の1回分の転送: ウィンドウまでのコマンドとピクセルデータ
+struct ssd1331_job {
+    struct ssd1331 *dev;
+    const void *buf;
+    size_t len;                 // ピクセル数
+    uint8_t bits;               // 1ピクセルのビット数 (16: RGB565, 8: RGB332)
+    render_done_cb_t cb;
+    void *arg;
+    bool command;               // bufをコマンドとして送る (初期化のコマンド列)
+    uint8_t cmds[CMDQ_LEN];
+    uint8_t ncmds;
+};
+
+/* SPIバス: 複数のパネルでSCKとMOSIを共有する
+
+   render_async()の転送はバスの待ち行列に入り、前の転送のDMAが終わると
+   割り込みの中で次の転送が始まる。複数のパネルへの転送を依頼順に
+   CPUを待たせずに続けて送れる。ブロッキングの転送は待ち行列が空になってから送る。
+*/
+struct ssd1331_bus {
+    uint8_t spi;                // SPIインスタンスの番号 (0: spi0, 1: spi1)
+    uint8_t sck_pin;
+    uint8_t mosi_pin;
+    uint freq;
+    unsigned int bits;          // 現在のSPIフォーマットのビット数
+    int dma_chan;
+
+    struct ssd1331 *volatile owner;     // DMA転送中のパネル (NULL: 空き)
+    volatile bool blocking;     // ブロッキングの転送中 (割り込みから転送を始めない)
+    struct ssd1331_job jobs[SSD1331_BUS_JOBS];
+    uint8_t head;
+    volatile uint8_t count;
+};
 
+/* 初期化の状態
+
+   ssd1331_init_async()はピンを設定するだけで戻り、リセットのパルスと待ち時間は
+   アラームの割り込みで進める。リセットが終わると初期化のコマンド列 (43バイト) を
+   バスの待ち行列に入れて1回のトランザクションでDMAで送り、終わるとREADYになる。
+   READYになる前にパネルへ送ろうとした描画関数は、READYになるまで待つ。
+*/
+typedef enum ssd1331_state {
+    SSD1331_STATE_RESET,        // RES#をHIGHにして待っている
+    SSD1331_STATE_RESET_LOW,    // RES#をLOWにして待っている
+    SSD1331_STATE_SETTLE,       // リセットを解除して安定するのを待っている
+    SSD1331_STATE_CONFIG,       // 初期化のコマンド列を送っている
+    SSD1331_STATE_READY
+} ssd1331_state_t;
+
+// ssd1331_init_async()のflags: パネルは電源が入ったまま設定済み (MCUだけの再起動)
+// なので、リセットと初期化のコマンドを省く
+#define SSD1331_INIT_WARM   0x01
+
+/* パネル: CS#, D/C#, RES#のピンとパネルごとの状態
+
+   membersを持つものはグループで、すべてのメンバーのCS#を同時にアサートして
+   同じコマンドとデータを送る (ブロードキャスト)。メンバーは同じバスにあり、
+   D/C#を共有しているか、別々のD/C#をすべて同じレベルに駆動できる配線であること。
+*/
+struct ssd1331 {
+    struct ssd1331_bus *bus;
+    uint8_t cs_pin;
+    uint8_t dc_pin;
+    uint8_t res_pin;
+
+    struct ssd1331 *members[SSD1331_GROUP_MAX];
+    uint8_t nmembers;           // 0ならグループではない
+    struct ssd1331 *group;      // 属しているグループ
+
+    // コマンドキュー: 連続するコマンドバイトをためて1回のCS#アサートでまとめて送る
+    struct {
+        uint8_t buf[CMDQ_LEN];
+        size_t len;
+    } cmdq;
+
+    // 最後に設定したウィンドウ。書き込み位置が先頭に戻っている間 (ウィンドウの
+    // ピクセル数の倍数を書いた後) は同じウィンドウの設定を省く
+    struct {
+        uint8_t c0, c1, r0, r1;
+        bool valid;
+        uint32_t written;       // render_begin()から書いたピクセル数
+    } win;
+
+    volatile uint8_t pending;   // 待ち行列にある、または転送中のrender_async()の数
+
+    volatile uint8_t state;     // ssd1331_state_t (グループは常にREADYでメンバーを見る)
+    render_done_cb_t ready;     // READYになったときに割り込みのコンテキストで呼ぶ
+    void *ready_arg;
+
+    // REMAP_COLOR_DEPTHの設定。色数 (bit7:6) はデータを送るときに
+    // depthに合わせて切り替える
+    uint8_t remap;
+    uint8_t depth;              // パネルの現在の色数 (16: 65K色, 8: 256色, 0: 不明)
+    uint8_t orientation;        // SSD1331_ROTATE_*とSSD1331_MIRROR_*
+
+    // アクセラレータの状態 (accel.c)
+    int8_t fill_state;          // 現在のFILLの設定 (-1: 未設定)
+    uint8_t accel_mode;
+};
+
+// 上の既定の配線で使うSPIインスタンス (spi_default)
+#define SPI_INSTANCE        0
+
+// areaのピクセル数をbuflenに設定する
 void calc_render_area_buflen(struct render_area *area);
-void send_cmd(uint8_t cmd);
-void send_cmd_list(uint8_t *buf, size_t len);
-void send_data(uint16_t *buf, size_t len);
-void scroll(uint8_t h, uint8_t v, scroll_interval_t speed, bool on);
-void render(uint16_t *buf, struct render_area *area);
-void reset();
-//void clear(uint16_t color);
-
-void ssd1331_init(uint freq);
+
+// 90度か270度に回転していて、論理座標の桁と行がRAMの行と桁になっているか
+static inline bool ssd1331_transposed(const struct ssd1331 *dev) {
+    return dev->remap & SSD1331_REMAP_VERTICAL;
+}
+
+// 論理座標の画面の幅と高さ
+static inline int ssd1331_width(const struct ssd1331 *dev) {
+    return ssd1331_transposed(dev) ? SSD1331_HEIGHT : SSD1331_WIDTH;
+}
+
+static inline int ssd1331_height(const struct ssd1331 *dev) {
+    return ssd1331_transposed(dev) ? SSD1331_WIDTH : SSD1331_HEIGHT;
+}
+
+// SPIインスタンスspiのバスをfreq Hzで初期化する
+void ssd1331_bus_init(struct ssd1331_bus *bus, uint spi, uint sck_pin, uint mosi_pin, uint freq);
+// busにつながったパネルをリセットして初期化する (終わるまで待つ)
+void ssd1331_init(struct ssd1331 *dev, struct ssd1331_bus *bus, uint cs_pin, uint dc_pin, uint res_pin);
+// 待たずに初期化を始める。終わるとready(arg)を呼ぶ (NULLでもよい)。
+// SSD1331_INIT_WARMではすぐにREADYになり、戻る前にreadyを呼ぶ
+void ssd1331_init_async(struct ssd1331 *dev, struct ssd1331_bus *bus, uint cs_pin, uint dc_pin, uint res_pin,
+                        int flags, render_done_cb_t ready, void *arg);
+// パネル (グループではすべてのメンバー) の初期化が終わっているか
+bool ssd1331_ready(const struct ssd1331 *dev);
+void ssd1331_wait_ready(struct ssd1331 *dev);
+// 初期化済みのパネルをまとめてブロードキャスト用のグループにする
+void ssd1331_init_group(struct ssd1331 *group, struct ssd1331 *const *members, int n);
+// 表示の向きを変える (すぐにREMAP_COLOR_DEPTHを送る)。パネルのRAMの内容はそのまま新しい向きで表示される。
+// グループのメンバーはグループと同じ向きになる (メンバーに指定するとグループのすべてのパネルが変わる)。
+// 90度と270度でのフレームバッファなどの扱いは上の「表示の向き」を参照
+void ssd1331_set_orientation(struct ssd1331 *dev, int orientation);
+// ドライバが覚えているウィンドウ、色数とアクセラレータの設定を捨てる。
+// queue_cmd()でウィンドウなどを直接設定したときに呼ぶ
+void ssd1331_invalidate(struct ssd1331 *dev);
+
+void queue_cmd(struct ssd1331 *dev, uint8_t cmd);
+void queue_cmd_list(struct ssd1331 *dev, const uint8_t *buf, size_t len);
+void flush_cmds(struct ssd1331 *dev);
+void send_cmd(struct ssd1331 *dev, uint8_t cmd);
+void send_cmd_list(struct ssd1331 *dev, uint8_t *buf, size_t len);
+void send_data(struct ssd1331 *dev, uint16_t *buf, size_t len);
+void send_data_rect(struct ssd1331 *dev, const uint16_t *buf, int stride, int width, int height);
+void scroll(struct ssd1331 *dev, uint8_t h, uint8_t v, scroll_interval_t speed, bool on);
+void render(struct ssd1331 *dev, const uint16_t *buf, struct render_area *area);
+// ウィンドウを設定し、データを何回かに分けて1回のトランザクションで送る
+void render_begin(struct ssd1331 *dev, struct render_area *area);
+void render_write(struct ssd1331 *dev, const uint16_t *buf, size_t len);
+void render_end(struct ssd1331 *dev);
+// バスの待ち行列に入れて、順番が来たらDMAで送る
+void render_async(struct ssd1331 *dev, const uint16_t *buf, struct render_area *area, render_done_cb_t cb, void *arg);
+// RGB332のデータを256色モードで送る。パネルの色数は必要なときだけ切り替える
+// (RGB565を送る関数は65K色モードに戻す)。GDDRAMの既存の内容はそのまま残る
+void render332(struct ssd1331 *dev, const uint8_t *buf, struct render_area *area);
+void render332_async(struct ssd1331 *dev, const uint8_t *buf, struct render_area *area, render_done_cb_t cb, void *arg);
+// fbの変更された領域を送る。RGB332のfbは256色モードで、パレットの番号のfbは
+// RGB565に展開しながら送る
+void render_dirty(struct ssd1331 *dev, struct framebuffer *fb);
+// 90/270度の画面へfbの矩形 (x0,y0)-(x1,y1) を送る。論理座標の桁と行を入れ替えたウィンドウ
+// (RAMでは同じ矩形) へ1列ずつRGB565にして、1回のトランザクションで送る
+void render_transposed(struct ssd1331 *dev, const struct framebuffer *fb, int x0, int y0, int x1, int y1);
+// devへのrender_async()が残っているか
+bool render_busy(struct ssd1331 *dev);
+void render_wait(struct ssd1331 *dev);
+// devへのrender_async()の残りがmax個以下になるまで待つ (古いものから順に終わる)
+void render_wait_queued(struct ssd1331 *dev, int max);
+// バスの待ち行列が空になり、DMA転送が終わるまで待つ
+void bus_wait(struct ssd1331_bus *bus);
+void reset(struct ssd1331 *dev);
+
+#endif // SSD1331_H
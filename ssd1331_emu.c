@@ -0,0 +1,473 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1331.h"
+#include "ssd1331_emu.h"
+
+#define CMD_ARGS_MAX    32      // SET_GRAY_SCALEの引数
+
+static struct emu_panel {
+    uint16_t ram[EMU_HEIGHT][EMU_WIDTH];
+
+    // ウィンドウと書き込み位置
+    uint8_t c0, c1, r0, r1;
+    uint8_t col, row;
+
+    uint8_t remap;              // REMAP_COLOR_DEPTHの値
+    uint8_t start_line;
+    uint8_t offset;
+    uint8_t mode;               // SET_NORM_DISP, SET_ALL_ON, SET_ALL_OFF, SET_INV_DISP
+    bool on;
+    bool fill;
+    bool reverse_copy;
+
+    struct {
+        uint8_t h;
+        uint8_t top;
+        uint8_t rows;
+        uint8_t v;
+        bool active;
+    } scroll;
+
+    // 解釈中のコマンド
+    uint8_t cmd;
+    uint8_t args[CMD_ARGS_MAX];
+    int nargs;                  // 必要な引数の数
+    int got;                    // 受け取った引数の数 (nargs未満なら引数待ち)
+
+    // 組み立て中のピクセル
+    uint8_t pix[3];
+    int npix;
+
+    bool cs;
+    struct emu_stats stats;
+} panels[EMU_PANELS];
+
+// 以下の関数が操作するパネル
+static struct emu_panel *emu = &panels[0];
+
+// コマンドの引数の数。未知のコマンドは-1
+static int cmd_args(uint8_t cmd) {
+    switch (cmd) {
+    case SSD1331_SET_COL_ADDR:
+    case SSD1331_SET_ROW_ADDR:
+        return 2;
+    case SSD1331_SET_CONTRAST_A:
+    case SSD1331_SET_CONTRAST_B:
+    case SSD1331_SET_CONTRAST_C:
+    case SSD1331_MASTER_CURRENT_CNTL:
+    case SSD1331_SET_PRECHARGE_A:
+    case SSD1331_SET_PRECHARGE_B:
+    case SSD1331_SET_PRECHARGE_C:
+    case SSD1331_REMAP_COLOR_DEPTH:
+    case SSD1331_SET_DISP_START_LINE:
+    case SSD1331_SET_DISP_OFFSET:
+    case SSD1331_SET_MUX_RATIO:
+    case SSD1331_SET_MASTER_CONFIG:
+    case SSD1331_POWER_SAVE:
+    case SSD1331_ADJUST:
+    case SSD1331_DISP_CLOck:
+    case SSD1331_SET_PRECHARGE_LEVEL:
+    case SSD1331_SET_VCOMH:
+    case SSD1331_SET_COMND_LOCK:
+    case SSD1331_FILL:
+        return 1;
+    case SSD1331_SET_DIM:
+        return 5;
+    case SSD1331_SET_GRAY_SCALE:
+        return 32;
+    case SSD1331_DRAW_LINE:
+        return 7;
+    case SSD1331_DRAW_RECT:
+        return 10;
+    case SSD1331_COPY:
+        return 6;
+    case SSD1331_DIM_WIN:
+    case SSD1331_CLEAR_WIN:
+        return 4;
+    case SSD1331_SETUP_SCROL:
+        return 5;
+    case SSD1331_SET_NORM_DISP:
+    case SSD1331_SET_ALL_ON:
+    case SSD1331_SET_ALL_OFF:
+    case SSD1331_SET_INV_DISP:
+    case SSD1331_SET_DISP_ON_DIM:
+    case SSD1331_SET_DISP_OFF:
+    case SSD1331_SET_DISP_ON_NORM:
+    case SSD1331_EN_LINEAR_SCALE:
+    case SSD1331_NOP:
+    case 0xBD:
+    case 0xE3:
+    case SSD1331_DEACT_SCROL:
+    case SSD1331_ACT_SCROL:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+void emu_reset(void) {
+    memset(emu, 0, sizeof(*emu));
+    emu->c1 = EMU_WIDTH - 1;
+    emu->r1 = EMU_HEIGHT - 1;
+    emu->remap = 0x40;
+    emu->mode = SSD1331_SET_NORM_DISP;
+}
+
+int emu_select(int panel) {
+    int prev = emu - panels;
+
+    assert(panel >= 0 && panel < EMU_PANELS);
+    emu = &panels[panel];
+    return prev;
+}
+
+void emu_cs(bool select) {
+    if (select && !emu->cs)
+        emu->stats.transactions++;
+    emu->cs = select;
+}
+
+static inline int clamp_col(int c) {
+    return MIN(c, EMU_WIDTH - 1);
+}
+
+static inline int clamp_row(int r) {
+    return MIN(r, EMU_HEIGHT - 1);
+}
+
+// アクセラレータの色 (各6bit) をRGB565にする
+static inline uint16_t accel_color(const uint8_t *c) {
+    return ((c[0] & 0x3f) >> 1) << 11 | (c[1] & 0x3f) << 5 | (c[2] & 0x3f) >> 1;
+}
+
+static inline void put(int col, int row, uint16_t c) {
+    if ((unsigned)col < EMU_WIDTH && (unsigned)row < EMU_HEIGHT)
+        emu->ram[row][col] = c;
+}
+
+static void draw_line(int x0, int y0, int x1, int y1, uint16_t c) {
+    int dx = abs(x1 - x0);
+    int sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0);
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (true) {
+        put(x0, y0, c);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+// 引数の矩形を正規化してGDDRAMの範囲に収める
+static void arg_rect(const uint8_t *a, int *c0, int *r0, int *c1, int *r1) {
+    *c0 = clamp_col(MIN(a[0], a[2]));
+    *c1 = clamp_col(MAX(a[0], a[2]));
+    *r0 = clamp_row(MIN(a[1], a[3]));
+    *r1 = clamp_row(MAX(a[1], a[3]));
+}
+
+static void run_accel(uint8_t cmd, const uint8_t *a) {
+    int c0, r0, c1, r1;
+
+    emu->stats.accel_cmds++;
+    switch (cmd) {
+    case SSD1331_DRAW_LINE:
+        draw_line(clamp_col(a[0]), clamp_row(a[1]), clamp_col(a[2]), clamp_row(a[3]), accel_color(a + 4));
+        break;
+    case SSD1331_DRAW_RECT: {
+        uint16_t line = accel_color(a + 4);
+        arg_rect(a, &c0, &r0, &c1, &r1);
+        if (emu->fill) {
+            uint16_t fill = accel_color(a + 7);
+            for (int r = r0; r <= r1; r++)
+                for (int c = c0; c <= c1; c++)
+                    emu->ram[r][c] = fill;
+        }
+        draw_line(c0, r0, c1, r0, line);
+        draw_line(c0, r1, c1, r1, line);
+        draw_line(c0, r0, c0, r1, line);
+        draw_line(c1, r0, c1, r1, line);
+        break;
+    }
+    case SSD1331_COPY: {
+        // 重なりを扱うため元の内容を写してからコピーする
+        static uint16_t src[EMU_HEIGHT][EMU_WIDTH];
+        memcpy(src, emu->ram, sizeof(src));
+        arg_rect(a, &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++) {
+                uint16_t v = src[r][c];
+                put(a[4] + c - c0, a[5] + r - r0, emu->reverse_copy ? ~v : v);
+            }
+        break;
+    }
+    case SSD1331_DIM_WIN:
+        // 各成分を1/4にする
+        arg_rect(a, &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++) {
+                uint16_t v = emu->ram[r][c];
+                emu->ram[r][c] = ((v >> 13) << 11) | (((v >> 7) & 0x0f) << 5) | ((v & 0x1f) >> 2);
+            }
+        break;
+    case SSD1331_CLEAR_WIN:
+        arg_rect(a, &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                emu->ram[r][c] = 0;
+        break;
+    }
+}
+
+static void run_cmd(uint8_t cmd, const uint8_t *a) {
+    switch (cmd) {
+    case SSD1331_SET_COL_ADDR:
+        emu->c0 = clamp_col(a[0]);
+        emu->c1 = clamp_col(a[1]);
+        emu->col = emu->c0;
+        emu->npix = 0;
+        break;
+    case SSD1331_SET_ROW_ADDR:
+        emu->r0 = clamp_row(a[0]);
+        emu->r1 = clamp_row(a[1]);
+        emu->row = emu->r0;
+        emu->npix = 0;
+        break;
+    case SSD1331_REMAP_COLOR_DEPTH:
+        emu->remap = a[0];
+        emu->npix = 0;
+        break;
+    case SSD1331_SET_DISP_START_LINE:
+        emu->start_line = a[0] & 0x3f;
+        break;
+    case SSD1331_SET_DISP_OFFSET:
+        emu->offset = a[0] & 0x3f;
+        break;
+    case SSD1331_SET_NORM_DISP:
+    case SSD1331_SET_ALL_ON:
+    case SSD1331_SET_ALL_OFF:
+    case SSD1331_SET_INV_DISP:
+        emu->mode = cmd;
+        break;
+    case SSD1331_SET_DISP_OFF:
+        emu->on = false;
+        break;
+    case SSD1331_SET_DISP_ON_NORM:
+    case SSD1331_SET_DISP_ON_DIM:
+        emu->on = true;
+        break;
+    case SSD1331_FILL:
+        emu->fill = a[0] & 0x01;
+        emu->reverse_copy = a[0] & 0x10;
+        break;
+    case SSD1331_SETUP_SCROL:
+        emu->scroll.h = a[0];
+        emu->scroll.top = a[1];
+        emu->scroll.rows = a[2];
+        emu->scroll.v = a[3];
+        break;
+    case SSD1331_ACT_SCROL:
+        emu->scroll.active = true;
+        break;
+    case SSD1331_DEACT_SCROL:
+        emu->scroll.active = false;
+        break;
+    case SSD1331_DRAW_LINE:
+    case SSD1331_DRAW_RECT:
+    case SSD1331_COPY:
+    case SSD1331_DIM_WIN:
+    case SSD1331_CLEAR_WIN:
+        run_accel(cmd, a);
+        break;
+    }
+}
+
+static void write_cmd(uint8_t b) {
+    emu->stats.cmd_bytes++;
+
+    if (emu->got < emu->nargs) {
+        emu->args[emu->got++] = b;
+        if (emu->got == emu->nargs)
+            run_cmd(emu->cmd, emu->args);
+        return;
+    }
+
+    int n = cmd_args(b);
+    if (n < 0) {
+        emu->stats.unknown_cmds++;
+        n = 0;
+    }
+    emu->cmd = b;
+    emu->nargs = n;
+    emu->got = 0;
+    if (n == 0)
+        run_cmd(b, NULL);
+}
+
+// 色数の設定 (REMAP_COLOR_DEPTHのbit7:6) での1ピクセルのバイト数
+static inline int pixel_bytes(void) {
+    switch (emu->remap >> 6) {
+    case 0:
+        return 1;
+    case 2:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+static uint16_t decode_pixel(const uint8_t *p, int n) {
+    switch (n) {
+    case 1: {
+        // RRRGGGBBを各成分のビット幅に広げる
+        int r = p[0] >> 5, g = (p[0] >> 2) & 7, b = p[0] & 3;
+        return ((r << 2) | (r >> 1)) << 11 | ((g << 3) | g) << 5 | ((b << 3) | (b << 1) | (b >> 1));
+    }
+    case 3:
+        return accel_color(p);
+    default:
+        return p[0] << 8 | p[1];
+    }
+}
+
+static void advance(void) {
+    if (emu->remap & 0x01) {
+        // 垂直アドレス増加
+        if (++emu->row > emu->r1) {
+            emu->row = emu->r0;
+            if (++emu->col > emu->c1)
+                emu->col = emu->c0;
+        }
+    } else {
+        if (++emu->col > emu->c1) {
+            emu->col = emu->c0;
+            if (++emu->row > emu->r1)
+                emu->row = emu->r0;
+        }
+    }
+}
+
+static void write_data(uint8_t b) {
+    int n = pixel_bytes();
+
+    emu->stats.data_bytes++;
+    emu->pix[emu->npix++] = b;
+    if (emu->npix < n)
+        return;
+
+    emu->npix = 0;
+    emu->ram[emu->row][emu->col] = decode_pixel(emu->pix, n);
+    emu->stats.pixels++;
+    advance();
+}
+
+void emu_write(uint8_t b, bool data) {
+    if (!emu->cs) {
+        emu->stats.stray_bytes++;
+        return;
+    }
+
+    emu->stats.bytes++;
+    if (data)
+        write_data(b);
+    else
+        write_cmd(b);
+}
+
+void emu_scroll_step(int steps) {
+    if (!emu->scroll.active)
+        return;
+
+    int top = MIN(emu->scroll.top, EMU_HEIGHT);
+    int bottom = MIN(emu->scroll.top + emu->scroll.rows, EMU_HEIGHT);
+    int h = emu->scroll.h % EMU_WIDTH;
+    uint16_t tmp[EMU_WIDTH];
+
+    for (int i = 0; i < steps; i++) {
+        // 水平: スクロール範囲の行を右へh桁回す。垂直: 開始行をv行進める
+        for (int r = top; r < bottom && h; r++) {
+            memcpy(tmp, emu->ram[r], sizeof(tmp));
+            for (int c = 0; c < EMU_WIDTH; c++)
+                emu->ram[r][(c + h) % EMU_WIDTH] = tmp[c];
+        }
+        emu->start_line = (emu->start_line + emu->scroll.v) & 0x3f;
+    }
+}
+
+uint16_t emu_ram(int col, int row) {
+    return emu->ram[row][col];
+}
+
+uint16_t emu_pixel(int x, int y) {
+    if (!emu->on || emu->mode == SSD1331_SET_ALL_OFF)
+        return 0;
+    if (emu->mode == SSD1331_SET_ALL_ON)
+        return 0xffff;
+
+    // bit4: COMの走査方向, bit1: 桁の入れ替え
+    int line = (emu->remap & 0x10) ? y : EMU_HEIGHT - 1 - y;
+    int row = (line + emu->start_line + emu->offset) & 0x3f;
+    int col = (emu->remap & 0x02) ? x : EMU_WIDTH - 1 - x;
+    uint16_t c = emu->ram[row][col];
+
+    // bit2: BGRの順
+    if (emu->remap & 0x04)
+        c = (c & 0x1f) << 11 | (c & 0x07e0) | c >> 11;
+    if (emu->mode == SSD1331_SET_INV_DISP)
+        c = ~c;
+    return c;
+}
+
+bool emu_dump_ppm(const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+        return false;
+
+    fprintf(fp, "P6\n%d %d\n255\n", EMU_WIDTH, EMU_HEIGHT);
+    for (int y = 0; y < EMU_HEIGHT; y++)
+        for (int x = 0; x < EMU_WIDTH; x++) {
+            uint16_t c = emu_pixel(x, y);
+            int r = c >> 11, g = (c >> 5) & 0x3f, b = c & 0x1f;
+            uint8_t rgb[3] = { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 };
+            fwrite(rgb, 3, 1, fp);
+        }
+    return fclose(fp) == 0;
+}
+
+const struct emu_stats *emu_stats(void) {
+    return &emu->stats;
+}
+
+void emu_stats_reset(void) {
+    memset(&emu->stats, 0, sizeof(emu->stats));
+}
+
+double emu_wire_us(uint32_t spi_hz) {
+    return emu->stats.bytes * 8 * 1e6 / spi_hz;
+}
+
+void emu_print_stats(FILE *fp, uint32_t spi_hz) {
+    const struct emu_stats *s = &emu->stats;
+
+    fprintf(fp, "bytes %u (command %u, data %u), transactions %u, pixels %u, accel %u",
+            s->bytes, s->cmd_bytes, s->data_bytes, s->transactions, s->pixels, s->accel_cmds);
+    if (s->unknown_cmds || s->stray_bytes)
+        fprintf(fp, ", unknown %u, stray %u", s->unknown_cmds, s->stray_bytes);
+    fprintf(fp, ", wire %.1f us @ %.1f MHz\n", emu_wire_us(spi_hz), spi_hz / 1e6);
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SSD1331_EMU_H
+#define SSD1331_EMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* SSD1331のソフトウェアモデル (ホスト用)
+
+   ホストのHAL (ssd1331_hal_host.c) がSPIに書き出したバイトをD/C#の状態とともに
+   受け取り、コマンドを解釈して96x64のGDDRAMを更新する。
+
+   モデル化しているもの:
+     * ウィンドウ (SET_COL_ADDR, SET_ROW_ADDR) と書き込み位置の折り返し
+     * REMAP_COLOR_DEPTH: 65K/256/65K形式2の色数、RGB/BGR、水平/垂直アドレス増加、
+       桁の入れ替え (bit1) とCOMの走査方向 (bit4)。
+       COMの奇偶分割 (bit5) とCOMの左右入れ替え (bit3) は扱わない
+     * SET_DISP_START_LINE, SET_DISP_OFFSET, 通常/全点灯/全消灯/反転表示, 表示オン/オフ
+     * スクロール (SETUP_SCROL, ACT_SCROL, DEACT_SCROL): emu_scroll_step()で1段ずつ進める
+     * DRAW_LINE, DRAW_RECT, FILL, COPY, DIM_WIN, CLEAR_WIN
+   その他のコマンドは引数の数だけ読み飛ばす。
+
+   画面の向き: 初期化の0x72 (bit1=1, bit4=1) でGDDRAMの (桁,行) がそのまま
+   画面の (x,y) になるとする。
+*/
+
+#define EMU_WIDTH       96
+#define EMU_HEIGHT      64
+// モデルにできるパネルの数。各関数はemu_select()で選んだパネルを操作する (既定はパネル0)
+#define EMU_PANELS      4
+
+struct emu_stats {
+    uint32_t bytes;         // CS#アサート中に受け取ったバイト数
+    uint32_t cmd_bytes;     // うちコマンド (引数を含む)
+    uint32_t data_bytes;    // うちGDDRAMへのデータ
+    uint32_t transactions;  // CS#をアサートした回数
+    uint32_t pixels;        // データで書き込まれたピクセル数
+    uint32_t accel_cmds;    // 描画/コピー/クリアコマンドの数
+    uint32_t unknown_cmds;  // 解釈できなかったコマンドバイトの数
+    uint32_t stray_bytes;   // CS#を解除している間に送られたバイト数
+};
+
+// 以降の関数で操作するパネルを選び、それまで選んでいたパネルを返す
+int emu_select(int panel);
+// 電源投入時 (RES#) の状態に戻す。GDDRAMは黒にする
+void emu_reset(void);
+void emu_cs(bool select);
+// 1バイト受け取る。dataはD/C#の状態 (true: データ)
+void emu_write(uint8_t b, bool data);
+// 有効なスクロールをsteps段進める
+void emu_scroll_step(int steps);
+
+// GDDRAMの (桁,行) の値 (RGB565)
+uint16_t emu_ram(int col, int row);
+// パネルに表示されている (x,y) の色 (RGB565)。
+// 表示の向き、開始行、反転表示、表示オフを反映する
+uint16_t emu_pixel(int x, int y);
+// 表示されている画面をバイナリPPM (P6) で書き出す
+bool emu_dump_ppm(const char *path);
+
+const struct emu_stats *emu_stats(void);
+void emu_stats_reset(void);
+// 受け取ったバイト数をspi_hzのSPIで送るのにかかる時間 (us)
+double emu_wire_us(uint32_t spi_hz);
+void emu_print_stats(FILE *fp, uint32_t spi_hz);
+
+#endif // SSD1331_EMU_H
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SSD1331_HAL_H
+#define SSD1331_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* SSD1331ドライバが使用するSPI/DMA/GPIOの抽象化層
+
+   ssd1331_hal_pico.c: RP2040 (spi_default + DMAチャネル) 用の実装
+   ssd1331_hal_host.c: Linuxホストでのテスト用の実装。送信バイト列を記録し、
+                       SSD1331のソフトウェアモデル (ssd1331_emu.c) に渡す
+                       (コア1はスレッド、コア間FIFOはキューで模擬する)
+
+   SPI/DMAはバス (struct ssd1331_bus) ごと、CS#, D/C#, RES#はパネルごとの
+   GPIOとして扱う。
+
+   SSD1331_HOSTを定義したビルドではPico SDKを使わないので、ドライバが使う
+   SDKの型とマクロをここで定義する。
+*/
+
+#ifdef SSD1331_HOST
+#include <assert.h>
+
+typedef unsigned int uint;
+
+#define _u(x)           x ## u
+#define count_of(a)     (sizeof(a) / sizeof((a)[0]))
+#ifndef MIN
+#define MIN(a, b)       ((b) > (a) ? (a) : (b))
+#define MAX(a, b)       ((a) > (b) ? (a) : (b))
+#endif
+
+static inline void tight_loop_contents(void) {}
+
+// ホストでもPicoと同じピン番号を使う (モデルへの配線はhal_host_attach()で指定する)
+#define PICO_DEFAULT_SPI_SCK_PIN    18
+#define PICO_DEFAULT_SPI_TX_PIN     19
+#define PICO_DEFAULT_SPI_CSN_PIN    17
+#else
+#include "pico/stdlib.h"
+#endif
+
+struct ssd1331_bus;
+struct ssd1331;
+
+// busのSPIをbus->freq Hzで初期化し、SCKとMOSIのピンをSPIに割り当てる
+void hal_bus_init(struct ssd1331_bus *bus);
+// pinを出力に設定してvalueを出力する
+void hal_gpio_init(uint pin, bool value);
+void hal_gpio_put(uint pin, bool value);
+void hal_sleep_us(uint32_t us);
+
+// SPIの1ワードのビット数 (8 or 16) を設定
+void hal_spi_set_format(struct ssd1331_bus *bus, unsigned int bits);
+void hal_spi_write(struct ssd1331_bus *bus, const uint8_t *buf, size_t len);
+void hal_spi_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len);
+// 送信FIFOが空になり、最後のワードがシフトアウトされるまで待つ
+void hal_spi_wait_idle(struct ssd1331_bus *bus);
+
+// busのSPI TXのDREQでペーシングされるDMAチャネルを確保する。
+// 転送完了時には割り込みコンテキストからdone(bus)が呼ばれる
+void hal_dma_init(struct ssd1331_bus *bus, void (*done)(struct ssd1331_bus *bus));
+// 16bitワードのDMA転送を開始する (SPIは16bitフォーマットであること)
+void hal_dma_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len);
+// 8bitのDMA転送を開始する (SPIは8bitフォーマットであること)
+void hal_dma_write8(struct ssd1331_bus *bus, const uint8_t *buf, size_t len);
+// DMA転送の終了を待つ (doneの呼び出しは割り込み側で行われる)
+void hal_dma_wait(struct ssd1331_bus *bus);
+// DMA完了の割り込みを禁止する区間 (ドライバのキューの操作に使う)
+uint32_t hal_irq_save(void);
+void hal_irq_restore(uint32_t state);
+
+// hal_alarm_in_us()で予約したアラームで割り込みコンテキストから呼ぶ関数を登録する
+void hal_alarm_init(void (*fired)(struct ssd1331 *dev));
+// us後にfired(dev)を1回呼ぶ。RP2040でアラームプールに空きがなければ、期限の後のhal_idle()で呼ぶ
+void hal_alarm_in_us(struct ssd1331 *dev, uint32_t us);
+// 割り込みを待つループの中で呼ぶ。RP2040ではプールに入らなかったアラームのうち期限を過ぎたものを、
+// ホストでは予約されたアラームのうち期限の最も早いものを (その時刻まで待たずに) 実行する
+void hal_idle(void);
+
+// コア1でentryを実行する (すでに動いていればリセットしてから起動する)
+void hal_core1_launch(void (*entry)(void));
+// コア間FIFO: 相手のコアへ送る / 自分宛ての値を受け取る (どちらも空くまで待つ)
+void hal_fifo_push(uint32_t value);
+uint32_t hal_fifo_pop(void);
+// 自分宛ての値が届いているか
+bool hal_fifo_ready(void);
+uint64_t hal_time_us(void);
+// 性能計測用の細かいカウンタ: RP2040ではSysTick (24bit, CPUクロック)、
+// ホストではns。差はHAL_TICKS_MASKで折り返して求める
+uint32_t hal_ticks(void);
+// hal_ticks()のカウンタを動かす (perf_reset()が呼ぶ)。RP2040ではSysTickが止まっていれば
+// 割り込みなしで24bitを回す。既に動いていれば設定を変えずにそのまま読むので、
+// リロード値がHAL_TICKS_MASKより小さいと周期をまたぐ区間の時間は正しくない
+void hal_ticks_start(void);
+uint32_t hal_ticks_per_us(void);
+#ifdef SSD1331_HOST
+#define HAL_TICKS_MASK  0xffffffffu
+#else
+#define HAL_TICKS_MASK  0x00ffffffu
+#endif
+
+#ifdef SSD1331_HOST
+// ホスト実装のみ: 記録した送信バイト列の参照
+void hal_host_wire_reset(void);
+const uint8_t *hal_host_wire_bytes(void);
+const bool *hal_host_wire_dc(void);     // 各バイト送信時のD/C#の状態 (true: データ)
+size_t hal_host_wire_len(void);
+uint32_t hal_host_cs_count(void);       // CS#をアサートした回数 (同時にアサートしたものは1回)
+uint32_t hal_host_format_count(void);   // SPIフォーマットを設定した回数
+// モデルのpanel番目のパネルをCS#, D/C#, RES#のピンにつなぐ。
+// 何もつながなければパネル0がSPI_CSN_PIN, SPI_DCN_PIN, SPI_RESN_PINにつながる
+void hal_host_attach(int panel, uint cs, uint dc, uint res);
+// 開始済みで完了していないDMA転送があるか
+bool hal_host_dma_pending(void);
+// 保留中のDMA転送を完了させ、完了コールバックを呼ぶ
+void hal_host_dma_complete(void);
+// SPIのクロックを設定すると、送信したバイト数に応じた時間だけ書き込みが待つ (0で待たない)
+void hal_host_set_spi_clock(uint32_t hz);
+#endif
+
+#endif // SSD1331_HAL_H
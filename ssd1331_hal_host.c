@@ -0,0 +1,361 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "ssd1331.h"
+#include "ssd1331_hal.h"
+#include "ssd1331_emu.h"
+
+/* Linuxホスト用のHAL実装
+
+   SPIに書き出されたバイト列を各バイト送信時のD/C#の状態とともに記録し、
+   SSD1331のモデル (ssd1331_emu.c) にも渡す。GPIOはピンの状態だけを持ち、
+   CS#をアサートしているモデルのパネルにそのパネルのD/C#の状態でバイトを渡す。
+   DMA転送は開始時にバイト列を記録し、hal_dma_wait()またはhal_host_dma_complete()
+   が呼ばれるまで「転送中」のままにしておく。これにより描画と転送の重なりを
+   ホスト上で再現できる。
+
+   アラームは時刻を記録しておき、hal_idle()で期限の早い順に実行する
+   (hal_sleep_us()と同じく待ち時間は飛ばす)。
+
+   コア1はスレッドとして起動し、コア間FIFOはRP2040と同じ深さ8の
+   キューを2本 (コア0→コア1, コア1→コア0) 使って模擬する。
+*/
+
+#define WIRE_MAX    (64 * 1024)
+#define NUM_PINS    30
+#define NUM_BUSES   2
+
+static struct {
+    uint8_t bytes[WIRE_MAX];
+    bool dc[WIRE_MAX];
+    size_t len;
+    uint32_t cs_count;
+    uint32_t format_count;
+    int selected[EMU_PANELS];   // CS#をアサートしているパネル
+    int nselected;
+    bool data;                  // 最後に書いたバイトのD/C#
+} wire;
+
+// 出力のレベル: CS#などはアクティブLOWなのでHIGHから始める
+static bool pins[NUM_PINS] = { [0 ... NUM_PINS - 1] = true };
+
+// モデルのパネルごとの配線 (cs < 0: つながっていない)
+static struct {
+    int cs, dc, res;
+} panels[EMU_PANELS] = {
+    { SPI_CSN_PIN, SPI_DCN_PIN, SPI_RESN_PIN },
+    { -1, -1, -1 }, { -1, -1, -1 }, { -1, -1, -1 }
+};
+
+static struct {
+    struct ssd1331_bus *bus;
+    bool pending;
+} dma[NUM_BUSES];
+static void (*dma_done)(struct ssd1331_bus *bus);
+static uint32_t spi_clock;
+
+#define NUM_ALARMS  8
+
+static struct {
+    struct ssd1331 *dev;
+    uint64_t due;
+} alarms[NUM_ALARMS];
+static int nalarms;
+static uint64_t alarm_now;          // 実行したアラームの時刻 (待ち時間を飛ばした仮想の時刻)
+static void (*alarm_fired)(struct ssd1331 *dev);
+
+#define FIFO_DEPTH  8
+
+struct fifo {
+    uint32_t v[FIFO_DEPTH];
+    int head;
+    int count;
+};
+
+static pthread_mutex_t fifo_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fifo_cond = PTHREAD_COND_INITIALIZER;
+static struct fifo fifos[2];        // fifos[n]: コアn宛て
+static __thread int core;           // このスレッドが模擬しているコアの番号
+
+// 送信したバイト数に応じて待つ
+static void wire_delay(size_t bytes) {
+    if (!spi_clock)
+        return;
+
+    uint64_t ns = (uint64_t)bytes * 8 * 1000000000ull / spi_clock;
+    struct timespec ts = { ns / 1000000000ull, ns % 1000000000ull };
+    nanosleep(&ts, NULL);
+}
+
+// CS#をアサートしているすべてのパネルにそれぞれのD/C#の状態で渡す
+static void wire_put(uint8_t b) {
+    int prev = emu_select(0);
+
+    for (int i = 0; i < wire.nselected; i++) {
+        int n = wire.selected[i];
+        wire.data = pins[panels[n].dc];
+        emu_select(n);
+        emu_write(b, wire.data);
+    }
+    // どのパネルも選択していなければパネル0に渡して数えさせる
+    if (!wire.nselected)
+        emu_write(b, wire.data);
+    emu_select(prev);
+
+    // 記録領域を超えた分は捨てる (長さだけは数える)
+    if (wire.len < WIRE_MAX) {
+        wire.bytes[wire.len] = b;
+        wire.dc[wire.len] = wire.data;
+    }
+    wire.len++;
+}
+
+void hal_bus_init(struct ssd1331_bus *bus) {
+}
+
+void hal_gpio_init(uint pin, bool value) {
+    hal_gpio_put(pin, value);
+}
+
+void hal_gpio_put(uint pin, bool value) {
+    assert(pin < NUM_PINS);
+    if (pins[pin] == value)
+        return;
+    pins[pin] = value;
+
+    bool cs = false;
+    for (int i = 0; i < EMU_PANELS; i++) {
+        int prev;
+
+        if (panels[i].cs == (int)pin) {
+            prev = emu_select(i);
+            emu_cs(!value);
+            emu_select(prev);
+            cs = true;
+        }
+        if (panels[i].res == (int)pin && !value) {
+            prev = emu_select(i);
+            emu_reset();
+            emu_select(prev);
+        }
+    }
+    if (!cs)
+        return;
+
+    // 選択中のパネルを数え直す。他のパネルと同時にアサートしたものは1回のトランザクションとする
+    int n = 0;
+    for (int i = 0; i < EMU_PANELS; i++)
+        if (panels[i].cs >= 0 && !pins[panels[i].cs])
+            wire.selected[n++] = i;
+    if (n && !wire.nselected)
+        wire.cs_count++;
+    wire.nselected = n;
+}
+
+void hal_sleep_us(uint32_t us) {
+    // 待ち時間はモデルの状態に影響しないので待たない
+}
+
+void hal_spi_set_format(struct ssd1331_bus *bus, unsigned int bits) {
+    wire.format_count++;
+}
+
+void hal_spi_write(struct ssd1331_bus *bus, const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        wire_put(buf[i]);
+    wire_delay(len);
+}
+
+void hal_spi_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len) {
+    // MSBファースト: 上位バイトから送信される
+    for (size_t i = 0; i < len; i++) {
+        wire_put(buf[i] >> 8);
+        wire_put(buf[i] & 0xff);
+    }
+    wire_delay(2 * len);
+}
+
+void hal_spi_wait_idle(struct ssd1331_bus *bus) {
+}
+
+void hal_dma_init(struct ssd1331_bus *bus, void (*done)(struct ssd1331_bus *bus)) {
+    dma_done = done;
+    dma[bus->spi].bus = bus;
+    dma[bus->spi].pending = false;
+}
+
+void hal_dma_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len) {
+    hal_spi_write16(bus, buf, len);
+    dma[bus->spi].pending = true;
+}
+
+void hal_dma_write8(struct ssd1331_bus *bus, const uint8_t *buf, size_t len) {
+    hal_spi_write(bus, buf, len);
+    dma[bus->spi].pending = true;
+}
+
+void hal_dma_wait(struct ssd1331_bus *bus) {
+    if (!dma[bus->spi].pending)
+        return;
+
+    dma[bus->spi].pending = false;
+    if (dma_done)
+        dma_done(bus);
+}
+
+uint32_t hal_irq_save(void) {
+    // 完了の割り込みはhal_dma_wait()などを呼んだスレッドで起きるので何もしない
+    return 0;
+}
+
+void hal_irq_restore(uint32_t state) {
+}
+
+void hal_alarm_init(void (*fired)(struct ssd1331 *dev)) {
+    alarm_fired = fired;
+}
+
+void hal_alarm_in_us(struct ssd1331 *dev, uint32_t us) {
+    assert(nalarms < NUM_ALARMS);
+    alarms[nalarms].dev = dev;
+    alarms[nalarms].due = alarm_now + us;
+    nalarms++;
+}
+
+void hal_idle(void) {
+    if (!nalarms)
+        return;
+
+    int k = 0;
+    for (int i = 1; i < nalarms; i++)
+        if (alarms[i].due < alarms[k].due)
+            k = i;
+    struct ssd1331 *dev = alarms[k].dev;
+    alarm_now = alarms[k].due;
+    alarms[k] = alarms[--nalarms];
+    alarm_fired(dev);
+}
+
+static void *core1_thread(void *arg) {
+    core = 1;
+    ((void (*)(void))arg)();
+    return NULL;
+}
+
+void hal_core1_launch(void (*entry)(void)) {
+    pthread_t th;
+
+    pthread_create(&th, NULL, core1_thread, (void *)entry);
+    pthread_detach(th);
+}
+
+void hal_fifo_push(uint32_t value) {
+    struct fifo *f = &fifos[core ^ 1];
+
+    pthread_mutex_lock(&fifo_lock);
+    while (f->count == FIFO_DEPTH)
+        pthread_cond_wait(&fifo_cond, &fifo_lock);
+    f->v[(f->head + f->count++) % FIFO_DEPTH] = value;
+    pthread_cond_broadcast(&fifo_cond);
+    pthread_mutex_unlock(&fifo_lock);
+}
+
+uint32_t hal_fifo_pop(void) {
+    struct fifo *f = &fifos[core];
+
+    pthread_mutex_lock(&fifo_lock);
+    while (f->count == 0)
+        pthread_cond_wait(&fifo_cond, &fifo_lock);
+    uint32_t value = f->v[f->head];
+    f->head = (f->head + 1) % FIFO_DEPTH;
+    f->count--;
+    pthread_cond_broadcast(&fifo_cond);
+    pthread_mutex_unlock(&fifo_lock);
+    return value;
+}
+
+bool hal_fifo_ready(void) {
+    pthread_mutex_lock(&fifo_lock);
+    bool ready = fifos[core].count > 0;
+    pthread_mutex_unlock(&fifo_lock);
+    return ready;
+}
+
+uint64_t hal_time_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void hal_ticks_start(void) {
+}
+
+uint32_t hal_ticks(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+uint32_t hal_ticks_per_us(void) {
+    return 1000;
+}
+
+void hal_host_wire_reset(void) {
+    wire.len = 0;
+    wire.cs_count = 0;
+    wire.format_count = 0;
+}
+
+const uint8_t *hal_host_wire_bytes(void) {
+    return wire.bytes;
+}
+
+const bool *hal_host_wire_dc(void) {
+    return wire.dc;
+}
+
+size_t hal_host_wire_len(void) {
+    return wire.len;
+}
+
+uint32_t hal_host_cs_count(void) {
+    return wire.cs_count;
+}
+
+uint32_t hal_host_format_count(void) {
+    return wire.format_count;
+}
+
+void hal_host_attach(int panel, uint cs, uint dc, uint res) {
+    assert(panel >= 0 && panel < EMU_PANELS && cs < NUM_PINS && dc < NUM_PINS && res < NUM_PINS);
+    panels[panel].cs = cs;
+    panels[panel].dc = dc;
+    panels[panel].res = res;
+}
+
+bool hal_host_dma_pending(void) {
+    for (int i = 0; i < NUM_BUSES; i++)
+        if (dma[i].pending)
+            return true;
+    return false;
+}
+
+void hal_host_dma_complete(void) {
+    // 完了の処理で待ち行列の次の転送が始まると、それは保留中のまま残る
+    for (int i = 0; i < NUM_BUSES; i++)
+        if (dma[i].pending)
+            hal_dma_wait(dma[i].bus);
+}
+
+void hal_host_set_spi_clock(uint32_t hz) {
+    spi_clock = hz;
+}
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "ssd1331.h"
+#include "ssd1331_hal.h"
+
+/* RP2040用のHAL実装: バスごとにSPIインスタンス (spi0/spi1) とDMAチャネルを1本使用する。
+   CS#, D/C#, RES#はSIOのGPIOとして駆動する。コア間はSIOのFIFOを使う */
+
+#define NUM_BUSES   2
+
+// DMA完了の割り込みで調べるバス (SPIインスタンスごとに1つ)
+static struct ssd1331_bus *buses[NUM_BUSES];
+static void (*dma_done)(struct ssd1331_bus *bus);
+
+static inline spi_inst_t *spi_of(struct ssd1331_bus *bus) {
+    return bus->spi ? spi1 : spi0;
+}
+
+void hal_bus_init(struct ssd1331_bus *bus) {
+    spi_init(spi_of(bus), bus->freq);
+
+    gpio_set_function(bus->sck_pin, GPIO_FUNC_SPI);
+    gpio_set_function(bus->mosi_pin, GPIO_FUNC_SPI);
+}
+
+void hal_gpio_init(uint pin, bool value) {
+    gpio_init(pin);
+    gpio_put(pin, value);
+    gpio_set_dir(pin, GPIO_OUT);
+}
+
+void hal_gpio_put(uint pin, bool value) {
+    gpio_put(pin, value);
+}
+
+void hal_sleep_us(uint32_t us) {
+    sleep_us(us);
+}
+
+void hal_spi_set_format(struct ssd1331_bus *bus, unsigned int bits) {
+    spi_set_format(spi_of(bus), bits, SPI_CPOL_0,  SPI_CPHA_0, SPI_MSB_FIRST);
+}
+
+void hal_spi_write(struct ssd1331_bus *bus, const uint8_t *buf, size_t len) {
+    spi_write_blocking(spi_of(bus), buf, len);
+}
+
+void hal_spi_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len) {
+    spi_write16_blocking(spi_of(bus), buf, len);
+}
+
+void hal_spi_wait_idle(struct ssd1331_bus *bus) {
+    while (spi_is_busy(spi_of(bus)))
+        tight_loop_contents();
+}
+
+static void dma_irq_handler(void) {
+    for (int i = 0; i < NUM_BUSES; i++) {
+        struct ssd1331_bus *bus = buses[i];
+
+        if (!bus || !dma_channel_get_irq0_status(bus->dma_chan))
+            continue;
+        dma_channel_acknowledge_irq0(bus->dma_chan);
+        if (dma_done)
+            dma_done(bus);
+    }
+}
+
+void hal_dma_init(struct ssd1331_bus *bus, void (*done)(struct ssd1331_bus *bus)) {
+    bool first = !buses[0] && !buses[1];
+
+    dma_done = done;
+    if (buses[bus->spi] == bus && bus->dma_chan >= 0)
+        return;
+
+    bus->dma_chan = dma_claim_unused_channel(true);
+
+    // 16bitずつメモリからSPIのデータレジスタへ書き込む。
+    // SPIの送信FIFOに空きがあるときだけ転送されるようTX DREQでペーシングする
+    dma_channel_config c = dma_channel_get_default_config(bus->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(spi_of(bus), true));
+    dma_channel_configure(bus->dma_chan, &c, &spi_get_hw(spi_of(bus))->dr, NULL, 0, false);
+
+    buses[bus->spi] = bus;
+    dma_channel_set_irq0_enabled(bus->dma_chan, true);
+    if (first) {
+        irq_add_shared_handler(DMA_IRQ_0, dma_irq_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+}
+
+// 転送の1ワードの大きさを設定して転送を開始する
+static void dma_start(struct ssd1331_bus *bus, const void *buf, size_t len, enum dma_channel_transfer_size size) {
+    dma_channel_config c = dma_get_channel_config(bus->dma_chan);
+
+    channel_config_set_transfer_data_size(&c, size);
+    dma_channel_set_config(bus->dma_chan, &c, false);
+    dma_channel_transfer_from_buffer_now(bus->dma_chan, buf, len);
+}
+
+void hal_dma_write16(struct ssd1331_bus *bus, const uint16_t *buf, size_t len) {
+    dma_start(bus, buf, len, DMA_SIZE_16);
+}
+
+void hal_dma_write8(struct ssd1331_bus *bus, const uint8_t *buf, size_t len) {
+    dma_start(bus, buf, len, DMA_SIZE_8);
+}
+
+void hal_dma_wait(struct ssd1331_bus *bus) {
+    dma_channel_wait_for_finish_blocking(bus->dma_chan);
+}
+
+uint32_t hal_irq_save(void) {
+    return save_and_disable_interrupts();
+}
+
+void hal_irq_restore(uint32_t state) {
+    restore_interrupts(state);
+}
+
+static void (*alarm_fired)(struct ssd1331 *dev);
+
+// アラームプールに空きがなくて予約できなかったもの。hal_idle()で期限を調べて呼ぶ
+#define NUM_DEFERRED    8
+
+static struct {
+    struct ssd1331 *dev;        // NULLなら空き
+    absolute_time_t due;
+} deferred[NUM_DEFERRED];
+
+static int64_t alarm_handler(alarm_id_t id, void *user_data) {
+    alarm_fired(user_data);
+    return 0;
+}
+
+void hal_alarm_init(void (*fired)(struct ssd1331 *dev)) {
+    alarm_fired = fired;
+}
+
+void hal_alarm_in_us(struct ssd1331 *dev, uint32_t us) {
+    // 既定のアラームプールを使う。期限を過ぎていたときは予約されずに0が返るので、ここで呼ぶ
+    alarm_id_t id = add_alarm_in_us(us, alarm_handler, dev, false);
+    if (id > 0)
+        return;
+    if (id == 0) {
+        alarm_fired(dev);
+        return;
+    }
+
+    // プールに空きがない (-1)。予約を捨てると初期化が進まずssd1331_wait_ready()が戻らないので、
+    // 期限を覚えておき、待つループから呼ばれるhal_idle()で呼ぶ
+    uint32_t state = save_and_disable_interrupts();
+    for (int i = 0; i < NUM_DEFERRED; i++) {
+        if (!deferred[i].dev) {
+            deferred[i].dev = dev;
+            deferred[i].due = make_timeout_time_us(us);
+            restore_interrupts(state);
+            return;
+        }
+    }
+    restore_interrupts(state);
+    panic("ssd1331: no alarm available");
+}
+
+void hal_idle(void) {
+    for (int i = 0; i < NUM_DEFERRED; i++) {
+        struct ssd1331 *dev = NULL;
+        uint32_t state = save_and_disable_interrupts();
+
+        if (deferred[i].dev && time_reached(deferred[i].due)) {
+            dev = deferred[i].dev;
+            deferred[i].dev = NULL;
+        }
+        restore_interrupts(state);
+        if (dev)
+            alarm_fired(dev);
+    }
+    tight_loop_contents();
+}
+
+void hal_core1_launch(void (*entry)(void)) {
+    multicore_reset_core1();
+    multicore_launch_core1(entry);
+}
+
+void hal_fifo_push(uint32_t value) {
+    multicore_fifo_push_blocking(value);
+}
+
+uint32_t hal_fifo_pop(void) {
+    return multicore_fifo_pop_blocking();
+}
+
+bool hal_fifo_ready(void) {
+    return multicore_fifo_rvalid();
+}
+
+uint64_t hal_time_us(void) {
+    return time_us_64();
+}
+
+void hal_ticks_start(void) {
+    // アプリやRTOSが動かしているSysTickの周期と割り込みは変えない
+    if (systick_hw->csr & 0x1)
+        return;
+    // CPUクロックで24bitを回し続ける (割り込みなし)
+    systick_hw->rvr = HAL_TICKS_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;
+}
+
+uint32_t hal_ticks(void) {
+    // SysTickは減っていくので反転して増加するカウンタにする
+    return HAL_TICKS_MASK - systick_hw->cvr;
+}
+
+uint32_t hal_ticks_per_us(void) {
+    return clock_get_hz(clk_sys) / 1000000;
+}
@@ -0,0 +1,673 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ssd1331.h"
+#include "ssd1331_emu.h"
+#include "gfx.h"
+#include "damage.h"
+#include "accel.h"
+#include "console.h"
+#include "dlist.h"
+#include "pipeline.h"
+#include "qimage.h"
+#include "sprite.h"
+#include "textgrid.h"
+
+/* ホストのテスト (ssd1331_test、ctestから実行する)
+
+   ドライバをSSD1331のモデルにつないで描画し、SPIに送られたバイト数
+   (hal_host_wire_len()) と、モデルのGDDRAM (emu_ram()) の内容を確かめる。
+   表示の内容はフレームバッファに同じものを描いた結果 (参照) と比べる。
+   失敗した確認はファイルと行を表示し、1つでも失敗すれば終了コードは1になる。
+*/
+
+#define SPI_FREQ    (10 * 1000 * 1000)
+
+static struct ssd1331_bus bus;
+static struct ssd1331 oled;
+static uint16_t buf[SSD1331_BUF_LEN];
+static uint16_t ref_buf[SSD1331_BUF_LEN];
+static struct damage damage;
+static struct framebuffer fb;
+static int failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        long _a = (a), _b = (b); \
+        if (_a != _b) { \
+            printf("%s:%d: %s == %s (%ld != %ld)\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+            failures++; \
+        } \
+    } while (0)
+
+// 前のテストの転送を待ってパネルとフレームバッファを黒にし、送ったバイトの記録を空にする
+static void start(void) {
+    bus_wait(&bus);
+    ssd1331_invalidate(&oled);
+    fb_init(&fb, buf, &damage);
+    fb_clear(&fb, COL_BLACK);
+    damage_add_all(&damage);
+    render_dirty(&oled, &fb);
+    bus_wait(&bus);
+    hal_host_wire_reset();
+}
+
+// startからSPIに送られたバイト数
+static size_t wire(void) {
+    bus_wait(&bus);
+    return hal_host_wire_len();
+}
+
+// 参照のフレームバッファ (damageなし) を黒にする
+static void ref_init(struct framebuffer *ref) {
+    fb_init(ref, ref_buf, NULL);
+    fb_clear(ref, COL_BLACK);
+}
+
+// 選んでいるパネルのGDDRAMと参照のピクセルが異なる数
+static int ram_diff(const struct framebuffer *ref) {
+    int n = 0;
+
+    bus_wait(&bus);
+    for (int y = 0; y < SSD1331_HEIGHT; y++)
+        for (int x = 0; x < SSD1331_WIDTH; x++)
+            n += emu_ram(x, y) != ref->buf[y * SSD1331_WIDTH + x];
+    return n;
+}
+
+// 表示されている画面 (開始行を反映する) と参照のピクセルが異なる数
+static int screen_diff(const struct framebuffer *ref) {
+    int n = 0;
+
+    bus_wait(&bus);
+    for (int y = 0; y < SSD1331_HEIGHT; y++)
+        for (int x = 0; x < SSD1331_WIDTH; x++)
+            n += emu_pixel(x, y) != ref->buf[y * SSD1331_WIDTH + x];
+    return n;
+}
+
+// 位置ごとに違う色を並べたテスト用の模様
+static uint16_t pattern(int x, int y) {
+    return (uint16_t)((x * 37 + y * 101) * 2654435761u >> 16);
+}
+
+// 全画面の転送: ウィンドウの設定 (6バイト) とピクセルデータ
+#define FULL_FRAME  (6 + 2 * SSD1331_BUF_LEN)
+
+// 変更領域のみの転送: 全画面を変更したときは全画面を送る
+static void test_damage_full(void) {
+    start();
+    fill_rect(&fb, 0, 0, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1, COL_BLUE);
+    render_dirty(&oled, &fb);
+    // ウィンドウはstart()の全画面の転送と同じなので、ピクセルデータだけを送る
+    CHECK_EQ(wire(), 2 * SSD1331_BUF_LEN);
+
+    // 何も変えなければ何も送らない
+    hal_host_wire_reset();
+    render_dirty(&oled, &fb);
+    CHECK_EQ(wire(), 0);
+}
+
+// ラインスイープ (main.cのデモと同じ線を1本ずつ描いて送る) の1本あたりの平均
+static void test_damage_line(void) {
+    int n = SSD1331_WIDTH + SSD1331_HEIGHT;
+    size_t max = 0;
+
+    start();
+    for (int i = 0; i < n; i++) {
+        size_t before = wire();
+
+        if (i < SSD1331_WIDTH) {
+            draw_line(&fb, i, 0, SSD1331_WIDTH - 1 - i, SSD1331_HEIGHT - 1, COL_WHITE);
+        } else {
+            int y = SSD1331_HEIGHT - 1 - (i - SSD1331_WIDTH);
+            draw_line(&fb, 0, y, SSD1331_WIDTH - 1, SSD1331_HEIGHT - 1 - y, COL_WHITE);
+        }
+        render_dirty(&oled, &fb);
+        max = MAX(max, wire() - before);
+    }
+    // 全画面 (12294バイト) に比べて1本あたり平均919バイト
+    CHECK_EQ(wire() / n, 919);
+    CHECK(max <= FULL_FRAME);
+
+    // 変更済みの矩形の中に描くラインは区間を登録せず、矩形は増えない
+    start();
+    fill_rect(&fb, 0, 0, 47, 31, COL_RED);
+    draw_line(&fb, 2, 3, 40, 30, COL_WHITE);
+    CHECK_EQ(damage.count, 1);
+    render_dirty(&oled, &fb);
+    CHECK_EQ(wire(), 6 + 2 * 48 * 32);
+}
+
+// 3行のテキスト (main.cのデモと同じ)
+static void test_damage_text(void) {
+    static const char *text[] = {
+        "ABCDEFGHIJKL",
+        "MNOPQRSTUVWX",
+        "YZ0123456789"
+    };
+
+    start();
+    for (int i = 0; i < count_of(text); i++)
+        write_string(&fb, 0, 24 + 8 * i, text[i], COL_WHITE);
+    render_dirty(&oled, &fb);
+    // 3行の矩形 (96x24) とウィンドウ
+    CHECK_EQ(wire(), 4614);
+}
+
+// blit(): 画面とバンドの端で切り取った結果が1ピクセルずつ描いた参照と同じ
+static void test_blit(void) {
+    static uint16_t sheet[40 * 48];     // 40x30の画像を1行48ピクセルで並べたシート
+    static const int pos[][2] = { { 10, 8 }, { -7, -5 }, { 80, 50 }, { 60, -12 }, { -20, 40 } };
+    static uint16_t band_buf[SSD1331_WIDTH * 8];
+    struct framebuffer ref, band;
+
+    for (int y = 0; y < 40; y++)
+        for (int x = 0; x < 48; x++)
+            sheet[y * 48 + x] = pattern(x, y);
+
+    for (int i = 0; i < count_of(pos); i++) {
+        int x = pos[i][0], y = pos[i][1];
+
+        fb_init(&fb, buf, NULL);
+        fb_clear(&fb, COL_BLACK);
+        ref_init(&ref);
+        blit(&fb, x, y, sheet, 48, 5, 3, 40, 30);
+        for (int j = 0; j < 30; j++)
+            for (int k = 0; k < 40; k++)
+                set_pixel(&ref, x + k, y + j, sheet[(3 + j) * 48 + 5 + k]);
+        CHECK_EQ(memcmp(buf, ref_buf, sizeof(buf)), 0);
+
+        // 8行のバンドごとに描いたものも同じ
+        for (int y0 = 0; y0 < SSD1331_HEIGHT; y0 += 8) {
+            fb_init_band(&band, band_buf, y0, 8);
+            memset(band_buf, 0, sizeof(band_buf));
+            blit(&band, x, y, sheet, 48, 5, 3, 40, 30);
+            CHECK_EQ(memcmp(band_buf, ref_buf + y0 * SSD1331_WIDTH, sizeof(band_buf)), 0);
+        }
+    }
+}
+
+// render_blit(): 一時バッファに写してrender()で送るのと同じバイト列を1回のトランザクションで送る
+static void test_render_blit(void) {
+    static uint16_t sheet[32 * 64];
+    static uint8_t sent[2 * SSD1331_BUF_LEN + 64];
+    static const int pos[][2] = { { 10, 8 }, { -5, -3 }, { 80, 50 } };
+    struct framebuffer ref;
+
+    for (int y = 0; y < 32; y++)
+        for (int x = 0; x < 64; x++)
+            sheet[y * 64 + x] = pattern(x, y);
+
+    for (int i = 0; i < count_of(pos); i++) {
+        int x = pos[i][0], y = pos[i][1];
+        size_t len;
+
+        start();
+        ref_init(&ref);
+        blit(&ref, x, y, sheet, 64, 8, 2, 24, 20);
+
+        uint32_t cs = hal_host_cs_count();
+        render_blit(&oled, x, y, sheet, 64, 8, 2, 24, 20);
+        len = wire();
+        CHECK_EQ(hal_host_cs_count() - cs, 1);
+        CHECK_EQ(ram_diff(&ref), 0);
+        memcpy(sent, hal_host_wire_bytes(), MIN(len, sizeof(sent)));
+
+        // 同じ矩形を切り取って一時バッファからrender()で送る
+        int x0 = MAX(x, 0), y0 = MAX(y, 0);
+        int x1 = MIN(x + 23, SSD1331_WIDTH - 1), y1 = MIN(y + 19, SSD1331_HEIGHT - 1);
+        struct render_area area = {
+            start_col : x0,
+            end_col : x1,
+            start_row : y0,
+            end_row : y1
+        };
+        calc_render_area_buflen(&area);
+        start();
+        for (int j = y0; j <= y1; j++)
+            for (int k = x0; k <= x1; k++)
+                buf[(j - y0) * (x1 - x0 + 1) + k - x0] = ref_buf[j * SSD1331_WIDTH + k];
+        render(&oled, buf, &area);
+        CHECK_EQ(wire(), len);
+        CHECK_EQ(memcmp(hal_host_wire_bytes(), sent, MIN(len, sizeof(sent))), 0);
+    }
+}
+
+// accel_copy(): 重なる移動と画面外にはみ出す矩形がcopy_rect()と同じ
+static void test_accel_copy(void) {
+    static const int cases[][6] = {
+        { 0, 0, 40, 30, 10, 5 },        // 右下へ重なる
+        { 20, 20, 80, 60, 5, 25 },      // 左上へ重なる
+        { 10, 10, 40, 40, 12, 10 },     // 横に2ピクセル
+        { 10, 10, 40, 40, 10, 12 },     // 縦に2ピクセル
+        { 0, 0, 95, 63, -10, -7 },      // 転送先が画面外にはみ出す
+        { -20, -5, 50, 40, 10, 10 },    // 転送元が画面外にはみ出す
+    };
+    struct render_area area = {
+        start_col : 0,
+        end_col : SSD1331_WIDTH - 1,
+        start_row : 0,
+        end_row : SSD1331_HEIGHT - 1
+    };
+    struct framebuffer ref;
+
+    calc_render_area_buflen(&area);
+    for (int i = 0; i < count_of(cases); i++) {
+        const int *c = cases[i];
+
+        start();
+        ref_init(&ref);
+        for (int y = 0; y < SSD1331_HEIGHT; y++)
+            for (int x = 0; x < SSD1331_WIDTH; x++)
+                ref_buf[y * SSD1331_WIDTH + x] = pattern(x, y);
+        render(&oled, ref_buf, &area);
+        accel_copy(&oled, NULL, c[0], c[1], c[2], c[3], c[4], c[5]);
+        copy_rect(&ref, c[0], c[1], c[2], c[3], c[4], c[5]);
+        CHECK_EQ(ram_diff(&ref), 0);
+    }
+}
+
+// 圧縮画像: 7ピクセルごとに色が変わり、繰り返しが行をまたぐ20x12の画像
+#define QW  20
+#define QH  12
+
+static uint16_t qpixels[QW * QH];
+static uint8_t qdata[3 * QW * QH];
+
+static void make_qimage(struct qimage *img) {
+    size_t n = 0;
+
+    for (int i = 0; i < QW * QH; i++)
+        qpixels[i] = pattern(i / 7, 0);
+    for (int i = 0; i < QW * QH; ) {
+        int run = 0;
+
+        // 直前の色と同じ間は繰り返しにまとめる
+        while (i > 0 && i + run < QW * QH && run < QIMG_RUN_MAX && qpixels[i + run] == qpixels[i - 1])
+            run++;
+        if (run) {
+            qdata[n++] = QIMG_OP_RUN | (run - 1);
+            i += run;
+        } else {
+            qdata[n++] = QIMG_OP_RGB;
+            qdata[n++] = qpixels[i] >> 8;
+            qdata[n++] = qpixels[i] & 0xff;
+            i++;
+        }
+    }
+    img->width = QW;
+    img->height = QH;
+    img->size = n;
+    img->data = qdata;
+}
+
+// 圧縮画像: はみ出す位置に描くと画面の中だけがdraw_image()と同じになる
+static void test_qimage(void) {
+    static const int pos[][2] = {
+        { -5, -4 },                     // 左上にはみ出す
+        { 85, 58 },                     // 右下にはみ出す
+        { 30, -11 },                    // 最下行だけが見える
+        { 200, 10 },                    // 画面の外
+    };
+    struct qimage img;
+    struct framebuffer ref;
+
+    make_qimage(&img);
+    for (int i = 0; i < count_of(pos); i++) {
+        int x = pos[i][0], y = pos[i][1];
+
+        start();
+        ref_init(&ref);
+        draw_image(&ref, x, y, QW, QH, qpixels);
+        draw_qimage(&fb, x, y, &img);
+        render_dirty(&oled, &fb);
+        CHECK_EQ(ram_diff(&ref), 0);
+
+        start();
+        render_qimage(&oled, x, y, &img);
+        CHECK_EQ(ram_diff(&ref), 0);
+    }
+}
+
+// accel_line(): fbがなければはみ出すラインを画面に切り取って送り、draw_line()と同じ点を描く
+static void test_accel_line(void) {
+    static const int cases[][4] = {
+        { -10, 5, 200, 5 },             // 水平線の両端がはみ出す
+        { -8, -8, 20, 20 },             // 始点が左上にはみ出す
+        { 50, 30, 130, 90 },            // 終点が右下にはみ出す
+        { 120, -30, -40, 90 },          // 両端が画面の外
+    };
+    struct framebuffer ref;
+
+    for (int i = 0; i < count_of(cases); i++) {
+        const int *c = cases[i];
+
+        start();
+        ref_init(&ref);
+        accel_line(&oled, NULL, c[0], c[1], c[2], c[3], COL_WHITE);
+        draw_line(&ref, c[0], c[1], c[2], c[3], COL_WHITE);
+        CHECK_EQ(ram_diff(&ref), 0);
+    }
+
+    // 画面に掛からないラインは何も送らない
+    start();
+    accel_line(&oled, NULL, -10, 70, 120, 100, COL_WHITE);
+    CHECK_EQ(wire(), 0);
+
+    // 90度では64x96の論理座標の画面に切り取る: 論理座標の水平線はRAMの列になる
+    ssd1331_set_orientation(&oled, SSD1331_ROTATE_90);
+    start();
+    ref_init(&ref);
+    accel_line(&oled, NULL, -10, 50, 100, 50, COL_WHITE);
+    draw_vline(&ref, 50, 0, 63, COL_WHITE);
+    CHECK_EQ(ram_diff(&ref), 0);
+    ssd1331_set_orientation(&oled, SSD1331_ROTATE_0);
+}
+
+// コンソール: 開始行のスクロール、COPYのスクロール、範囲の切り替えの後の表示が
+// 同じ文字をフレームバッファに描いたものと同じ
+static void test_console(void) {
+    static struct console con;
+    struct framebuffer ref;
+    char line[CONSOLE_COLS + 1];
+
+    // ベンチマークの"log console"と同じ20行: 1行あたり2回のトランザクションで1551バイト
+    start();
+    uint32_t cs = hal_host_cs_count();
+    console_init(&con, &oled, COL_WHITE, COL_BLACK);
+    for (int i = 0; i < 20; i++)
+        console_printf(&con, "log %03d abcd\n", i);
+    CHECK_EQ(wire() / 20, 1551);
+    CHECK_EQ((hal_host_cs_count() - cs) / 20, 2);
+
+    // 12行スクロールし、13-19行目が上の7行に並び最下行は空になる
+    ref_init(&ref);
+    for (int i = 13; i < 20; i++) {
+        snprintf(line, sizeof(line), "log %03d abcd", i);
+        write_string(&ref, 0, 8 * (i - 13), line, COL_WHITE);
+    }
+    CHECK_EQ(screen_diff(&ref), 0);
+
+    // 2-5行だけをCOPYでスクロールする。開始行は0に戻り、範囲の外の行はそのまま。
+    // 改行は行の残りを消さないので、先に範囲をクリアする
+    console_set_region(&con, 2, 4);
+    console_set_scroll(&con, CONSOLE_SCROLL_COPY);
+    console_putc(&con, '\f');
+    for (int i = 0; i < 6; i++)
+        console_printf(&con, "copy %d\n", i);
+    fill_rect(&ref, 0, 16, SSD1331_WIDTH - 1, 47, COL_BLACK);
+    for (int i = 3; i < 6; i++) {
+        snprintf(line, sizeof(line), "copy %d", i);
+        write_string(&ref, 0, 16 + 8 * (i - 3), line, COL_WHITE);
+    }
+    CHECK_EQ(screen_diff(&ref), 0);
+
+    // 全体に戻すと描き直しても表示は変わらない
+    console_set_region(&con, 0, CONSOLE_ROWS);
+    console_redraw(&con);
+    CHECK_EQ(screen_diff(&ref), 0);
+}
+
+// ディスプレイリスト: 2つのバンドで描いた結果が同じ命令をフレームバッファに描いたものと同じ
+static void test_dlist(void) {
+    static uint16_t band[2][SSD1331_WIDTH * 8];
+    static uint16_t img[16 * 12];
+    struct dl_op ops[16];
+    struct dlist dl;
+    struct framebuffer ref;
+
+    for (int i = 0; i < count_of(img); i++)
+        img[i] = pattern(i % 16, i / 16);
+
+    start();
+    ref_init(&ref);
+    dl_init(&dl, ops, count_of(ops), COL_BLUE);
+    fb_clear(&ref, COL_BLUE);
+
+    dl_line(&dl, -10, 0, 50, 63, COL_WHITE);
+    draw_line(&ref, -10, 0, 50, 63, COL_WHITE);
+    dl_line(&dl, 120, -30, -40, 90, COL_YELLOW);    // 両端が画面の外
+    draw_line(&ref, 120, -30, -40, 90, COL_YELLOW);
+    dl_fill(&dl, 80, -5, 300, 10, COL_RED);
+    fill_rect(&ref, 80, -5, 300, 10, COL_RED);
+    dl_rect(&dl, 4, 20, 40, 60, COL_GREEN);
+    draw_rect(&ref, 4, 20, 40, 60, COL_GREEN);
+    dl_text(&dl, -4, 30, "AB", COL_AQUA);
+    write_string(&ref, -4, 30, "AB", COL_AQUA);
+    dl_image(&dl, 70, 55, 16, 12, img);
+    draw_image(&ref, 70, 55, 16, 12, img);
+
+    dl_render(&oled, &dl, band[0], band[1], 8);
+    CHECK_EQ(ram_diff(&ref), 0);
+}
+
+// パイプライン: コア1が送った最後のフレームがパネルに残る
+static void test_pipeline(void) {
+    static uint16_t pbuf[2][SSD1331_BUF_LEN];
+    static struct pipeline pipe;
+    struct framebuffer ref;
+
+    start();
+    ref_init(&ref);
+    pipe_start(&pipe, &oled, pbuf[0], pbuf[1]);
+    for (int i = 0; i < 4; i++) {
+        struct framebuffer *back = pipe_acquire(&pipe);
+
+        fb_clear(back, COL_BLACK);
+        fill_rect(back, 8 * i, 4 * i, 8 * i + 30, 4 * i + 20, COL_ORANGE);
+        pipe_submit(&pipe);
+    }
+    pipe_stop(&pipe);
+    fill_rect(&ref, 24, 12, 54, 32, COL_ORANGE);
+    CHECK_EQ(pipe.flushed, 4);
+    CHECK_EQ(ram_diff(&ref), 0);
+}
+
+// グループ: 1回のトランザクションで2つのパネルに同じものを送る。メンバーへの送信は
+// そのパネルだけに届き、グループのウィンドウの記憶を捨てる
+static void test_group(void) {
+    static struct ssd1331 second, group;
+    struct ssd1331 *members[] = { &oled, &second };
+    struct framebuffer ref;
+
+    // 2台目はD/C#を共有し、CS#とRES#を別にする
+    hal_host_attach(1, 22, SPI_DCN_PIN, 23);
+    ssd1331_init(&second, &bus, 22, SPI_DCN_PIN, 23);
+    ssd1331_init_group(&group, members, count_of(members));
+
+    start();
+    ref_init(&ref);
+    fill_rect(&fb, 10, 10, 60, 40, COL_PURPLE);
+    fill_rect(&ref, 10, 10, 60, 40, COL_PURPLE);
+    hal_host_wire_reset();
+    uint32_t cs = hal_host_cs_count();
+    render_dirty(&group, &fb);
+    CHECK_EQ(hal_host_cs_count() - cs, 1);
+    // ウィンドウ、グループで初めて送る色数の設定 (REMAP_COLOR_DEPTH) と51x31ピクセル
+    CHECK_EQ(wire(), 6 + 2 + 2 * 51 * 31);
+    // 1台目はstart()で黒にしてあり、2台目は初期化でRAMが0になっている
+    emu_select(0);
+    CHECK_EQ(ram_diff(&ref), 0);
+    emu_select(1);
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    // 2台目だけに描く
+    accel_fill(&second, NULL, 0, 0, 7, 7, COL_WHITE);
+    emu_select(1);
+    fill_rect(&ref, 0, 0, 7, 7, COL_WHITE);
+    CHECK_EQ(ram_diff(&ref), 0);
+    emu_select(0);
+    fill_rect(&ref, 0, 0, 7, 7, COL_BLACK);
+    CHECK_EQ(ram_diff(&ref), 0);
+}
+
+// 90度の画面の参照: 論理座標のrow行目の文字列を転置してrefに描く
+// (論理座標の (x, y) がフレームバッファとRAMの (y, x))
+static void ref_text_rotated(struct framebuffer *ref, int row, const char *str, uint16_t color) {
+    static uint16_t line[SSD1331_WIDTH * 8];
+    struct framebuffer band;
+
+    fb_init_band(&band, line, 0, 8);
+    fb_clear(&band, COL_BLACK);
+    write_string(&band, 0, 0, str, color);
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < SSD1331_HEIGHT; x++)
+            ref->buf[x * SSD1331_WIDTH + row * 8 + y] = line[y * SSD1331_WIDTH + x];
+}
+
+// 90度: 変更領域、ディスプレイリスト、パイプライン、スプライトの合成は転置して送られ、
+// フレームバッファの (x, y) がRAMの (x, y) に置かれる
+static void test_rotate_flush(void) {
+    static uint16_t img[16 * 12];
+    static uint16_t band[2][SSD1331_WIDTH * 8];
+    static uint16_t pbuf[2][SSD1331_BUF_LEN];
+    static struct pipeline pipe;
+    static struct compositor comp;
+    struct sprite sprite;
+    struct dl_op ops[4];
+    struct dlist dl;
+    struct framebuffer ref;
+
+    for (int i = 0; i < count_of(img); i++)
+        img[i] = pattern(i % 16, i / 16);
+
+    ssd1331_set_orientation(&oled, SSD1331_ROTATE_90);
+    start();
+    ref_init(&ref);
+    draw_image(&fb, 20, 10, 16, 12, img);
+    draw_image(&ref, 20, 10, 16, 12, img);
+    hal_host_wire_reset();
+    render_dirty(&oled, &fb);
+    // ウィンドウ (6バイト) と16x12ピクセル
+    CHECK_EQ(wire(), 6 + 2 * 16 * 12);
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    // バンドを列の順に送る
+    dl_init(&dl, ops, count_of(ops), COL_BLUE);
+    dl_line(&dl, -10, 0, 50, 63, COL_WHITE);
+    dl_image(&dl, 70, 55, 16, 12, img);
+    fb_clear(&ref, COL_BLUE);
+    draw_line(&ref, -10, 0, 50, 63, COL_WHITE);
+    draw_image(&ref, 70, 55, 16, 12, img);
+    dl_render(&oled, &dl, band[0], band[1], 8);
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    // コア1も転置して送る
+    pipe_start(&pipe, &oled, pbuf[0], pbuf[1]);
+    for (int i = 0; i < 2; i++) {
+        struct framebuffer *back = pipe_acquire(&pipe);
+
+        fb_clear(back, COL_BLACK);
+        fill_rect(back, 8 * i, 4 * i, 8 * i + 30, 4 * i + 20, COL_ORANGE);
+        pipe_submit(&pipe);
+    }
+    pipe_stop(&pipe);
+    fb_clear(&ref, COL_BLACK);
+    fill_rect(&ref, 8, 4, 38, 24, COL_ORANGE);
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    // スプライトを動かすと前回と今の範囲の列を合成し直す
+    comp_init(&comp, &oled);
+    comp_set_background(&comp, NULL, 0, COL_GREEN);
+    sprite_init(&sprite, img, 16, 16, 12);
+    sprite_move(&sprite, 30, 20);
+    comp_add(&comp, &sprite);
+    comp_flush(&comp);
+    sprite_move(&sprite, 34, 22);
+    comp_flush(&comp);
+    fb_clear(&ref, COL_GREEN);
+    draw_image(&ref, 34, 22, 16, 12, img);
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    ssd1331_set_orientation(&oled, SSD1331_ROTATE_0);
+}
+
+// 90度: コンソールと文字セルは8桁12行になり、向きを戻して描き直すと12桁8行に戻る
+static void test_rotate_text(void) {
+    static struct console con;
+    static struct textgrid grid;
+    struct framebuffer ref;
+    char line[CONSOLE_COLS + 1];
+
+    // 14行でCOPYのスクロールが3回起き、3-13行目が上の11行に並ぶ
+    ssd1331_set_orientation(&oled, SSD1331_ROTATE_90);
+    start();
+    console_init(&con, &oled, COL_WHITE, COL_BLACK);
+    CHECK_EQ(con.cols, 8);
+    CHECK_EQ(con.lines, 12);
+    for (int i = 0; i < 14; i++)
+        console_printf(&con, "rot %02d\n", i);
+    ref_init(&ref);
+    for (int i = 3; i < 14; i++) {
+        snprintf(line, sizeof(line), "rot %02d", i);
+        ref_text_rotated(&ref, i - 3, line, COL_WHITE);
+    }
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    // 文字セルの最下行 (11行目) と8桁目で切れる文字列
+    grid_init(&grid, &oled, COL_BLACK);
+    CHECK_EQ(grid_puts(&grid, 0, 11, "grid", COL_YELLOW), 4);
+    CHECK_EQ(grid_puts(&grid, 4, 0, "abcdef", COL_YELLOW), 4);
+    ref_init(&ref);
+    ref_text_rotated(&ref, 11, "grid", COL_YELLOW);
+    ref_text_rotated(&ref, 0, "    abcd", COL_YELLOW);
+    CHECK_EQ(ram_diff(&ref), 0);
+
+    // 0度に戻すと範囲は画面全体に戻り、覚えている上の8行を12桁で描く
+    ssd1331_set_orientation(&oled, SSD1331_ROTATE_0);
+    console_redraw(&con);
+    CHECK_EQ(con.rows, CONSOLE_ROWS);
+    ref_init(&ref);
+    for (int i = 3; i < 11; i++) {
+        snprintf(line, sizeof(line), "rot %02d", i);
+        write_string(&ref, 0, 8 * (i - 3), line, COL_WHITE);
+    }
+    CHECK_EQ(screen_diff(&ref), 0);
+}
+
+static const struct test {
+    const char *name;
+    void (*run)(void);
+} tests[] = {
+    { "damage full", test_damage_full },
+    { "damage line", test_damage_line },
+    { "damage text", test_damage_text },
+    { "blit", test_blit },
+    { "render blit", test_render_blit },
+    { "accel copy", test_accel_copy },
+    { "accel line", test_accel_line },
+    { "qimage", test_qimage },
+    { "console", test_console },
+    { "dlist", test_dlist },
+    { "pipeline", test_pipeline },
+    { "group", test_group },
+    { "rotate flush", test_rotate_flush },
+    { "rotate text", test_rotate_text },
+};
+
+int main(void) {
+    ssd1331_bus_init(&bus, SPI_INSTANCE, SPI_SCK_PIN, SPI_MOSI_PIN, SPI_FREQ);
+    ssd1331_init(&oled, &bus, SPI_CSN_PIN, SPI_DCN_PIN, SPI_RESN_PIN);
+
+    for (int i = 0; i < count_of(tests); i++) {
+        int before = failures;
+
+        tests[i].run();
+        printf("%-16s %s\n", tests[i].name, failures == before ? "ok" : "FAIL");
+    }
+    return failures ? 1 : 0;
+}
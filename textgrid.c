@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ssd1331.h"
+#include "textgrid.h"
+#include "accel.h"
+#include "glyph.h"
+#include "perf.h"
+
+#define CELL    8
+
+static inline bool same_cell(char c0, uint16_t fg0, char c1, uint16_t fg1) {
+    return c0 == c1 && (c0 == ' ' || fg0 == fg1);
+}
+
+// 今の向きの画面の桁数と行数
+static inline int cols(struct textgrid *grid) {
+    return ssd1331_width(grid->dev) / CELL;
+}
+
+static inline int rows(struct textgrid *grid) {
+    return ssd1331_height(grid->dev) / CELL;
+}
+
+// row行のc0からc1桁を送る
+static int draw_cells(struct textgrid *grid, int row, int c0, int c1) {
+    render_cells(grid->dev, c0 * CELL, row * CELL, grid->text[row] + c0, grid->color[row] + c0, c1 - c0 + 1, grid->bg);
+    return c1 - c0 + 1;
+}
+
+// 表示中のセルと比べて、変わったセルが続く部分ごとに送る
+static int update(struct textgrid *grid, int col, int row, const char *s, int n, uint16_t fg) {
+    int sent = 0;
+    int c = col;
+
+    assert(row >= 0 && row < rows(grid) && col >= 0);
+    n = MIN(n, cols(grid) - col);
+    while (c < col + n) {
+        if (same_cell(grid->text[row][c], grid->color[row][c], s[c - col], fg)) {
+            c++;
+            continue;
+        }
+
+        int c0 = c;
+        for (; c < col + n && !same_cell(grid->text[row][c], grid->color[row][c], s[c - col], fg); c++) {
+            grid->text[row][c] = s[c - col];
+            grid->color[row][c] = fg;
+        }
+        sent += draw_cells(grid, row, c0, c - 1);
+    }
+    return sent;
+}
+
+void grid_init(struct textgrid *grid, struct ssd1331 *dev, uint16_t bg) {
+    grid->dev = dev;
+    grid->bg = bg;
+    grid_clear(grid);
+}
+
+void grid_clear(struct textgrid *grid) {
+    memset(grid->text, ' ', sizeof(grid->text));
+    for (int r = 0; r < GRID_MAX; r++)
+        for (int c = 0; c < GRID_MAX; c++)
+            grid->color[r][c] = grid->bg;
+    accel_fill(grid->dev, NULL, 0, 0, ssd1331_width(grid->dev) - 1, ssd1331_height(grid->dev) - 1, grid->bg);
+}
+
+void grid_redraw(struct textgrid *grid) {
+    PERF_SCOPE(PERF_TEXT);
+    for (int r = 0; r < rows(grid); r++)
+        draw_cells(grid, r, 0, cols(grid) - 1);
+}
+
+int grid_puts(struct textgrid *grid, int col, int row, const char *str, uint16_t fg) {
+    PERF_SCOPE(PERF_TEXT);
+    return update(grid, col, row, str, strlen(str), fg);
+}
+
+int grid_vprintf(struct textgrid *grid, const struct grid_field *field, const char *fmt, va_list ap) {
+    PERF_SCOPE(PERF_TEXT);
+    char buf[GRID_MAX + 1];
+    char s[GRID_MAX];
+    int w = field->width;
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+
+    n = MIN(n, w);
+
+    // 欄の幅に合わせて空白で埋める
+    assert(w <= GRID_MAX);
+    memset(s, ' ', w);
+    if (n > 0)
+        memcpy(field->flags & GRID_ALIGN_RIGHT ? s + w - n : s, buf, n);
+    return update(grid, field->col, field->row, s, w, field->fg);
+}
+
+int grid_printf(struct textgrid *grid, const struct grid_field *field, const char *fmt, ...) {
+    va_list ap;
+
+    va_start(ap, fmt);
+    int n = grid_vprintf(grid, field, fmt, ap);
+    va_end(ap);
+    return n;
+}
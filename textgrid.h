@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2023 SUZUKI Keiji.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef TEXTGRID_H
+#define TEXTGRID_H
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "ssd1331.h"
+
+/* 8x8の文字セル (12桁8行) の表示
+
+   固定のラベルと、センサーの値のように何度も書き換える欄からなる画面用。
+   セルごとに表示中の文字と色を持ち、書き込む文字列と比べて変わったセルだけを送る。
+   続けて変わったセルはまとめて1つのウィンドウ (render_text()) で送るので、
+   "P: 1007.41" が "P: 1007.42" になったときの転送は1文字分の約130バイトになる
+   (全画面は12KB)。
+
+   フレームバッファは使わず、パネルに直接送る。空白のセルは色に関係なく同じとみなす。
+   90/270度の画面では論理座標の画面に合わせて8桁12行になる。範囲の外のセルも覚えておき、
+   向きを戻してgrid_redraw()を呼べば表示される。
+*/
+
+#define GRID_COLS   (SSD1331_WIDTH / 8)     // 0/180度の桁数と行数
+#define GRID_ROWS   (SSD1331_HEIGHT / 8)
+#define GRID_MAX    GRID_COLS               // どの向きでも収まる桁数と行数
+
+#define GRID_ALIGN_LEFT     0x00
+#define GRID_ALIGN_RIGHT    0x01    // 幅に満たない文字列を右に寄せる (数値の桁をそろえる)
+
+struct textgrid {
+    struct ssd1331 *dev;
+    uint16_t bg;
+    char text[GRID_MAX][GRID_MAX];
+    uint16_t color[GRID_MAX][GRID_MAX];
+};
+
+// 書き換える欄: row行のcol桁からwidth桁
+struct grid_field {
+    uint8_t col;
+    uint8_t row;
+    uint8_t width;
+    uint8_t flags;          // GRID_ALIGN_*
+    uint16_t fg;
+};
+
+// すべてのセルを空白にしてbgで画面をクリアする
+void grid_init(struct textgrid *grid, struct ssd1331 *dev, uint16_t bg);
+void grid_clear(struct textgrid *grid);
+// 保持しているセルから画面全体を描き直す
+void grid_redraw(struct textgrid *grid);
+// row行のcol桁から文字列を書く (行末で切る)。送った文字数を返す
+int grid_puts(struct textgrid *grid, int col, int row, const char *str, uint16_t fg);
+// 欄に書式付きで書く。幅に満たない部分は空白で埋め、あふれた分は切る。送った文字数を返す
+int grid_printf(struct textgrid *grid, const struct grid_field *field, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+int grid_vprintf(struct textgrid *grid, const struct grid_field *field, const char *fmt, va_list ap);
+
+#endif // TEXTGRID_H
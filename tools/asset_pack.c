@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/*
+ * マニフェストに並べた画像とフォントを1つのパック (asset.h の形式) にまとめて
+ * Cのソースとヘッダーに書き出す。通常はCMakeの ssd1331_add_assets() から実行される
+ *  cc -o asset_pack asset_pack.c
+ *  ./asset_pack assets.txt asset_pack.c asset_pack.h
+ *
+ * マニフェストは1行に1つのアセットを次の形式で書く (#から行末はコメント)。
+ * パスはマニフェストのあるディレクトリからの相対パス
+ *  名前 形式 パス [引数]
+ *      raw     ファイルの内容そのまま
+ *      rgb565  BMPをRGB565に変換する
+ *      rgb332  BMPをRGB332に変換する
+ *      qimage  BMPを qimage.h の形式に圧縮する
+ *      atlas   BMPをRGB565に変換し、引数のタイルの幅と高さを索引に記録する (アイコンのシート)
+ *      font    テキスト形式のフォント (font8x8.txt) のビットマップとプロポーショナル表示用の表
+ */
+
+#include "bmp.h"
+#include "font_text.h"
+
+// asset.h と同じ定義
+#define ASSET_MAGIC     0x31504153u
+#define ASSET_ALIGN     4
+#define ENTRY_SIZE      16
+
+enum { FMT_RAW, FMT_RGB565, FMT_RGB332, FMT_QIMAGE, FMT_FONT };
+
+#define MAX_ASSETS      256
+
+struct asset {
+    char name[64];
+    uint8_t *data;
+    uint32_t size;
+    uint16_t width, height;
+    uint8_t format;
+    uint8_t arg0, arg1;
+};
+
+static struct asset assets[MAX_ASSETS];
+static int nassets;
+
+static uint8_t *read_file(const char *path, uint32_t *size) {
+    FILE *fd = fopen(path, "rb");
+    uint8_t *buf = NULL;
+    long n;
+
+    if (!fd)
+        return NULL;
+    if (fseek(fd, 0, SEEK_END) == 0 && (n = ftell(fd)) >= 0) {
+        buf = malloc(n ? n : 1);
+        rewind(fd);
+        if (buf && fread(buf, 1, n, fd) != (size_t)n) {
+            free(buf);
+            buf = NULL;
+        }
+        *size = n;
+    }
+    fclose(fd);
+    return buf;
+}
+
+static int load_image(struct asset *a, const char *path, int rgb332) {
+    int32_t w, h;
+    size_t n;
+    uint16_t *pix = load_bmp(path, rgb332, &w, &h, &n);
+
+    if (!pix)
+        return 1;
+    if (w > 0xffff || h > 0xffff) {
+        fprintf(stderr, "%s: 画像が大きすぎる\n", path);
+        free(pix);
+        return 1;
+    }
+    a->width = w;
+    a->height = h;
+    if (rgb332) {
+        a->size = n;
+        a->data = malloc(n);
+        for (size_t i = 0; i < n; i++)
+            a->data[i] = pix[i];
+    } else {
+        a->size = n * 2;
+        a->data = malloc(n * 2);
+        for (size_t i = 0; i < n; i++) {
+            a->data[2 * i] = pix[i] & 0xff;
+            a->data[2 * i + 1] = pix[i] >> 8;
+        }
+    }
+    free(pix);
+    return 0;
+}
+
+static int load_qimage(struct asset *a, const char *path) {
+    int32_t w, h;
+    size_t n;
+    uint16_t *pix = load_bmp(path, 0, &w, &h, &n);
+
+    if (!pix)
+        return 1;
+    // struct qimage の幅と高さは1バイト
+    if (w > 255 || h > 255) {
+        fprintf(stderr, "%s: qimageは255x255まで\n", path);
+        free(pix);
+        return 1;
+    }
+    a->width = w;
+    a->height = h;
+    a->data = malloc(3 * n);
+    a->size = encode(pix, n, a->data);
+    free(pix);
+    return 0;
+}
+
+static int load_font(struct asset *a, const char *path) {
+    static uint8_t glyphs[FONT_TEXT_CHARS][8];
+    static int defined[FONT_TEXT_CHARS];
+    FILE *fd = fopen(path, "r");
+
+    if (!fd)
+        return 1;
+    memset(glyphs, 0, sizeof(glyphs));
+    memset(defined, 0, sizeof(defined));
+    int err = font_text_parse(fd, glyphs, defined);
+    fclose(fd);
+    if (err)
+        return 1;
+
+    a->width = 8;
+    a->height = 8;
+    a->arg0 = FONT_TEXT_FIRST;
+    a->arg1 = FONT_TEXT_LAST;
+    a->size = FONT_TEXT_CHARS * 9;
+    a->data = malloc(a->size);
+    memcpy(a->data, glyphs, FONT_TEXT_CHARS * 8);
+    for (int i = 0; i < FONT_TEXT_CHARS; i++)
+        a->data[FONT_TEXT_CHARS * 8 + i] = font_text_prop(glyphs[i]);
+    return 0;
+}
+
+// マニフェストの1行を読み込む。空行とコメントは0、エラーなら1を返す
+static int parse_line(char *line, const char *dir, int lineno) {
+    char name[64], type[16], file[256], path[512];
+    int tw = 0, th = 0;
+
+    char *p = strchr(line, '#');
+    if (p)
+        *p = '\0';
+    int n = sscanf(line, "%63s %15s %255s %d %d", name, type, file, &tw, &th);
+    if (n <= 0)
+        return 0;
+    if (n < 3) {
+        fprintf(stderr, "%d: 名前 形式 パス が必要\n", lineno);
+        return 1;
+    }
+    // 名前はCの識別子の一部 (ASSET_<名前>) になる
+    for (const char *q = name; *q; q++)
+        if (!isalnum((unsigned char)*q) && *q != '_') {
+            fprintf(stderr, "%d: 名前 %s に使えない文字がある\n", lineno, name);
+            return 1;
+        }
+    if (nassets == MAX_ASSETS) {
+        fprintf(stderr, "%d: アセットが多すぎる\n", lineno);
+        return 1;
+    }
+    for (int i = 0; i < nassets; i++)
+        if (strcmp(assets[i].name, name) == 0) {
+            fprintf(stderr, "%d: %s が重複している\n", lineno, name);
+            return 1;
+        }
+    snprintf(path, sizeof(path), "%s%s", file[0] == '/' ? "" : dir, file);
+
+    struct asset *a = &assets[nassets];
+    int err;
+    memset(a, 0, sizeof(*a));
+    strcpy(a->name, name);
+    if (strcmp(type, "raw") == 0) {
+        a->format = FMT_RAW;
+        a->data = read_file(path, &a->size);
+        err = !a->data;
+    } else if (strcmp(type, "rgb565") == 0 || strcmp(type, "atlas") == 0) {
+        a->format = FMT_RGB565;
+        err = load_image(a, path, 0);
+        if (!err && type[0] == 'a') {
+            if (n < 5 || tw <= 0 || th <= 0 || tw > 255 || th > 255 || a->width % tw || a->height % th) {
+                fprintf(stderr, "%d: atlasには画像を割り切るタイルの幅と高さが必要\n", lineno);
+                return 1;
+            }
+            a->arg0 = tw;
+            a->arg1 = th;
+        } else if (!err) {
+            a->arg0 = a->width > 255 ? 0 : a->width;
+            a->arg1 = a->height > 255 ? 0 : a->height;
+        }
+    } else if (strcmp(type, "rgb332") == 0) {
+        a->format = FMT_RGB332;
+        err = load_image(a, path, 1);
+    } else if (strcmp(type, "qimage") == 0) {
+        a->format = FMT_QIMAGE;
+        err = load_qimage(a, path);
+    } else if (strcmp(type, "font") == 0) {
+        a->format = FMT_FONT;
+        err = load_font(a, path);
+    } else {
+        fprintf(stderr, "%d: 不明な形式 %s\n", lineno, type);
+        return 1;
+    }
+    if (err) {
+        fprintf(stderr, "%d: %s を読み込めない\n", lineno, path);
+        return 1;
+    }
+    nassets++;
+    return 0;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static int write_source(const char *path, const char *header) {
+    uint32_t size = 8 + ENTRY_SIZE * nassets;
+    uint32_t offset[MAX_ASSETS];
+
+    for (int i = 0; i < nassets; i++) {
+        size = (size + ASSET_ALIGN - 1) & ~(uint32_t)(ASSET_ALIGN - 1);
+        offset[i] = size;
+        size += assets[i].size;
+    }
+
+    uint8_t *pack = calloc(size ? size : 1, 1);
+    put32(pack, ASSET_MAGIC);
+    put32(pack + 4, nassets);
+    for (int i = 0; i < nassets; i++) {
+        const struct asset *a = &assets[i];
+        uint8_t *e = pack + 8 + ENTRY_SIZE * i;
+
+        put32(e, offset[i]);
+        put32(e + 4, a->size);
+        put16(e + 8, a->width);
+        put16(e + 10, a->height);
+        e[12] = a->format;
+        e[13] = a->arg0;
+        e[14] = a->arg1;
+        memcpy(pack + offset[i], a->data, a->size);
+    }
+
+    FILE *fd = fopen(path, "w");
+    if (!fd) {
+        free(pack);
+        return 1;
+    }
+    // 基準のヘッダーのファイル名だけを書く (include_directoriesで見つける)
+    const char *base = strrchr(header, '/');
+    fprintf(fd, "// asset_pack で生成したファイル。編集しないこと\n");
+    fprintf(fd, "#include \"%s\"\n\n", base ? base + 1 : header);
+    fprintf(fd, "const uint8_t asset_pack[%u] __attribute__((aligned(%d))) = {", size, ASSET_ALIGN);
+    for (uint32_t i = 0; i < size; i++)
+        fprintf(fd, "%s0x%02x,", i % 16 ? " " : "\n    ", pack[i]);
+    fprintf(fd, "\n};\n");
+    free(pack);
+    return fclose(fd) != 0;
+}
+
+static int write_header(const char *path) {
+    FILE *fd = fopen(path, "w");
+    if (!fd)
+        return 1;
+
+    fprintf(fd, "// asset_pack で生成したファイル。編集しないこと\n");
+    fprintf(fd, "#ifndef ASSET_PACK_H\n#define ASSET_PACK_H\n\n");
+    fprintf(fd, "#include \"asset.h\"\n\n");
+    fprintf(fd, "enum {\n");
+    for (int i = 0; i < nassets; i++) {
+        fprintf(fd, "    ASSET_");
+        for (const char *p = assets[i].name; *p; p++)
+            fputc(toupper((unsigned char)*p), fd);
+        fprintf(fd, ",\n");
+    }
+    fprintf(fd, "    ASSET_COUNT\n};\n\n");
+    for (int i = 0; i < nassets; i++) {
+        char upper[64];
+        int k = 0;
+
+        for (const char *p = assets[i].name; *p; p++)
+            upper[k++] = toupper((unsigned char)*p);
+        upper[k] = '\0';
+        fprintf(fd, "#define ASSET_%s_WIDTH %u\n", upper, assets[i].width);
+        fprintf(fd, "#define ASSET_%s_HEIGHT %u\n", upper, assets[i].height);
+    }
+    fprintf(fd, "\nextern const uint8_t asset_pack[];\n\n#endif // ASSET_PACK_H\n");
+    return fclose(fd) != 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s manifest out.c out.h\n", argv[0]);
+        return 1;
+    }
+
+    FILE *fd = fopen(argv[1], "r");
+    if (!fd) {
+        fprintf(stderr, "%s を開けない\n", argv[1]);
+        return 1;
+    }
+
+    // パスはマニフェストのディレクトリから
+    char dir[512] = "";
+    const char *slash = strrchr(argv[1], '/');
+    if (slash)
+        snprintf(dir, sizeof(dir), "%.*s/", (int)(slash - argv[1]), argv[1]);
+
+    char line[512];
+    int lineno = 0, err = 0;
+    while (!err && fgets(line, sizeof(line), fd))
+        err = parse_line(line, dir, ++lineno);
+    fclose(fd);
+    if (err) {
+        fprintf(stderr, "%s: エラー\n", argv[1]);
+        return 1;
+    }
+
+    if (write_header(argv[3]) || write_source(argv[2], argv[3])) {
+        fprintf(stderr, "書き出せない\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+# アセットのパック (asset.h) をビルド時に生成する。project() の後でincludeすること
+#
+#   ssd1331_add_assets(<target> <manifest>)
+#
+# tools/asset_pack.c をホストのコンパイラでビルドし、マニフェストに並べたファイルから
+# ${CMAKE_CURRENT_BINARY_DIR}/asset_pack.c と asset_pack.h を生成して <target> に加える。
+# マニフェストか、そこに書いたファイルか、ツールが変わったときだけ生成し直す。
+
+set(SSD1331_TOOLS_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# Pico向けのビルドではCMAKE_C_COMPILERはクロスコンパイラなので、ツールには別にホストのコンパイラを使う
+if (SSD1331_HOST)
+    set(SSD1331_HOST_CC ${CMAKE_C_COMPILER})
+else()
+    find_program(SSD1331_HOST_CC NAMES cc gcc clang)
+    if (NOT SSD1331_HOST_CC)
+        message(FATAL_ERROR "asset_pack をビルドするホストのCコンパイラ (cc, gcc, clang) がない")
+    endif()
+endif()
+
+set(SSD1331_ASSET_PACK ${CMAKE_BINARY_DIR}/asset_pack_tool${CMAKE_HOST_EXECUTABLE_SUFFIX})
+add_custom_command(
+    OUTPUT ${SSD1331_ASSET_PACK}
+    COMMAND ${SSD1331_HOST_CC} -O2 -o ${SSD1331_ASSET_PACK} ${SSD1331_TOOLS_DIR}/asset_pack.c
+    DEPENDS ${SSD1331_TOOLS_DIR}/asset_pack.c ${SSD1331_TOOLS_DIR}/bmp.h ${SSD1331_TOOLS_DIR}/font_text.h
+    COMMENT "Building asset_pack"
+)
+
+function(ssd1331_add_assets target manifest)
+    get_filename_component(manifest ${manifest} ABSOLUTE)
+    get_filename_component(dir ${manifest} DIRECTORY)
+
+    # マニフェストのパス (3つ目の欄) を依存関係にする。マニフェストを書き換えたら構成し直す
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${manifest})
+    file(STRINGS ${manifest} lines REGEX "^[ \t]*[A-Za-z0-9_]+[ \t]+[a-z0-9]+[ \t]+[^ \t#]+")
+    set(deps ${manifest})
+    foreach(line IN LISTS lines)
+        string(REGEX REPLACE "^[ \t]*[A-Za-z0-9_]+[ \t]+[a-z0-9]+[ \t]+([^ \t#]+).*$" "\\1" path "${line}")
+        if (NOT IS_ABSOLUTE ${path})
+            set(path ${dir}/${path})
+        endif()
+        list(APPEND deps ${path})
+    endforeach()
+
+    set(out ${CMAKE_CURRENT_BINARY_DIR}/${target}_assets)
+    add_custom_command(
+        OUTPUT ${out}/asset_pack.c ${out}/asset_pack.h
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${out}
+        COMMAND ${SSD1331_ASSET_PACK} ${manifest} ${out}/asset_pack.c ${out}/asset_pack.h
+        DEPENDS ${SSD1331_ASSET_PACK} ${deps}
+        COMMENT "Packing assets for ${target}"
+    )
+    target_sources(${target} PRIVATE ${out}/asset_pack.c ${out}/asset_pack.h)
+    target_include_directories(${target} PRIVATE ${out} ${CMAKE_CURRENT_SOURCE_DIR})
+endfunction()
@@ -0,0 +1,143 @@
+#ifndef TOOLS_BMP_H
+#define TOOLS_BMP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * bmp_to_hex.c と asset_pack.c で共用する、BMPの読み込みと qimage.h の形式への圧縮
+ */
+
+// qimage.h と同じ定義
+#define QIMG_OP_INDEX   0x00
+#define QIMG_OP_DIFF    0x40
+#define QIMG_OP_LUMA    0x80
+#define QIMG_OP_RUN     0xc0
+#define QIMG_OP_RGB     0xfe
+#define QIMG_RUN_MAX    62
+
+#define QIMG_HASH(c)    ((((c) >> 11) * 3 + (((c) >> 5) & 0x3f) * 5 + ((c) & 0x1f) * 7) & 0x3f)
+
+// 差を各成分のビット幅で桁あふれさせて -2^(bits-1)..2^(bits-1)-1 にする
+static int wrap(int d, int bits) {
+    int m = 1 << bits;
+    return ((d + m / 2) & (m - 1)) - m / 2;
+}
+
+// n個のピクセルを圧縮してoutに書き出し、バイト数を返す。outは3*nバイト必要
+static size_t encode(const uint16_t *pix, size_t n, uint8_t *out) {
+    uint16_t index[64] = {0};
+    uint16_t prev = 0;
+    size_t len = 0;
+    int run = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint16_t c = pix[i];
+
+        if (c == prev) {
+            if (++run == QIMG_RUN_MAX) {
+                out[len++] = QIMG_OP_RUN | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run) {
+            out[len++] = QIMG_OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        int h = QIMG_HASH(c);
+        int dr = wrap((c >> 11) - (prev >> 11), 5);
+        int dg = wrap(((c >> 5) & 0x3f) - ((prev >> 5) & 0x3f), 6);
+        int db = wrap((c & 0x1f) - (prev & 0x1f), 5);
+        int vr = dr - (dg >> 1);
+        int vb = db - (dg >> 1);
+
+        if (index[h] == c) {
+            out[len++] = QIMG_OP_INDEX | h;
+        } else if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+            out[len++] = QIMG_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+        } else if (vr >= -8 && vr <= 7 && vb >= -8 && vb <= 7) {
+            out[len++] = QIMG_OP_LUMA | (dg + 32);
+            out[len++] = (vr + 8) << 4 | (vb + 8);
+        } else {
+            out[len++] = QIMG_OP_RGB;
+            out[len++] = c >> 8;
+            out[len++] = c & 0xff;
+        }
+        index[h] = c;
+        prev = c;
+    }
+    if (run)
+        out[len++] = QIMG_OP_RUN | (run - 1);
+    return len;
+}
+
+// BMPを読み込んでRGB565 (rgb332ならRGB332) のピクセルの配列を上の行から順に返す。
+// 非圧縮の24bitと32bit (BGRA) を読む。各行は4バイト境界まで詰め物があり、
+// 高さが正なら下の行から格納されている
+static uint16_t *load_bmp(const char *path, int rgb332, int32_t *width, int32_t *height, size_t *count) {
+    uint8_t hdr[54];
+    uint16_t *pix = NULL;
+    uint8_t *line = NULL;
+
+    FILE *fd = fopen(path, "rb");
+    if (!fd) return NULL;
+    if (fread(hdr, sizeof(hdr), 1, fd) != 1 || hdr[0] != 'B' || hdr[1] != 'M')
+        goto fail;
+
+    // 画像データのファイル先頭からのオフセット、幅と高さ、1ピクセルのビット数、圧縮の形式
+    uint32_t offset = hdr[0x0a] | hdr[0x0b] << 8 | hdr[0x0c] << 16 | (uint32_t)hdr[0x0d] << 24;
+    int32_t w = (int32_t)(hdr[0x12] | hdr[0x13] << 8 | hdr[0x14] << 16 | (uint32_t)hdr[0x15] << 24);
+    int32_t h = (int32_t)(hdr[0x16] | hdr[0x17] << 8 | hdr[0x18] << 16 | (uint32_t)hdr[0x19] << 24);
+    int bpp = hdr[0x1c] | hdr[0x1d] << 8;
+    uint32_t compression = hdr[0x1e] | hdr[0x1f] << 8 | hdr[0x20] << 16 | (uint32_t)hdr[0x21] << 24;
+    int bottom_up = h > 0;
+
+    if (!bottom_up)
+        h = -h;
+    // 32bitのBI_BITFIELDS (3) はBGRAの並びのものだけを想定する
+    if (w <= 0 || h <= 0 || (bpp != 24 && bpp != 32) || !(compression == 0 || (bpp == 32 && compression == 3))) {
+        fprintf(stderr, "%s: 非圧縮の24bitか32bitのBMPではない\n", path);
+        goto fail;
+    }
+
+    size_t stride = ((size_t)w * bpp / 8 + 3) & ~(size_t)3;
+    size_t n = (size_t)w * h;
+    pix = malloc(n * sizeof(uint16_t));
+    line = malloc(stride);
+    if (!pix || !line)
+        goto fail;
+
+    fseek(fd, offset, SEEK_SET);
+    for (int32_t y = 0; y < h; y++) {
+        if (fread(line, stride, 1, fd) != 1)
+            goto fail;
+
+        uint16_t *dst = pix + (size_t)(bottom_up ? h - 1 - y : y) * w;
+        for (int32_t x = 0; x < w; x++) {
+            // 画像データは BGR の順で格納されている
+            const uint8_t *data = line + x * (bpp / 8);
+            if (rgb332)
+                dst[x] = (data[2] & 0xe0) | ((data[1] >> 3) & 0x1c) | (data[0] >> 6);
+            else
+                dst[x] = (uint16_t)(((data[2] >> 3) << 11) | ((data[1] >> 2) << 5) | (data[0] >> 3));
+        }
+    }
+    fclose(fd);
+    free(line);
+    *width = w;
+    *height = h;
+    *count = n;
+    return pix;
+
+fail:
+    fclose(fd);
+    free(line);
+    free(pix);
+    return NULL;
+}
+
+#endif // TOOLS_BMP_H
@@ -1,48 +1,320 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 /*
- * 24bit BMPから16bit RGB565に変換してheaderファイルに書き出す
- *  cc -o bmp2hex bmp_to_head.c
- *  ./bmp2head file.bmp > ../image.h
+ * 24bit/32bit BMPから16bit RGB565に変換してheaderファイルに書き出す
+ *  cc -o bmp2hex bmp_to_hex.c
+ *  ./bmp2hex file.bmp > ../image.h
+ *      uint16_t img[] としてRGB565をそのまま出力する
+ *  ./bmp2hex -q file.bmp > ../image.h
+ *      qimage.h の圧縮形式で struct qimage img として出力する
+ *      (使う側で qimage.h を先にincludeすること)
+ *  ./bmp2hex -8 file.bmp > ../image.h
+ *      uint8_t img[] としてRGB332 (256色モード) を出力し、IMG_RGB332を定義する
+ *  ./bmp2hex -n logo -q logo.bmp > ../logo.h
+ *      配列の名前を logo、マクロを LOGO_WIDTH などにする (複数の画像を一緒に使うとき)
+ *  ./bmp2hex -a [-f fps] [-k n] frame000.bmp frame001.bmp ... > ../anim.h
+ *      anim.h の差分形式で struct anim anim として出力する
+ *      (-f: フレームレート (既定は20)、-k: nフレームごとにキーフレームを入れる)
  */
+
+#include "bmp.h"
+
+// anim.h と同じ定義
+#define ANIM_KEY    0x01
+#define ANIM_DROP   0x02
+
+#define TILE        8       // 変わった部分を探す単位
+#define RECT_COST   16      // 矩形1つの余分な転送 (ウィンドウのコマンド、CS#) と矩形の見出しのバイト数
+#define MAX_RECTS   255
+
+struct rect {
+    int x0, y0, x1, y1;
+};
+
+static int rect_cost(const struct rect *r) {
+    return 2 * (r->x1 - r->x0 + 1) * (r->y1 - r->y0 + 1) + RECT_COST;
+}
+
+static struct rect rect_union(const struct rect *a, const struct rect *b) {
+    struct rect r = {
+        a->x0 < b->x0 ? a->x0 : b->x0, a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1, a->y1 > b->y1 ? a->y1 : b->y1
+    };
+    return r;
+}
+
+// prevからcurで変わったピクセルを覆う矩形をrectsに求め、その数を返す。
+// TILE x TILE のタイルごとに変わった範囲を調べ、変わったタイルを横、縦の順に
+// つないで矩形にしてから、まとめて送った方が安くなる矩形どうしを併合する
+static int find_rects(const uint16_t *prev, const uint16_t *cur, int w, int h, struct rect *rects) {
+    int tw = (w + TILE - 1) / TILE, th = (h + TILE - 1) / TILE;
+    struct rect *tiles = malloc(tw * th * sizeof(struct rect));
+    char *changed = calloc(tw * th, 1);
+    int n = 0;
+
+    for (int ty = 0; ty < th; ty++)
+        for (int tx = 0; tx < tw; tx++) {
+            struct rect *t = &tiles[ty * tw + tx];
+            t->x0 = w; t->y0 = h; t->x1 = -1; t->y1 = -1;
+            for (int y = ty * TILE; y < (ty + 1) * TILE && y < h; y++)
+                for (int x = tx * TILE; x < (tx + 1) * TILE && x < w; x++) {
+                    if (prev[y * w + x] == cur[y * w + x])
+                        continue;
+                    if (x < t->x0) t->x0 = x;
+                    if (x > t->x1) t->x1 = x;
+                    if (y < t->y0) t->y0 = y;
+                    if (y > t->y1) t->y1 = y;
+                    changed[ty * tw + tx] = 1;
+                }
+        }
+
+    for (int ty = 0; ty < th; ty++)
+        for (int tx = 0; tx < tw; tx++) {
+            if (!changed[ty * tw + tx])
+                continue;
+
+            int tx1 = tx, ty1 = ty;
+            while (tx1 + 1 < tw && changed[ty * tw + tx1 + 1])
+                tx1++;
+            for (;;) {
+                int k = tx;
+                if (ty1 + 1 == th)
+                    break;
+                while (k <= tx1 && changed[(ty1 + 1) * tw + k])
+                    k++;
+                if (k <= tx1)
+                    break;
+                ty1++;
+            }
+
+            struct rect r = tiles[ty * tw + tx];
+            for (int y = ty; y <= ty1; y++)
+                for (int x = tx; x <= tx1; x++) {
+                    r = rect_union(&r, &tiles[y * tw + x]);
+                    changed[y * tw + x] = 0;
+                }
+            rects[n++] = r;
+        }
+
+    for (int merged = 1; merged; ) {
+        merged = 0;
+        for (int a = 0; a < n; a++)
+            for (int b = a + 1; b < n; b++) {
+                struct rect u = rect_union(&rects[a], &rects[b]);
+                if (rect_cost(&u) > rect_cost(&rects[a]) + rect_cost(&rects[b]))
+                    continue;
+                rects[a] = u;
+                rects[b] = rects[--n];
+                merged = 1;
+                b = a;
+            }
+    }
+
+    free(changed);
+    free(tiles);
+    return n;
+}
+
+// 次のフレームの矩形がrectsをすべて覆うか
+static int covered(const struct rect *rects, int n, const struct rect *next, int n_next, int w, int h) {
+    char *mask = calloc(w * h, 1);
+    int ok = 1;
+
+    for (int i = 0; i < n_next; i++)
+        for (int y = next[i].y0; y <= next[i].y1; y++)
+            memset(mask + y * w + next[i].x0, 1, next[i].x1 - next[i].x0 + 1);
+    for (int i = 0; i < n && ok; i++)
+        for (int y = rects[i].y0; y <= rects[i].y1 && ok; y++)
+            for (int x = rects[i].x0; x <= rects[i].x1; x++)
+                if (!mask[y * w + x]) {
+                    ok = 0;
+                    break;
+                }
+    free(mask);
+    return ok;
+}
+
+static void print_bytes(const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        printf("%s 0x%02X", i == 0 ? " " : ",", buf[i]);
+        if (((i + 1) % 12) == 0) printf("\n\t");
+    }
+}
+
+// BMPの連番をanim.hの形式で出力する。keyが0でなければkeyフレームごとにキーフレームにする
+static int encode_anim(char **paths, int count, int fps, int key) {
+    int32_t w = 0, h = 0;
+    uint16_t **frames = malloc(count * sizeof(uint16_t *));
+    struct rect (*rects)[MAX_RECTS] = malloc(count * sizeof(*rects));
+    int *nrects = malloc(count * sizeof(int));
+
+    for (int i = 0; i < count; i++) {
+        int32_t fw, fh;
+        size_t n;
+
+        frames[i] = load_bmp(paths[i], 0, &fw, &fh, &n);
+        if (!frames[i] || n != (size_t)fw * fh || (i > 0 && (fw != w || fh != h))) {
+            fprintf(stderr, "%s: cannot read, or size differs from the first frame\n", paths[i]);
+            return 1;
+        }
+        w = fw;
+        h = fh;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || (key && i % key == 0)) {
+            struct rect all = { 0, 0, w - 1, h - 1 };
+            rects[i][0] = all;
+            nrects[i] = 1;
+        } else {
+            nrects[i] = find_rects(frames[i - 1], frames[i], w, h, rects[i]);
+        }
+    }
+
+    uint8_t *data = malloc((size_t)count * (2 + MAX_RECTS * 6 + 3 * w * h));
+    uint16_t *sub = malloc(w * h * sizeof(uint16_t));
+    size_t len = 0, bus = 0;
+
+    for (int i = 0; i < count; i++) {
+        int flags = 0;
+
+        if (i == 0 || (key && i % key == 0))
+            flags |= ANIM_KEY;
+        if (i + 1 < count && covered(rects[i], nrects[i], rects[i + 1], nrects[i + 1], w, h))
+            flags |= ANIM_DROP;
+        data[len++] = flags;
+        data[len++] = nrects[i];
+
+        for (int k = 0; k < nrects[i]; k++) {
+            struct rect *r = &rects[i][k];
+            int rw = r->x1 - r->x0 + 1, rh = r->y1 - r->y0 + 1;
+
+            for (int y = 0; y < rh; y++)
+                memcpy(sub + y * rw, frames[i] + (r->y0 + y) * w + r->x0, rw * sizeof(uint16_t));
+            data[len++] = r->x0;
+            data[len++] = r->y0;
+            data[len++] = rw;
+            data[len++] = rh;
+            size_t size = encode(sub, rw * rh, data + len + 2);
+            if (size > 0xffff) {
+                fprintf(stderr, "%s: rectangle too large\n", paths[i]);
+                return 1;
+            }
+            data[len++] = size >> 8;
+            data[len++] = size & 0xff;
+            len += size;
+            if (i > 0)
+                bus += 2 * rw * rh;
+        }
+    }
+
+    size_t raw = (size_t)count * w * h * 2;
+    printf("// %d frames, %zu bytes (RGB565: %zu bytes, %.1f%%)\n", count, len, raw, 100.0 * len / raw);
+    printf("#define ANIM_WIDTH %d\n", w);
+    printf("#define ANIM_HEIGHT %d\n", h);
+    printf("#define ANIM_FRAMES %d\n\n", count);
+    printf("static const uint8_t anim_data[] = {\n\t");
+    print_bytes(data, len);
+    printf("};\n\n");
+    printf("const struct anim anim = { ANIM_WIDTH, ANIM_HEIGHT, ANIM_FRAMES, %d, sizeof(anim_data), anim_data };\n", fps);
+    fprintf(stderr, "%d frames: %zu -> %zu bytes (%.1f%%), %zu pixel bytes/frame after the first (full: %d)\n",
+            count, raw, len, 100.0 * len / raw, count > 1 ? bus / (count - 1) : 0, 2 * w * h);
+
+    for (int i = 0; i < count; i++)
+        free(frames[i]);
+    free(frames);
+    free(rects);
+    free(nrects);
+    free(data);
+    free(sub);
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
-    int32_t offset, img_size, width, height;
-    uint8_t data[3];
-    uint16_t rgb;
-
-    FILE *fd = fopen(argv[1], "rb");
-    if (!fd) return 1;
-    // 画像データのファイル先頭からのオフセット
-    fseek(fd, 0x0a, SEEK_SET);
-    fread(&offset, 4, 1, fd);
-    // 画像の幅と高さ
-    fseek(fd, 0x12, SEEK_SET);
-    fread(&width, 4, 1, fd);
-    fread(&height, 4, 1, fd);
-    // 画像のサイズ(3バイト/1ピクセル)
-    fseek(fd, 0x22, SEEK_SET);
-    fread(&img_size, 4, 1, fd);
-
-    fseek(fd, offset, SEEK_SET);
-    printf("#define IMG_WIDTH %d\n", width);
-    printf("#define IMG_HEIGHT %d\n\n", height);
-    printf("const uint16_t img[] = {\n\t");
-
-    for (int i=0; i < img_size/3; i++) {
-        fread(data, 3, 1, fd);
-        // 画像データは BGR の順で格納されている
-        rgb = (uint16_t)(((data[2] >> 3) << 11) | ((data[1] >> 2) << 5) | (data[0] >> 3));
-        // RGB565をuint16_tで出力
-        printf("%s 0x%04X", i == 0 ? " " : ",", rgb);
-        // RGB565をリトルエンディアンでuchar8_t 2個で出力
-        //printf("%s 0x%02X, 0x%02X", i == 0 ? " " : ",", (rgb >> 8) & 0xff, rgb & 0xff);
-        if (((i + 1) % 8) == 0) printf("\n\t");
-    }
-
-    printf("};\n");
-
-    fclose(fd);
+    int32_t width, height;
+    int compress = 0, rgb332 = 0, anim = 0, fps = 20, key = 0;
+    const char *name = "img";
+    char macro[64];
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-q") == 0)
+            compress = 1;
+        else if (strcmp(argv[arg], "-8") == 0)
+            rgb332 = 1;
+        else if (strcmp(argv[arg], "-a") == 0)
+            anim = 1;
+        else if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc)
+            fps = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "-k") == 0 && arg + 1 < argc)
+            key = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+            name = argv[++arg];
+        else
+            break;
+    }
+    const char *path = arg < argc ? argv[arg] : NULL;
+
+    if (!path || compress + rgb332 + anim > 1 || fps < 1 || fps > 255 || key < 0 || strlen(name) >= sizeof(macro)) {
+        fprintf(stderr, "usage: %s [-n name] [-q | -8] file.bmp\n", argv[0]);
+        fprintf(stderr, "       %s -a [-f fps] [-k n] frame0.bmp frame1.bmp ...\n", argv[0]);
+        return 1;
+    }
+
+    if (anim)
+        return encode_anim(argv + arg, argc - arg, fps, key);
+
+    size_t n;
+    uint16_t *pix = load_bmp(path, rgb332, &width, &height, &n);
+    if (!pix) return 1;
+
+    // マクロの名前は配列の名前を大文字にしたもの
+    for (size_t i = 0; i <= strlen(name); i++)
+        macro[i] = toupper((unsigned char)name[i]);
+    printf("#define %s_WIDTH %d\n", macro, width);
+    printf("#define %s_HEIGHT %d\n\n", macro, height);
+
+    if (rgb332) {
+        printf("#define %s_RGB332\n\n", macro);
+        printf("const uint8_t %s[] = {\n\t", name);
+        for (size_t i = 0; i < n; i++) {
+            // RGB332をuint8_tで出力
+            printf("%s 0x%02X", i == 0 ? " " : ",", pix[i]);
+            if (((i + 1) % 12) == 0) printf("\n\t");
+        }
+        printf("};\n");
+        free(pix);
+        return 0;
+    }
+
+    if (!compress) {
+        printf("const uint16_t %s[] = {\n\t", name);
+        for (size_t i = 0; i < n; i++) {
+            // RGB565をuint16_tで出力
+            printf("%s 0x%04X", i == 0 ? " " : ",", pix[i]);
+            if (((i + 1) % 8) == 0) printf("\n\t");
+        }
+        printf("};\n");
+        free(pix);
+        return 0;
+    }
+
+    uint8_t *out = malloc(3 * n);
+    if (!out) return 1;
+    size_t len = encode(pix, n, out);
+
+    printf("// %zu bytes (RGB565: %zu bytes, %.1f%%)\n", len, 2 * n, 100.0 * len / (2 * n));
+    printf("static const uint8_t %s_data[] = {\n\t", name);
+    print_bytes(out, len);
+    printf("};\n\n");
+    printf("const struct qimage %s = { %s_WIDTH, %s_HEIGHT, sizeof(%s_data), %s_data };\n", name, macro, macro, name, name);
+    fprintf(stderr, "%s: %zu -> %zu bytes (%.1f%%)\n", path, 2 * n, len, 100.0 * len / (2 * n));
+
+    free(out);
+    free(pix);
     return 0;
 }
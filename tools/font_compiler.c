@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 8x8フォントのコンパイラ
+ *
+ *  cc -o font_compiler font_compiler.c
+ *  ./font_compiler font8x8.txt > ../font.h
+ *      テキスト形式のフォント (font8x8.txt) から font.h を生成する
+ *  ./font_compiler -t ssd1306_font.h > font8x8.txt
+ *      SSD1306用の (左に90度回転した) フォントを右に90度回転してテキスト形式で出力する
+ *  ./font_compiler -a 4 font8x8.txt > ../font_aa.h
+ *      アンチエイリアスをかけた2bppまたは4bppのフォント (font_aa.h) を生成する
+ *
+ * テキスト形式は 'char 0xNN' の行に続く8行のビットマップ ('#': 点灯, '.': 消灯)。
+ * '//' で始まる行はコメント。
+ * font.h には文字コード順の const テーブルとして次のものを出力する
+ *   font[]      : 1文字8バイト、各行のビットマップ (MSBが左端)
+ *   font_prop[] : プロポーショナル表示用。上位4bitが左の空白桁数、下位4bitが文字幅
+ * font_aa.h には font_aa[] (1文字8行、各行は上位ビットが左端のピクセルの覆われ具合) を出力する。
+ * 覆われ具合はビットマップをScale2xで2回拡大 (32x32) して斜めの縁を滑らかにし、
+ * 4x4ピクセルごとの点灯数から求める
+ */
+
+#include "font_text.h"
+
+#define FIRST       FONT_TEXT_FIRST
+#define LAST        FONT_TEXT_LAST
+#define NCHARS      FONT_TEXT_CHARS
+
+static uint8_t glyphs[NCHARS][8];
+static int defined[NCHARS];
+
+// SSD1306のフォントは1バイトが1列 (LSBが上端) なので右に90度回転する
+static void turn_right(const uint8_t *src, uint8_t *dst) {
+    uint8_t p;
+
+    memset(dst, 0, 8);
+    for (int j = 0; j < 8; j++) {
+        p = 0x80;
+        for (int k = 0; k < 8; k++) {
+            dst[k] <<= 1;
+            dst[k] |= ((src[j] & p) ? 1 : 0);
+            p >>= 1;
+        }
+    }
+}
+
+// Cのヘッダーから0xNNの並びを読み出し、回転してテキスト形式で出力する
+static int import_ssd1306(FILE *fd) {
+    uint8_t src[8], dst[8];
+    unsigned int v;
+    int n = 0, ch = 0;
+    int c;
+
+    printf("// tools/font_compiler -t で変換したフォント\n\n");
+    while ((c = fgetc(fd)) != EOF) {
+        if (c != '0')
+            continue;
+        if ((c = fgetc(fd)) != 'x' && c != 'X')
+            continue;
+        if (fscanf(fd, "%2x", &v) != 1)
+            continue;
+        src[n++] = v;
+        if (n < 8)
+            continue;
+
+        turn_right(src, dst);
+        printf("char 0x%02X\n", FIRST + ch++);
+        for (int i = 0; i < 8; i++) {
+            for (int k = 0; k < 8; k++)
+                putchar(dst[i] & (0x80 >> k) ? '#' : '.');
+            putchar('\n');
+        }
+        putchar('\n');
+        n = 0;
+    }
+    return 0;
+}
+
+// Scale2x: 2倍に拡大し、斜めにつながるピクセルの角を埋める。範囲外は消灯
+static void scale2x(const uint8_t *src, int n, uint8_t *dst) {
+#define P(x, y) ((x) < 0 || (y) < 0 || (x) >= n || (y) >= n ? 0 : src[(y) * n + (x)])
+    for (int y = 0; y < n; y++)
+        for (int x = 0; x < n; x++) {
+            int a = P(x, y - 1), b = P(x + 1, y), c = P(x - 1, y), d = P(x, y + 1), p = P(x, y);
+            uint8_t *e = &dst[2 * y * 2 * n + 2 * x];
+            e[0] = c == a && c != d && a != b ? a : p;
+            e[1] = a == b && a != c && b != d ? b : p;
+            e[2 * n] = d == c && d != b && c != a ? c : p;
+            e[2 * n + 1] = b == d && b != a && d != c ? d : p;
+        }
+#undef P
+}
+
+// 1文字をbppビットの覆われ具合の8行 (1行bppバイト) にする
+static void antialias(const uint8_t *g, int bpp, uint8_t *dst) {
+    uint8_t p8[8 * 8], p16[16 * 16], p32[32 * 32];
+    int max = (1 << bpp) - 1;
+
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++)
+            p8[y * 8 + x] = (g[y] & (0x80 >> x)) != 0;
+    scale2x(p8, 8, p16);
+    scale2x(p16, 16, p32);
+
+    memset(dst, 0, 8 * bpp);
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++) {
+            int n = 0;
+            for (int j = 0; j < 4; j++)
+                for (int k = 0; k < 4; k++)
+                    n += p32[(y * 4 + j) * 32 + x * 4 + k];
+            int v = (n * max + 8) / 16;
+            int bit = x * bpp;
+            dst[y * bpp + bit / 8] |= v << (8 - bpp - bit % 8);
+        }
+}
+
+static void print_char(int i) {
+    int c = FIRST + i;
+    // コメントを閉じてしまう文字やエスケープになる文字は記号で示さない
+    if (c == ' ' || c == '\\' || c == '/' || c == '*')
+        printf("     // 0x%02X\n", c);
+    else
+        printf("     // %c\n", c);
+}
+
+static void print_aa(int bpp) {
+    uint8_t row[8 * 4];
+
+    printf("// tools/font_compiler -a %d で生成: 編集しないこと\n\n", bpp);
+    printf("#define FONT_AA_FIRST   0x%02X\n", FIRST);
+    printf("#define FONT_AA_LAST    0x%02X\n", LAST);
+    printf("#define FONT_AA_WIDTH   8\n");
+    printf("#define FONT_AA_HEIGHT  8\n");
+    printf("#define FONT_AA_BPP     %d\n\n", bpp);
+
+    printf("// 1文字%dバイト: 各行の覆われ具合 (%dbpp, 上位ビットが左端)\n", 8 * bpp, bpp);
+    printf("static const uint8_t font_aa[] = {\n");
+    for (int i = 0; i < NCHARS; i++) {
+        antialias(glyphs[i], bpp, row);
+        for (int j = 0; j < 8 * bpp; j++)
+            printf("%s0x%02x,", j % bpp == 0 ? (j == 0 ? "    " : "  ") : " ", row[j]);
+        print_char(i);
+    }
+    printf("};\n");
+}
+
+int main(int argc, char *argv[]) {
+    int transpose = argc > 2 && strcmp(argv[1], "-t") == 0;
+    int aa_bpp = argc > 3 && strcmp(argv[1], "-a") == 0 ? atoi(argv[2]) : 0;
+    const char *path = argv[aa_bpp ? 3 : transpose ? 2 : 1];
+
+    if (!path || (argc > 3 && aa_bpp != 2 && aa_bpp != 4)) {
+        fprintf(stderr, "usage: %s [-t | -a 2|4] file\n", argv[0]);
+        return 1;
+    }
+
+    FILE *fd = fopen(path, "r");
+    if (!fd) return 1;
+
+    if (transpose) {
+        int rc = import_ssd1306(fd);
+        fclose(fd);
+        return rc;
+    }
+
+    int rc = font_text_parse(fd, glyphs, defined);
+    fclose(fd);
+    if (rc)
+        return rc;
+
+    for (int i = 0; i < NCHARS; i++)
+        if (!defined[i])
+            fprintf(stderr, "warning: 0x%02X が定義されていません\n", FIRST + i);
+
+    if (aa_bpp) {
+        print_aa(aa_bpp);
+        return 0;
+    }
+
+    printf("// tools/font_compiler で生成: 編集しないこと\n\n");
+    printf("#define FONT_FIRST      0x%02X\n", FIRST);
+    printf("#define FONT_LAST       0x%02X\n", LAST);
+    printf("#define FONT_WIDTH      8\n");
+    printf("#define FONT_HEIGHT     8\n\n");
+
+    printf("// 1文字8バイト: 各行のビットマップ (MSBが左端)\n");
+    printf("static const uint8_t font[] = {\n");
+    for (int i = 0; i < NCHARS; i++) {
+        printf("    ");
+        for (int j = 0; j < 8; j++)
+            printf("0x%02x,%s", glyphs[i][j], j < 7 ? " " : "");
+        print_char(i);
+    }
+    printf("};\n\n");
+
+    printf("// プロポーショナル表示用: 上位4bitが左の空白桁数、下位4bitが文字幅\n");
+    printf("static const uint8_t font_prop[] = {");
+    for (int i = 0; i < NCHARS; i++)
+        printf("%s0x%02x,", i % 8 == 0 ? "\n    " : " ", font_text_prop(glyphs[i]));
+    printf("\n};\n");
+    return 0;
+}
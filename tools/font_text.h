@@ -0,0 +1,67 @@
+#ifndef TOOLS_FONT_TEXT_H
+#define TOOLS_FONT_TEXT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * font_compiler.c と asset_pack.c で共用する、テキスト形式のフォント (font8x8.txt) の読み込み
+ */
+
+#define FONT_TEXT_FIRST         0x20
+#define FONT_TEXT_LAST          0x7E
+#define FONT_TEXT_CHARS         (FONT_TEXT_LAST - FONT_TEXT_FIRST + 1)
+#define FONT_TEXT_SPACE_WIDTH   3       // 点灯ピクセルのない文字の幅
+
+// glyphs[文字コード - FONT_TEXT_FIRST] に各行のビットマップ (MSBが左端) を読み込み、
+// 定義された文字のdefinedを1にする。エラーなら1を返す
+static int font_text_parse(FILE *fd, uint8_t glyphs[][8], int *defined) {
+    char line[128];
+    unsigned int code;
+    int cur = -1, row = 0, lineno = 0;
+
+    while (fgets(line, sizeof(line), fd)) {
+        lineno++;
+        if (strncmp(line, "//", 2) == 0 || line[0] == '\n')
+            continue;
+        if (sscanf(line, "char %x", &code) == 1) {
+            if (code < FONT_TEXT_FIRST || code > FONT_TEXT_LAST) {
+                fprintf(stderr, "%d: 範囲外の文字コード 0x%02X\n", lineno, code);
+                return 1;
+            }
+            cur = code - FONT_TEXT_FIRST;
+            row = 0;
+            defined[cur] = 1;
+            continue;
+        }
+        if (cur < 0 || row >= 8) {
+            fprintf(stderr, "%d: 不正な行\n", lineno);
+            return 1;
+        }
+        uint8_t b = 0;
+        for (int k = 0; k < 8 && line[k] && line[k] != '\n'; k++)
+            if (line[k] == '#')
+                b |= 0x80 >> k;
+        glyphs[cur][row++] = b;
+    }
+    return 0;
+}
+
+// プロポーショナル表示用: 上位4bitが左の空白桁数、下位4bitが文字幅
+static uint8_t font_text_prop(const uint8_t *g) {
+    uint8_t cols = 0;
+    int left = 0, right = 7;
+
+    for (int i = 0; i < 8; i++)
+        cols |= g[i];
+    if (cols == 0)
+        return FONT_TEXT_SPACE_WIDTH;
+    while (!(cols & (0x80 >> left)))
+        left++;
+    while (!(cols & (0x80 >> right)))
+        right--;
+    return (left << 4) | (right - left + 1);
+}
+
+#endif // TOOLS_FONT_TEXT_H